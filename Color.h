@@ -0,0 +1,149 @@
+#ifndef COLOR_H
+#define COLOR_H
+
+// Integer hue to RGB conversion for fully saturated colors (S = 1.0, L = 0.5).
+// Replaces RgbColor(HslColor(hue, 1.0, 0.5)) which needs soft-float math.
+
+// RgbColor(HslColor(i / 255.0, 1.0, 0.5)) for i = 0..255
+const uint8_t _hue8Table[256 * 3] PROGMEM = {
+  0xFF, 0x00, 0x00, 0xFF, 0x06, 0x00, 0xFF, 0x0C, 0x00, 0xFF, 0x12, 0x00,
+  0xFF, 0x18, 0x00, 0xFF, 0x1E, 0x00, 0xFF, 0x24, 0x00, 0xFF, 0x2A, 0x00,
+  0xFF, 0x30, 0x00, 0xFF, 0x36, 0x00, 0xFF, 0x3C, 0x00, 0xFF, 0x42, 0x00,
+  0xFF, 0x48, 0x00, 0xFF, 0x4E, 0x00, 0xFF, 0x54, 0x00, 0xFF, 0x5A, 0x00,
+  0xFF, 0x60, 0x00, 0xFF, 0x66, 0x00, 0xFF, 0x6C, 0x00, 0xFF, 0x72, 0x00,
+  0xFF, 0x78, 0x00, 0xFF, 0x7E, 0x00, 0xFF, 0x84, 0x00, 0xFF, 0x8A, 0x00,
+  0xFF, 0x90, 0x00, 0xFF, 0x96, 0x00, 0xFF, 0x9C, 0x00, 0xFF, 0xA2, 0x00,
+  0xFF, 0xA8, 0x00, 0xFF, 0xAE, 0x00, 0xFF, 0xB4, 0x00, 0xFF, 0xBA, 0x00,
+  0xFF, 0xC0, 0x00, 0xFF, 0xC6, 0x00, 0xFF, 0xCC, 0x00, 0xFF, 0xD2, 0x00,
+  0xFF, 0xD8, 0x00, 0xFF, 0xDE, 0x00, 0xFF, 0xE4, 0x00, 0xFF, 0xEA, 0x00,
+  0xFF, 0xF0, 0x00, 0xFF, 0xF6, 0x00, 0xFF, 0xFC, 0x00, 0xFB, 0xFF, 0x00,
+  0xF5, 0xFF, 0x00, 0xEF, 0xFF, 0x00, 0xE9, 0xFF, 0x00, 0xE3, 0xFF, 0x00,
+  0xDD, 0xFF, 0x00, 0xD7, 0xFF, 0x00, 0xD1, 0xFF, 0x00, 0xCB, 0xFF, 0x00,
+  0xC5, 0xFF, 0x00, 0xBF, 0xFF, 0x00, 0xB9, 0xFF, 0x00, 0xB3, 0xFF, 0x00,
+  0xAD, 0xFF, 0x00, 0xA7, 0xFF, 0x00, 0xA1, 0xFF, 0x00, 0x9B, 0xFF, 0x00,
+  0x95, 0xFF, 0x00, 0x8F, 0xFF, 0x00, 0x89, 0xFF, 0x00, 0x83, 0xFF, 0x00,
+  0x7D, 0xFF, 0x00, 0x77, 0xFF, 0x00, 0x71, 0xFF, 0x00, 0x6B, 0xFF, 0x00,
+  0x65, 0xFF, 0x00, 0x5F, 0xFF, 0x00, 0x59, 0xFF, 0x00, 0x53, 0xFF, 0x00,
+  0x4D, 0xFF, 0x00, 0x47, 0xFF, 0x00, 0x41, 0xFF, 0x00, 0x3B, 0xFF, 0x00,
+  0x35, 0xFF, 0x00, 0x2F, 0xFF, 0x00, 0x29, 0xFF, 0x00, 0x23, 0xFF, 0x00,
+  0x1D, 0xFF, 0x00, 0x17, 0xFF, 0x00, 0x11, 0xFF, 0x00, 0x0B, 0xFF, 0x00,
+  0x05, 0xFF, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xFF, 0x05, 0x00, 0xFF, 0x0B,
+  0x00, 0xFF, 0x11, 0x00, 0xFF, 0x17, 0x00, 0xFF, 0x1D, 0x00, 0xFF, 0x23,
+  0x00, 0xFF, 0x29, 0x00, 0xFF, 0x2F, 0x00, 0xFF, 0x35, 0x00, 0xFF, 0x3B,
+  0x00, 0xFF, 0x41, 0x00, 0xFF, 0x47, 0x00, 0xFF, 0x4D, 0x00, 0xFF, 0x53,
+  0x00, 0xFF, 0x59, 0x00, 0xFF, 0x5F, 0x00, 0xFF, 0x65, 0x00, 0xFF, 0x6B,
+  0x00, 0xFF, 0x71, 0x00, 0xFF, 0x77, 0x00, 0xFF, 0x7D, 0x00, 0xFF, 0x83,
+  0x00, 0xFF, 0x89, 0x00, 0xFF, 0x8F, 0x00, 0xFF, 0x95, 0x00, 0xFF, 0x9B,
+  0x00, 0xFF, 0xA1, 0x00, 0xFF, 0xA7, 0x00, 0xFF, 0xAD, 0x00, 0xFF, 0xB3,
+  0x00, 0xFF, 0xB9, 0x00, 0xFF, 0xBF, 0x00, 0xFF, 0xC5, 0x00, 0xFF, 0xCB,
+  0x00, 0xFF, 0xD1, 0x00, 0xFF, 0xD7, 0x00, 0xFF, 0xDD, 0x00, 0xFF, 0xE3,
+  0x00, 0xFF, 0xE9, 0x00, 0xFF, 0xEF, 0x00, 0xFF, 0xF5, 0x00, 0xFF, 0xFB,
+  0x00, 0xFB, 0xFF, 0x00, 0xF5, 0xFF, 0x00, 0xEF, 0xFF, 0x00, 0xE9, 0xFF,
+  0x00, 0xE3, 0xFF, 0x00, 0xDD, 0xFF, 0x00, 0xD7, 0xFF, 0x00, 0xD1, 0xFF,
+  0x00, 0xCB, 0xFF, 0x00, 0xC5, 0xFF, 0x00, 0xBF, 0xFF, 0x00, 0xB9, 0xFF,
+  0x00, 0xB3, 0xFF, 0x00, 0xAD, 0xFF, 0x00, 0xA7, 0xFF, 0x00, 0xA1, 0xFF,
+  0x00, 0x9B, 0xFF, 0x00, 0x95, 0xFF, 0x00, 0x8F, 0xFF, 0x00, 0x89, 0xFF,
+  0x00, 0x83, 0xFF, 0x00, 0x7D, 0xFF, 0x00, 0x77, 0xFF, 0x00, 0x71, 0xFF,
+  0x00, 0x6B, 0xFF, 0x00, 0x65, 0xFF, 0x00, 0x5F, 0xFF, 0x00, 0x59, 0xFF,
+  0x00, 0x53, 0xFF, 0x00, 0x4D, 0xFF, 0x00, 0x47, 0xFF, 0x00, 0x41, 0xFF,
+  0x00, 0x3B, 0xFF, 0x00, 0x35, 0xFF, 0x00, 0x2F, 0xFF, 0x00, 0x29, 0xFF,
+  0x00, 0x23, 0xFF, 0x00, 0x1D, 0xFF, 0x00, 0x17, 0xFF, 0x00, 0x11, 0xFF,
+  0x00, 0x0B, 0xFF, 0x00, 0x05, 0xFF, 0x00, 0x00, 0xFF, 0x06, 0x00, 0xFF,
+  0x0B, 0x00, 0xFF, 0x12, 0x00, 0xFF, 0x17, 0x00, 0xFF, 0x1E, 0x00, 0xFF,
+  0x23, 0x00, 0xFF, 0x2A, 0x00, 0xFF, 0x2F, 0x00, 0xFF, 0x36, 0x00, 0xFF,
+  0x3B, 0x00, 0xFF, 0x42, 0x00, 0xFF, 0x47, 0x00, 0xFF, 0x4E, 0x00, 0xFF,
+  0x53, 0x00, 0xFF, 0x5A, 0x00, 0xFF, 0x5F, 0x00, 0xFF, 0x66, 0x00, 0xFF,
+  0x6B, 0x00, 0xFF, 0x72, 0x00, 0xFF, 0x77, 0x00, 0xFF, 0x7E, 0x00, 0xFF,
+  0x83, 0x00, 0xFF, 0x8A, 0x00, 0xFF, 0x8F, 0x00, 0xFF, 0x96, 0x00, 0xFF,
+  0x9B, 0x00, 0xFF, 0xA2, 0x00, 0xFF, 0xA7, 0x00, 0xFF, 0xAE, 0x00, 0xFF,
+  0xB3, 0x00, 0xFF, 0xBA, 0x00, 0xFF, 0xBF, 0x00, 0xFF, 0xC6, 0x00, 0xFF,
+  0xCB, 0x00, 0xFF, 0xD2, 0x00, 0xFF, 0xD7, 0x00, 0xFF, 0xDE, 0x00, 0xFF,
+  0xE3, 0x00, 0xFF, 0xEA, 0x00, 0xFF, 0xEF, 0x00, 0xFF, 0xF6, 0x00, 0xFF,
+  0xFB, 0x00, 0xFF, 0xFF, 0x00, 0xFC, 0xFF, 0x00, 0xF5, 0xFF, 0x00, 0xF0,
+  0xFF, 0x00, 0xE9, 0xFF, 0x00, 0xE4, 0xFF, 0x00, 0xDD, 0xFF, 0x00, 0xD8,
+  0xFF, 0x00, 0xD1, 0xFF, 0x00, 0xCC, 0xFF, 0x00, 0xC5, 0xFF, 0x00, 0xC0,
+  0xFF, 0x00, 0xB9, 0xFF, 0x00, 0xB4, 0xFF, 0x00, 0xAD, 0xFF, 0x00, 0xA8,
+  0xFF, 0x00, 0xA1, 0xFF, 0x00, 0x9C, 0xFF, 0x00, 0x95, 0xFF, 0x00, 0x90,
+  0xFF, 0x00, 0x89, 0xFF, 0x00, 0x84, 0xFF, 0x00, 0x7D, 0xFF, 0x00, 0x78,
+  0xFF, 0x00, 0x71, 0xFF, 0x00, 0x6C, 0xFF, 0x00, 0x65, 0xFF, 0x00, 0x60,
+  0xFF, 0x00, 0x59, 0xFF, 0x00, 0x54, 0xFF, 0x00, 0x4D, 0xFF, 0x00, 0x48,
+  0xFF, 0x00, 0x41, 0xFF, 0x00, 0x3C, 0xFF, 0x00, 0x35, 0xFF, 0x00, 0x30,
+  0xFF, 0x00, 0x29, 0xFF, 0x00, 0x24, 0xFF, 0x00, 0x1D, 0xFF, 0x00, 0x18,
+  0xFF, 0x00, 0x11, 0xFF, 0x00, 0x0C, 0xFF, 0x00, 0x05, 0xFF, 0x00, 0x00,
+};
+
+// Hue on 8 bits (0..255 = 0..360 degrees), same color as HslColor(hue / 255.0, 1.0, 0.5)
+RgbColor hue8ToRgb(uint8_t hue)
+{
+  const uint8_t *p = _hue8Table + hue * 3;
+  return RgbColor(pgm_read_byte(p), pgm_read_byte(p + 1), pgm_read_byte(p + 2));
+}
+
+// Hue on 16 bits (0..65535 = 0..360 degrees), same color as HslColor(hue / 65536.0, 1.0, 0.5)
+// within one LSB
+RgbColor hue16ToRgb(uint16_t hue)
+{
+  // 6 sectors, in each one a component rises or falls between 0 and 255
+  uint32_t x = (uint32_t)hue * 6;
+  uint32_t frac = x & 0xFFFF;
+  uint8_t up = (frac * 255) >> 16;
+  uint8_t down = ((0x10000 - frac) * 255) >> 16;
+
+  switch (x >> 16) {
+  case 0: return RgbColor(255, up, 0);
+  case 1: return RgbColor(down, 255, 0);
+  case 2: return RgbColor(0, 255, up);
+  case 3: return RgbColor(0, down, 255);
+  case 4: return RgbColor(up, 0, 255);
+  default: return RgbColor(255, 0, down);
+  }
+}
+
+// Random fully saturated color
+RgbColor randomHueColor()
+{
+  return hue8ToRgb(random(256));
+}
+
+// Gamma correction (2.2) of a color component on 16 bits: 65535 * (i / 255) ^ 2.2
+const uint16_t _gamma16Table[256] PROGMEM = {
+  0x0000, 0x0000, 0x0002, 0x0004, 0x0007, 0x000B, 0x0011, 0x0018,
+  0x0020, 0x002A, 0x0035, 0x0041, 0x004F, 0x005E, 0x006F, 0x0081,
+  0x0094, 0x00A9, 0x00C0, 0x00D8, 0x00F2, 0x010E, 0x012B, 0x014A,
+  0x016A, 0x018C, 0x01B0, 0x01D5, 0x01FC, 0x0225, 0x024F, 0x027B,
+  0x02A9, 0x02D9, 0x030B, 0x033E, 0x0373, 0x03AA, 0x03E3, 0x041D,
+  0x0459, 0x0497, 0x04D7, 0x0519, 0x055D, 0x05A3, 0x05EA, 0x0633,
+  0x067F, 0x06CC, 0x071B, 0x076C, 0x07BF, 0x0814, 0x086B, 0x08C3,
+  0x091E, 0x097B, 0x09D9, 0x0A3A, 0x0A9D, 0x0B01, 0x0B68, 0x0BD0,
+  0x0C3B, 0x0CA8, 0x0D16, 0x0D87, 0x0DFA, 0x0E6E, 0x0EE5, 0x0F5E,
+  0x0FD9, 0x1056, 0x10D5, 0x1156, 0x11DA, 0x125F, 0x12E6, 0x1370,
+  0x13FB, 0x1489, 0x1519, 0x15AB, 0x163F, 0x16D5, 0x176E, 0x1808,
+  0x18A5, 0x1944, 0x19E5, 0x1A88, 0x1B2D, 0x1BD4, 0x1C7E, 0x1D2A,
+  0x1DD8, 0x1E88, 0x1F3A, 0x1FEF, 0x20A6, 0x215F, 0x221A, 0x22D7,
+  0x2397, 0x2459, 0x251D, 0x25E3, 0x26AC, 0x2776, 0x2843, 0x2913,
+  0x29E4, 0x2AB8, 0x2B8E, 0x2C66, 0x2D41, 0x2E1E, 0x2EFD, 0x2FDE,
+  0x30C2, 0x31A8, 0x3290, 0x337B, 0x3468, 0x3557, 0x3648, 0x373C,
+  0x3832, 0x392B, 0x3A25, 0x3B22, 0x3C22, 0x3D24, 0x3E28, 0x3F2E,
+  0x4037, 0x4142, 0x424F, 0x435F, 0x4471, 0x4586, 0x469D, 0x47B6,
+  0x48D2, 0x49F0, 0x4B10, 0x4C33, 0x4D58, 0x4E7F, 0x4FA9, 0x50D6,
+  0x5204, 0x5335, 0x5469, 0x559F, 0x56D7, 0x5812, 0x594F, 0x5A8E,
+  0x5BD0, 0x5D15, 0x5E5C, 0x5FA5, 0x60F1, 0x623F, 0x638F, 0x64E2,
+  0x6638, 0x6790, 0x68EA, 0x6A47, 0x6BA6, 0x6D08, 0x6E6C, 0x6FD3,
+  0x713C, 0x72A7, 0x7415, 0x7586, 0x76F9, 0x786E, 0x79E6, 0x7B61,
+  0x7CDE, 0x7E5D, 0x7FDF, 0x8164, 0x82EA, 0x8474, 0x8600, 0x878E,
+  0x891F, 0x8AB3, 0x8C49, 0x8DE1, 0x8F7C, 0x911A, 0x92BA, 0x945D,
+  0x9602, 0x97A9, 0x9954, 0x9B00, 0x9CB0, 0x9E62, 0xA016, 0xA1CD,
+  0xA386, 0xA542, 0xA701, 0xA8C2, 0xAA86, 0xAC4C, 0xAE15, 0xAFE1,
+  0xB1AF, 0xB37F, 0xB552, 0xB728, 0xB900, 0xBADB, 0xBCB9, 0xBE99,
+  0xC07B, 0xC261, 0xC449, 0xC633, 0xC820, 0xCA10, 0xCC02, 0xCDF7,
+  0xCFEE, 0xD1E8, 0xD3E5, 0xD5E4, 0xD7E6, 0xD9EB, 0xDBF2, 0xDDFC,
+  0xE008, 0xE217, 0xE429, 0xE63D, 0xE854, 0xEA6E, 0xEC8A, 0xEEA9,
+  0xF0CA, 0xF2EE, 0xF515, 0xF73F, 0xF96B, 0xFB9A, 0xFDCB, 0xFFFF,
+};
+
+uint16_t gamma16(uint8_t v)
+{
+  return pgm_read_word(_gamma16Table + v);
+}
+
+#endif
@@ -2,12 +2,18 @@
 // Led Strip configuration for TexTime
 //
 
+#include <new>
+
 #include "fonts.h"
-#include "textime.h"
 
 #define NROW 10
 #define NCOL 12
 #define NEDGE 4
+#define NPIXELS ((NROW * NCOL) + NEDGE)
+#define NPIXELSMASK ((NPIXELS + 31) / 32)
+#define LEDSBYPIXELMAX 2
+
+#include "textime.h"
 
 #define pVOID  Pixel()
 #define pBLACK Pixel(RgbColor(0  ,   0,   0))
@@ -38,9 +44,12 @@ public:
   }
 };
 
+// Packed frame buffer of the matrix pixels followed by the edge pixels.
+// Display flags are stored as a bit mask and colors in a contiguous plane.
 class PixelsArray {
 private:
-  Pixel _pixels[NROW][NCOL];
+  uint32_t _mask[NPIXELSMASK];
+  RgbColor _colors[NPIXELS];
 
 public:
   PixelsArray()
@@ -48,15 +57,42 @@ public:
     clear();
   }
 
+  // Index of pixels in the buffer
+  static int index(int row, int col) { return (row * NCOL) + col; }
+  static int edgeIndex(int n) { return (NROW * NCOL) + n; }
+
+  // Unchecked accessors, n must be in [0:NPIXELS[
+  bool isDisplayed(int n) const { return _mask[n >> 5] & (1UL << (n & 31)); }
+  const RgbColor &color(int n) const { return _colors[n]; }
+  Pixel get(int n) const { Pixel p(_colors[n]); p.display = isDisplayed(n); return p; }
+
+  void set(int n, const RgbColor &c)
+  {
+    _colors[n] = c;
+    _mask[n >> 5] |= (1UL << (n & 31));
+  }
+
+  void set(int n, const Pixel &p)
+  {
+    _colors[n] = p.color;
+    if (p.display)
+      _mask[n >> 5] |= (1UL << (n & 31));
+    else
+      _mask[n >> 5] &= ~(1UL << (n & 31));
+  }
+
+  // Whole frame operations
   void fill(const Pixel &p)
   {
-    for (int i = 0; i < NROW; i++)
-    {
-      for (int j = 0; j < NCOL; j++)
-      {
-        _pixels[i][j] = p;
-      }
-    }
+    for (int n = 0; n < NPIXELS; n++)
+      _colors[n] = p.color;
+
+    for (int i = 0; i < NPIXELSMASK; i++)
+      _mask[i] = p.display ? 0xFFFFFFFF : 0;
+
+    // Keep unused bits of the last mask word cleared
+    if (p.display && (NPIXELS & 31))
+      _mask[NPIXELSMASK - 1] = (1UL << (NPIXELS & 31)) - 1;
   }
 
   void clear()
@@ -64,6 +100,50 @@ public:
     fill(pVOID);
   }
 
+  // Set all pixels of the mask to the color
+  void fillMask(const uint32_t *mask, const RgbColor &c)
+  {
+    for (int i = 0; i < NPIXELSMASK; i++) {
+      uint32_t m = mask[i];
+      while (m) {
+        int b = __builtin_ctz(m);
+        _colors[(i << 5) + b] = c;
+        m &= m - 1;
+      }
+      _mask[i] |= mask[i];
+    }
+  }
+
+  // Switch off all pixels of the mask
+  void clearMask(const uint32_t *mask)
+  {
+    for (int i = 0; i < NPIXELSMASK; i++) {
+      uint32_t m = mask[i];
+      while (m) {
+        _colors[(i << 5) + __builtin_ctz(m)] = pVOID.color;
+        m &= m - 1;
+      }
+      _mask[i] &= ~mask[i];
+    }
+  }
+
+  // Copy displayed pixels of src over this buffer
+  void overlay(const PixelsArray &src)
+  {
+    for (int i = 0; i < NPIXELSMASK; i++) {
+      uint32_t m = src._mask[i];
+      while (m) {
+        int n = (i << 5) + __builtin_ctz(m);
+        _colors[n] = src._colors[n];
+        m &= m - 1;
+      }
+      _mask[i] |= src._mask[i];
+    }
+  }
+
+  const uint32_t *mask() const { return _mask; }
+
+  // Checked accessors
   void setPixel(const Pixel &p, int row, int col)
   {
     if (row < 0) return;
@@ -71,25 +151,637 @@ public:
     if (row > NROW - 1) return;
     if (col > NCOL - 1) return;
 
-    _pixels[row][col] = p;
+    set(index(row, col), p);
   }
 
-  Pixel getPixel(int row, int col)
+  Pixel getPixel(int row, int col) const
   {
     if (row < 0) return pVOID;
     if (col < 0) return pVOID;
     if (row > NROW - 1) return pVOID;
     if (col > NCOL - 1) return pVOID;
 
-    return _pixels[row][col];
+    return get(index(row, col));
+  }
+
+  void setEdge(const Pixel &p, int n)
+  {
+    if (n < 0) return;
+    if (n > NEDGE - 1) return;
+
+    set(edgeIndex(n), p);
+  }
+
+  Pixel getEdge(int n) const
+  {
+    if (n < 0) return pVOID;
+    if (n > NEDGE - 1) return pVOID;
+
+    return get(edgeIndex(n));
+  }
+};
+
+struct PixelsPipelineStats
+{
+  uint32_t produced;  // frames committed by the producer
+  uint32_t consumed;  // frames acquired by the consumer
+  uint32_t dropped;   // pending frames discarded by a reset
+  uint32_t coalesced; // pending frames replaced by a newer one before being acquired
+};
+
+// Triple buffered frames between a producer and a consumer.
+// The producer draws in the back buffer and commits it as the pending frame.
+// The consumer acquires the pending frame as its front buffer.
+// None of them waits for the other : a frame committed before the previous
+// one was acquired replaces it, so the consumer always gets the latest one.
+class PixelsPipeline
+{
+private:
+  PixelsArray _buffers[3];
+  PixelsArray *_pFront;
+  PixelsArray *_pBack;
+  PixelsArray *_pPending;
+  bool _hasPending;
+  uint32_t _sequence;
+  uint32_t _frontSequence;
+  PixelsPipelineStats _stats;
+
+public:
+  PixelsPipeline()
+    : _pFront(&_buffers[0])
+    , _pBack(&_buffers[1])
+    , _pPending(&_buffers[2])
+    , _hasPending(false)
+    , _sequence(0)
+    , _frontSequence(0)
+  {
+    memset(&_stats, 0, sizeof(_stats));
+  }
+
+  // Producer side
+  PixelsArray &back()
+  {
+    return *_pBack;
+  }
+
+  void commit()
+  {
+    PixelsArray *p = _pPending;
+    _pPending = _pBack;
+    _pBack = p;
+
+    if (_hasPending)
+      _stats.coalesced++;
+
+    _hasPending = true;
+    _sequence++;
+    _stats.produced++;
+
+    // Producers draw incrementally over their last frame
+    *_pBack = *_pPending;
+  }
+
+  bool hasPending() const
+  {
+    return _hasPending;
+  }
+
+  // Consumer side
+  bool acquire()
+  {
+    if (!_hasPending)
+      return false;
+
+    PixelsArray *p = _pFront;
+    _pFront = _pPending;
+    _pPending = p;
+
+    _hasPending = false;
+    _frontSequence = _sequence;
+    _stats.consumed++;
+
+    return true;
+  }
+
+  const PixelsArray &front() const
+  {
+    return *_pFront;
+  }
+
+  // Discard the pending frame
+  void reset()
+  {
+    if (_hasPending)
+      _stats.dropped++;
+
+    _hasPending = false;
+  }
+
+  uint32_t sequence() const
+  {
+    return _sequence;
+  }
+
+  uint32_t frontSequence() const
+  {
+    return _frontSequence;
+  }
+
+  const PixelsPipelineStats &stats() const
+  {
+    return _stats;
+  }
+};
+
+
+
+enum LayerBlendMode
+{
+  BlendReplace = 0, // layer pixels replace the pixels below
+  BlendAdd,         // layer pixels are added to the pixels below
+  BlendAlpha,       // layer pixels are mixed with the pixels below
+  BlendMultiply,    // pixels below are multiplied by the layer pixels
+  BlendMask         // pixels below take the color of the layer pixels
+};
+
+enum LayerId
+{
+  LayerBackground = 0,  // animation background (fire, snow flakes, ...)
+  LayerForeground,      // mode pixels (time, seconds, ...)
+  LayerEffect,          // animation effect applied to the pixels below (rainbow, blink, ...)
+  LayerOverlay,         // notifications
+  NLAYERS
+};
+
+struct PixelsLayer
+{
+  PixelsArray pixels;
+  LayerBlendMode blend;
+  uint8_t alpha;
+  bool enabled;
+  bool dirty;
+};
+
+// Stack of layers blended from the background to the overlay into a pipeline.
+// Layers are only recomposited when one of them is marked as dirty.
+class PixelsCompositor
+{
+private:
+  PixelsLayer _layers[NLAYERS];
+  PixelsPipeline *_pOutput;
+  bool _dirty;
+
+  static uint8_t add8(uint8_t a, uint8_t b)
+  {
+    uint16_t v = a + b;
+    return v > 255 ? 255 : v;
+  }
+
+  static uint8_t mix8(uint8_t a, uint8_t b, uint8_t alpha)
+  {
+    return a + ((((int)b - (int)a) * (alpha + 1)) >> 8);
+  }
+
+  static uint8_t mul8(uint8_t a, uint8_t b)
+  {
+    uint16_t v = a * b;
+    return (v + 1 + (v >> 8)) >> 8;
+  }
+
+  static void blendLayer(PixelsArray &dst, const PixelsLayer &l)
+  {
+    const PixelsArray &src = l.pixels;
+
+    if (l.blend == BlendReplace) {
+      dst.overlay(src);
+      return;
+    }
+
+    for (int i = 0; i < NPIXELSMASK; i++) {
+      uint32_t m = src.mask()[i];
+
+      // Multiply and mask only change displayed pixels
+      if (l.blend == BlendMultiply || l.blend == BlendMask)
+        m &= dst.mask()[i];
+
+      while (m) {
+        int n = (i << 5) + __builtin_ctz(m);
+        const RgbColor &s = src.color(n);
+        RgbColor d = dst.isDisplayed(n) ? dst.color(n) : RgbColor(0, 0, 0);
+
+        switch (l.blend) {
+        case BlendAdd: d = RgbColor(add8(d.R, s.R), add8(d.G, s.G), add8(d.B, s.B)); break;
+        case BlendAlpha: d = RgbColor(mix8(d.R, s.R, l.alpha), mix8(d.G, s.G, l.alpha), mix8(d.B, s.B, l.alpha)); break;
+        case BlendMultiply: d = RgbColor(mul8(d.R, s.R), mul8(d.G, s.G), mul8(d.B, s.B)); break;
+        default: d = s; break;
+        }
+
+        dst.set(n, d);
+        m &= m - 1;
+      }
+    }
+  }
+
+public:
+  PixelsCompositor(PixelsPipeline *pOutput)
+    : _pOutput(pOutput)
+    , _dirty(true)
+  {
+    for (int i = 0; i < NLAYERS; i++) {
+      _layers[i].blend = BlendReplace;
+      _layers[i].alpha = 255;
+      _layers[i].enabled = false;
+      _layers[i].dirty = false;
+    }
+  }
+
+  PixelsLayer &layer(int id)
+  {
+    return _layers[id];
+  }
+
+  // Clear and enable a layer
+  PixelsLayer &enableLayer(int id, LayerBlendMode blend, uint8_t alpha = 255)
+  {
+    PixelsLayer &l = _layers[id];
+    l.pixels.clear();
+    l.blend = blend;
+    l.alpha = alpha;
+    l.enabled = true;
+    l.dirty = true;
+    return l;
+  }
+
+  void disableLayer(int id)
+  {
+    if (_layers[id].enabled)
+      _dirty = true;
+
+    _layers[id].enabled = false;
+  }
+
+  // Blend the layers into the output pipeline if one of them changed
+  bool compose()
+  {
+    bool dirty = _dirty;
+    for (int i = 0; i < NLAYERS; i++)
+      dirty |= _layers[i].enabled && _layers[i].dirty;
+
+    if (!dirty)
+      return false;
+
+    PixelsArray &out = _pOutput->back();
+    out.clear();
+
+    for (int i = 0; i < NLAYERS; i++) {
+      if (_layers[i].enabled)
+        blendLayer(out, _layers[i]);
+      _layers[i].dirty = false;
+    }
+
+    _pOutput->commit();
+    _dirty = false;
+
+    return true;
+  }
+};
+
+
+
+enum TransitionType
+{
+  TransitionNone = 0,   // new frames replace the old ones
+  TransitionCrossfade,  // all pixels fade to their new color together
+  TransitionMorph,      // old letters fade out one by one, then new letters fade in
+  TransitionWipe,       // pixels change column by column from the left
+  TransitionDissolve    // pixels change in a random order
+};
+
+#define NTRANSITIONS (TransitionDissolve + 1)
+
+// Shown on the General page
+PGM_P getTransitionName(int type)
+{
+  switch (type) {
+    case TransitionNone: return PSTR("None");
+    case TransitionCrossfade: return PSTR("Crossfade");
+    case TransitionMorph: return PSTR("Morph");
+    case TransitionWipe: return PSTR("Wipe");
+    case TransitionDissolve: return PSTR("Dissolve");
+  }
+  return PSTR("");
+}
+
+#define TRANSITIONFPS 50
+#define TRANSITIONFRAMES 25 // 500ms
+
+// Transition between two frames.
+// Each pixel fades from its old color to its new one during its own window
+// of frames, with a 8.8 fixed point delta computed when the transition begins.
+class PixelsTransition
+{
+private:
+  struct PixelStep
+  {
+    uint16_t value[3];  // current color (8.8)
+    int16_t delta[3];   // added at each frame of the window (windows last 2 frames at least)
+    uint8_t start;      // first frame of the window
+    uint8_t duration;   // number of frames of the window, 0 if the pixel does not change
+  };
+
+  TransitionType _type;
+  Frame _frame;
+  PixelStep _steps[NPIXELS];
+  PixelsArray _target;
+  int _frameIndex;
+  bool _running;
+
+  static RgbColor colorOf(const PixelsArray &pa, int n)
+  {
+    return pa.isDisplayed(n) ? pa.color(n) : RgbColor(0, 0, 0);
+  }
+
+  void planPixel(int n, const RgbColor &from, const RgbColor &to, int start, int duration)
+  {
+    PixelStep &s = _steps[n];
+    const uint8_t f[3] = { from.R, from.G, from.B };
+    const uint8_t t[3] = { to.R, to.G, to.B };
+
+    s.start = start;
+    s.duration = duration;
+
+    for (int i = 0; i < 3; i++) {
+      s.value[i] = (f[i] << 8) | 0x80;
+      s.delta[i] = ((t[i] - f[i]) << 8) / duration;
+    }
+  }
+
+  // Column of a pixel, edges are in the column of their corner
+  static int columnOf(int n)
+  {
+    if (n < NROW * NCOL)
+      return n % NCOL;
+
+    int e = n - NROW * NCOL;
+    return (e == 1 || e == 2) ? NCOL - 1 : 0;
+  }
+
+public:
+  PixelsTransition()
+    : _type(TransitionNone)
+    , _frameIndex(0)
+    , _running(false)
+  {
+  }
+
+  void setType(TransitionType type)
+  {
+    _type = type;
+  }
+
+  TransitionType getType()
+  {
+    return _type;
+  }
+
+  // Plan a transition from the displayed pixels to the new ones.
+  // Returns false if the new pixels must be displayed immediately.
+  bool begin(const PixelsArray &from, const PixelsArray &to)
+  {
+    _running = false;
+
+    if (_type == TransitionNone)
+      return false;
+
+    _target = to;
+
+    // Pixels in reading order for the morph
+    int leaving = 0, entering = 0;
+    int nLeaving = 0, nEntering = 0;
+    for (int n = 0; n < NPIXELS; n++) {
+      if (from.isDisplayed(n) && !to.isDisplayed(n)) nLeaving++;
+      if (!from.isDisplayed(n) && to.isDisplayed(n)) nEntering++;
+    }
+
+    for (int n = 0; n < NPIXELS; n++) {
+      RgbColor f = colorOf(from, n);
+      RgbColor t = colorOf(to, n);
+
+      if (f == t) {
+        _steps[n].duration = 0;
+        continue;
+      }
+
+      switch (_type) {
+      case TransitionMorph:
+      {
+        const int half = TRANSITIONFRAMES / 2;
+        const int d = half / 3;
+
+        if (from.isDisplayed(n) && !to.isDisplayed(n))
+          planPixel(n, f, t, nLeaving > 1 ? leaving++ * (half - d) / (nLeaving - 1) : 0, d);
+        else if (!from.isDisplayed(n) && to.isDisplayed(n))
+          planPixel(n, f, t, half + (nEntering > 1 ? entering++ * (half - d) / (nEntering - 1) : 0), d);
+        else
+          planPixel(n, f, t, 0, TRANSITIONFRAMES);
+        break;
+      }
+      case TransitionWipe:
+      {
+        const int d = TRANSITIONFRAMES / 4;
+        planPixel(n, f, t, columnOf(n) * (TRANSITIONFRAMES - d) / (NCOL - 1), d);
+        break;
+      }
+      case TransitionDissolve:
+      {
+        const int d = TRANSITIONFRAMES / 5;
+        planPixel(n, f, t, random(TRANSITIONFRAMES - d + 1), d);
+        break;
+      }
+      default:
+        planPixel(n, f, t, 0, TRANSITIONFRAMES);
+        break;
+      }
+    }
+
+    _frame.init(TRANSITIONFPS);
+    _frameIndex = 0;
+    _running = true;
+
+    return true;
+  }
+
+  bool running()
+  {
+    return _running;
+  }
+
+  // Draw the next frame of the transition, returns true if the pixels changed
+  bool handle(PixelsArray &out)
+  {
+    if (!_running)
+      return false;
+
+    if (!_frame.next())
+      return false;
+
+    if (_frameIndex >= TRANSITIONFRAMES) {
+      out = _target;
+      _running = false;
+      return true;
+    }
+
+    for (int n = 0; n < NPIXELS; n++) {
+      PixelStep &s = _steps[n];
+
+      if (!s.duration || _frameIndex < s.start || _frameIndex >= s.start + s.duration)
+        continue;
+
+      s.value[0] += s.delta[0];
+      s.value[1] += s.delta[1];
+      s.value[2] += s.delta[2];
+
+      out.set(n, RgbColor(s.value[0] >> 8, s.value[1] >> 8, s.value[2] >> 8));
+    }
+
+    _frameIndex++;
+
+    return true;
   }
 };
 
-struct PixelsContainer
+
+#define SPELLTEXTMAX 64
+#define SPELLFPS 5
+#define SPELLLETTERFRAMES 3 // 600ms by letter
+#define SPELLGAPFRAMES 1    // dark between letters, so double letters blink
+#define SPELLSPACEFRAMES 3  // dark between words
+
+// Spells a text with the letters of the grid, one letter at a time.
+// Each letter is searched after the previous one, left to right and top to bottom,
+// and from the top left cell again when the end of the grid is reached.
+// Characters missing from the grid are skipped.
+class PixelsSpeller
 {
-  PixelsArray pixelsArray;
-  Pixel pixelsEdge[NEDGE];
-  bool hasChanged;
+private:
+  char _text[SPELLTEXTMAX + 1];
+  int _pos;       // next character of the text
+  int _cell;      // cell of the last letter
+  int _frames;    // frames left for the current step
+  bool _lit;      // a letter is displayed
+  RgbColor _color;
+  Frame _frame;
+  bool _running;
+
+  // Next letter of the text in A to Z, 0 at the end, ' ' between words
+  char nextLetter()
+  {
+    while (_text[_pos]) {
+      uint8_t c = _text[_pos++];
+
+      // UTF-8 umlauts are folded to their base letter
+      if (c == 0xC3 && _text[_pos]) {
+        uint8_t c2 = _text[_pos++];
+        if (c2 == 0xA4 || c2 == 0x84) return 'A';
+        if (c2 == 0xB6 || c2 == 0x96) return 'O';
+        if (c2 == 0xBC || c2 == 0x9C) return 'U';
+        continue;
+      }
+
+      if (c >= 'a' && c <= 'z') return c - 'a' + 'A';
+      if (c >= 'A' && c <= 'Z') return c;
+      if (c == ' ') return ' ';
+    }
+
+    return 0;
+  }
+
+public:
+  PixelsSpeller()
+    : _pos(0)
+    , _cell(-1)
+    , _frames(0)
+    , _lit(false)
+    , _frame(SPELLFPS)
+    , _running(false)
+  {
+    _text[0] = 0;
+  }
+
+  bool begin(const char *text, const RgbColor &c)
+  {
+    strncpy(_text, text, SPELLTEXTMAX);
+    _text[SPELLTEXTMAX] = 0;
+
+    _pos = 0;
+    _cell = -1;
+    _frames = 0;
+    _lit = false;
+    _color = c;
+    _frame.init(SPELLFPS);
+    _running = _text[0] != 0;
+
+    return _running;
+  }
+
+  void stop()
+  {
+    _running = false;
+  }
+
+  bool running()
+  {
+    return _running;
+  }
+
+  // Draw the next step of the text, returns true if the pixels changed
+  bool handle(PixelsArray &out)
+  {
+    if (!_running)
+      return false;
+
+    if (!_frame.next())
+      return false;
+
+    if (_frames > 0 && --_frames > 0)
+      return false;
+
+    // Hide the time behind the text
+    out.fill(pBLACK);
+
+    if (_lit) {
+      _lit = false;
+      _frames = SPELLGAPFRAMES;
+      return true;
+    }
+
+    for (;;) {
+      char c = nextLetter();
+
+      if (!c) {
+        _running = false;
+        return true;
+      }
+
+      if (c == ' ') {
+        _frames = SPELLSPACEFRAMES;
+        return true;
+      }
+
+      TextTime &t = _textTimeLayouts.current();
+      int n = t.getNextLetterCell(c, _cell);
+      if (n < 0)
+        n = t.getNextLetterCell(c, -1);
+      if (n < 0)
+        continue;
+
+      out.set(n, _color);
+      _cell = n;
+      _lit = true;
+      _frames = SPELLLETTERFRAMES;
+      return true;
+    }
+  }
 };
 
 
@@ -99,7 +791,7 @@ public:
   virtual int ledsByPixelForMatrix() = 0;
   virtual int ledsByPixelForEdges() = 0;
   virtual int ledsNumber() = 0;
-  virtual String getName() = 0;
+  virtual PGM_P getName() = 0;
   virtual const uint8_t *getLedsMatrixId(int row, int col) = 0;
   virtual const uint8_t *getLedsEdgeId(int n) = 0;
   virtual ~LedConfiguration() {}
@@ -122,9 +814,9 @@ private:
   const uint8_t _matchingPixelsEdge[NEDGE][1] = { { 11 }, {  0 }, { 132 }, { 143 } };
 
 public:
-  virtual String getName()
+  virtual PGM_P getName()
   {
-    return "40x40@1";
+    return PSTR("40x40@1");
   }
 
   int ledsByPixelForMatrix()
@@ -180,9 +872,9 @@ private:
   const uint8_t _matchingPixelsEdge[NEDGE][1] = { { 232 }, { 231 }, { 230 }, { 233 } };
 
 public:
-  virtual String getName()
+  virtual PGM_P getName()
   {
-    return "100x100@1";
+    return PSTR("100x100@1");
   }
 
   int ledsByPixelForMatrix()
@@ -236,9 +928,9 @@ private:
   const uint8_t _matchingPixelsEdge[NEDGE][1] = { { 242 }, { 241 }, { 240 }, { 243 } };
 
 public:
-  virtual String getName()
+  virtual PGM_P getName()
   {
-    return "100x100@2";
+    return PSTR("100x100@2");
   }
 
   int ledsByPixelForMatrix()
@@ -326,16 +1018,26 @@ enum RandomColorMode
 class LedStripMode
 {
 protected:
-  String _name;
-  PixelsContainer *_pPixelContainer;
+  PGM_P _name;
+  PixelsPipeline *_pPipeline;
   RgbColor _color;
   RandomColorMode _colorRandomMode;
 
+  // Frame being drawn
+  PixelsArray &pixels()
+  {
+    return _pPipeline->back();
+  }
+
+  // Publish the frame being drawn
+  void commit()
+  {
+    _pPipeline->commit();
+  }
+
   void setPixelsColor(const Pixel &p)
   {
-    _pPixelContainer->pixelsArray.fill(p);
-    for (int i = 0; i < NEDGE; i++)
-      _pPixelContainer->pixelsEdge[i] = p;
+    pixels().fill(p);
   }
 
   void clearPixelsColor()
@@ -345,15 +1047,15 @@ protected:
   }
   
 public:
-  LedStripMode(String name, PixelsContainer *pPixelContainer)
+  LedStripMode(PGM_P name, PixelsPipeline *pPipeline)
     : _name(name)
-    , _pPixelContainer(pPixelContainer)
+    , _pPipeline(pPipeline)
     , _color(RgbColor(255, 255, 255))
     , _colorRandomMode(ColorRandomNo)
   {
   }
 
-  String getName()
+  PGM_P getName()
   {
     return _name;
   }
@@ -382,8 +1084,8 @@ public:
 class LedStripModeNothing : public LedStripMode
 {
 public:
-  LedStripModeNothing(PixelsContainer *pPixelContainer)
-    : LedStripMode("Nothing", pPixelContainer)
+  LedStripModeNothing(PixelsPipeline *pPipeline)
+    : LedStripMode(PSTR("Nothing"), pPipeline)
   {
   }
 
@@ -392,7 +1094,7 @@ public:
     // Clear display
     clearPixelsColor();
 
-    _pPixelContainer->hasChanged = true;
+    commit();
   }
 
   void handle()
@@ -409,13 +1111,12 @@ public:
 class LedStripModeTime : public LedStripMode
 {
 private:
-  TextTimeCH _textime;
   int _m;
   int _h;
 
 public:
-  LedStripModeTime(PixelsContainer *pPixelContainer)
-    : LedStripMode("Time", pPixelContainer)
+  LedStripModeTime(PixelsPipeline *pPipeline)
+    : LedStripMode(PSTR("Time"), pPipeline)
     , _m(-1)
     , _h(-1)
   {
@@ -435,54 +1136,93 @@ public:
     if (_m == m && _h == h)
       return;
 
-    _m = m;
-    _h = h;
+    uint32_t mask[NPIXELSMASK];
+    uint32_t change[NPIXELSMASK];
 
-    TextTimeBlobs b = _textime.getBlobsFromTime(h, m);
+    TextTime &t = _textTimeLayouts.current();
 
-    if (!b.number)
+    if (!t.getMaskFromTime(h, m, mask))
       return; // TODO: Display something useful
 
-    // Clear display
-    clearPixelsColor();
+    // Only the cells changed since the last minute are drawn again, the other
+    // letters keep their color and the transition leaves them alone
+    if (_h >= 0 && _colorRandomMode != ColorRandomAll && t.getMaskChange(_h, _m, h, m, change))
+    {
+      pixels().clearMask(change);
+      for (int i = 0; i < NPIXELSMASK; i++)
+        change[i] &= mask[i];
+    }
+    else
+    {
+      // Clear display
+      clearPixelsColor();
+      memcpy(change, mask, sizeof(change));
+    }
+
+    _m = m;
+    _h = h;
+
+    for (int i = 0; i < NEDGE; i++)
+      pixels().setEdge(pVOID, i);
 
     RgbColor c = _color;
 
     if (_colorRandomMode == ColorRandomAll)
-      c = HslColor((float)random(256) / 255.0, 1.0, 0.5);
+      c = randomHueColor();
 
-    for (int i = 0; i < b.number; i++)
+    if (_colorRandomMode == ColorRandomWord || _colorRandomMode == ColorRandomLetter)
     {
-      if (_colorRandomMode == ColorRandomWord)
-        c = HslColor((float)random(256) / 255.0, 1.0, 0.5);
+      // One color by word or by letter, walk the words
+      TextTimeBlobs b = t.getBlobsFromTime(h, m);
 
-      for (int j = 0; j < b.blobs[i]->number; j++)
+      for (int i = 0; i < b.number; i++)
       {
-        if (_colorRandomMode == ColorRandomLetter)
-          c = HslColor((float)random(256) / 255.0, 1.0, 0.5);
-
-        Pixel p;
-        p.color = c;
-        p.display = true;
-        _pPixelContainer->pixelsArray.setPixel(p, b.blobs[i]->pixels[j].row, b.blobs[i]->pixels[j].col);
+        bool colored = false;
+
+        for (int j = 0; j < b.blobs[i].number; j++)
+        {
+          TextTimeWord w = b.blobs[i].word(j);
+
+          for (int k = 0; k < w.length; k++)
+          {
+            // Letters already shown keep their colors
+            int n = PixelsArray::index(w.row, w.col + k);
+            if (!(change[n >> 5] & (1UL << (n & 31))))
+              continue;
+
+            if (_colorRandomMode == ColorRandomWord && !colored)
+              c = randomHueColor();
+            colored = true;
+
+            if (_colorRandomMode == ColorRandomLetter)
+              c = randomHueColor();
+
+            Pixel p;
+            p.color = c;
+            p.display = true;
+            pixels().setPixel(p, w.row, w.col + k);
+          }
+        }
       }
     }
+    else
+      pixels().fillMask(change, c);
 
     if (_colorRandomMode == ColorRandomWord)
-      c = HslColor((float)random(256) / 255.0, 1.0, 0.5);
+      c = randomHueColor();
 
     for (int i = 0; i < m % 5; i++)
     {
       if (_colorRandomMode == ColorRandomLetter)
-        c = HslColor((float)random(256) / 255.0, 1.0, 0.5);
+        c = randomHueColor();
 
       Pixel p;
       p.color = c;
       p.display = true;
-      _pPixelContainer->pixelsEdge[i] = p;
+      pixels().setEdge(p, i);
     }
 
-    _pPixelContainer->hasChanged = true;
+    commit();
   }
 
   bool allowAnimation()
@@ -498,8 +1238,8 @@ private:
   int _s;
 
 public:
-  LedStripModeSeconds(PixelsContainer *pPixelContainer)
-    : LedStripMode("Seconds", pPixelContainer)
+  LedStripModeSeconds(PixelsPipeline *pPipeline)
+    : LedStripMode(PSTR("Seconds"), pPipeline)
     , _s(-1)
   {
   }
@@ -519,9 +1259,9 @@ public:
     // Clear display
     clearPixelsColor();
 
-    ::copyNumberToMatrix(_s, _pPixelContainer->pixelsArray, _color);
+    ::copyNumberToMatrix(_s, pixels(), _color);
 
-    _pPixelContainer->hasChanged = true;
+    commit();
   }
 
   bool allowAnimation()
@@ -536,8 +1276,8 @@ private:
   int _s;
 
 public:
-  LedStripModeDay(PixelsContainer *pPixelContainer)
-    : LedStripMode("Day", pPixelContainer)
+  LedStripModeDay(PixelsPipeline *pPipeline)
+    : LedStripMode(PSTR("Day"), pPipeline)
     , _s(-1)
   {
   }
@@ -557,9 +1297,9 @@ public:
     // Clear display
     clearPixelsColor();
 
-    ::copyNumberToMatrix(_s, _pPixelContainer->pixelsArray, _color);
+    ::copyNumberToMatrix(_s, pixels(), _color);
 
-    _pPixelContainer->hasChanged = true;
+    commit();
   }
 
   bool allowAnimation()
@@ -575,8 +1315,8 @@ private:
   int _s;
 
 public:
-  LedStripModeTemperature(PixelsContainer *pPixelContainer)
-    : LedStripMode("Temperature", pPixelContainer)
+  LedStripModeTemperature(PixelsPipeline *pPipeline)
+    : LedStripMode(PSTR("Temperature"), pPipeline)
     , _s(-1)
   {
   }
@@ -597,14 +1337,15 @@ public:
     clearPixelsColor();
 
     // Display Temperature
-    if (!RTC.GetIsRunning())
+    const SensorValue &v = _sensorTemperature.getValue();
+    if (!v.isValid())
       return; // TODO: Display something useful
 
-    int8_t t = RTC.GetTemperature().AsFloatDegC();
+    int8_t t = v.value;
 
-    ::copyNumberToMatrix(t, _pPixelContainer->pixelsArray, _color);
+    ::copyNumberToMatrix(t, pixels(), _color);
 
-    _pPixelContainer->hasChanged = true;
+    commit();
   }
 
   bool allowAnimation()
@@ -616,45 +1357,46 @@ public:
 class LedStripModeTestColors : public LedStripMode
 {
 private:
+  Frame _frame;
   int _t;
 
 public:
-  LedStripModeTestColors(PixelsContainer *pPixelContainer)
-    : LedStripMode("Test Colors", pPixelContainer)
+  LedStripModeTestColors(PixelsPipeline *pPipeline)
+    : LedStripMode(PSTR("Test Colors"), pPipeline)
     , _t(0)
   {
   }
 
   void begin()
   {
+    // One color every 2 seconds
+    _frame.init(0.5);
     _t = 0;
   }
 
   void handle()
   {
+    if (!_frame.next())
+      return;
+
     switch (_t)
     {
     case 0:
       setPixelsColor(pRED);
-      _pPixelContainer->hasChanged = true;
       break;
-    case 100000:
+    case 1:
       setPixelsColor(pGREEN);
-      _pPixelContainer->hasChanged = true;
       break;
-    case 200000:
+    case 2:
       setPixelsColor(pBLUE);
-      _pPixelContainer->hasChanged = true;
       break;
-    case 300000:
+    case 3:
       setPixelsColor(pWHITE);
-      _pPixelContainer->hasChanged = true;
-      break;
-    case 400000:
-      _t = -1;
       break;
     }
-    _t++;
+    commit();
+
+    _t = (_t + 1) % 4;
   }
 
   bool allowAnimation()
@@ -671,8 +1413,8 @@ private:
   int _e;
 
 public:
-  LedStripModeTestSpeed(PixelsContainer *pPixelContainer)
-    : LedStripMode("Test Speed", pPixelContainer)
+  LedStripModeTestSpeed(PixelsPipeline *pPipeline)
+    : LedStripMode(PSTR("Test Speed"), pPipeline)
     , _r(0)
     , _c(0)
     , _e(0)
@@ -688,7 +1430,8 @@ public:
 
   void handle()
   {
-    if (_pPixelContainer->hasChanged)
+    // Wait for the previous position to be displayed
+    if (_pPipeline->hasPending())
       return;
 
     if (_c == NCOL) {
@@ -707,10 +1450,10 @@ public:
     }
 
     clearPixelsColor();
-    _pPixelContainer->pixelsArray.setPixel(pWHITE, _r, _c++);
-    _pPixelContainer->pixelsEdge[_e] = pWHITE;
+    pixels().setPixel(pWHITE, _r, _c++);
+    pixels().setEdge(pWHITE, _e);
 
-    _pPixelContainer->hasChanged = true;
+    commit();
   }
 
   bool allowAnimation()
@@ -723,13 +1466,13 @@ public:
 class LedStripModeTestStrip : public LedStripMode
 {
 private:
-  MyNeoPixelBrightnessBus **_ppStrip;
+  MyNeoPixelBrightnessBus **_ppStrip;   // the strip is built again for each led configuration
   Frame _frame;
   int _index;
 
 public:
-  LedStripModeTestStrip(PixelsContainer *pPixelContainer, MyNeoPixelBrightnessBus **ppStrip)
-    : LedStripMode("Test Strip", pPixelContainer)
+  LedStripModeTestStrip(PixelsPipeline *pPipeline, MyNeoPixelBrightnessBus **ppStrip)
+    : LedStripMode(PSTR("Test Strip"), pPipeline)
     , _ppStrip(ppStrip)
     , _index(0)
   {
@@ -746,21 +1489,19 @@ public:
     if (!_frame.next())
       return;
 
-    // Clear display
-    clearPixelsColor();
+    // Do not commit any frame because this mode write directly to the strip device
 
-    // Do not update buffer because this animation write directly to the strip device
-    _pPixelContainer->hasChanged = false;
+    MyNeoPixelBrightnessBus *pStrip = *_ppStrip;
 
-    if (!(*_ppStrip)->CanShow())
+    if (!pStrip->CanShow())
       return;
 
-    if (_index > (*_ppStrip)->PixelCount())
+    if (_index >= pStrip->PixelCount())
       _index = 0;
 
-    (*_ppStrip)->ClearTo(RgbColor(0, 0, 0));
-    (*_ppStrip)->SetPixelColor(_index++, RgbColor(255, 255, 255));
-    (*_ppStrip)->Show();
+    pStrip->ClearTo(RgbColor(0, 0, 0));
+    pStrip->SetPixelColor(_index++, RgbColor(255, 255, 255));
+    pStrip->Show();
   }
 
   bool allowAnimation()
@@ -770,60 +1511,269 @@ public:
 };
 
 
+enum LedOutputMode
+{
+  OutputDirect = 0,   // colors sent as is, scaled by the brightness
+  OutputGamma,        // gamma corrected colors
+  OutputGammaDither   // gamma corrected colors with temporal dithering
+};
+
+#define NLEDOUTPUTMODES (OutputGammaDither + 1)
+#define DITHERFPS 100     // redraws of a still frame while its dithering error is carried
+
+// Shown on the General page
+PGM_P getLedOutputName(int mode)
+{
+  switch (mode) {
+    case OutputDirect: return PSTR("Direct");
+    case OutputGamma: return PSTR("Gamma");
+    case OutputGammaDither: return PSTR("Gamma + dithering (strip redrawn at 100 Hz)");
+  }
+  return PSTR("");
+}
+
+#define NLEDCONFIGURATIONSMAX 4
+#define NMODESMAX 8
+
+// Leds of the largest led configuration
+#define NLEDSMAX ((NROW * 24) + NEDGE)
+
+typedef StaticVector<LedConfiguration *, NLEDCONFIGURATIONSMAX> LedConfigurationList;
+typedef StaticVector<LedStripMode *, NMODESMAX> LedStripModeList;
+
+// Brightness eases toward its target by 1/8 of the distance every frame,
+// about 95% of the way in 500ms
+#define BRIGHTNESSFPS 50
+#define BRIGHTNESSEASESHIFT 3
+
 class MyLedStrip
 {
 protected:
+  struct LedMapEntry
+  {
+    uint8_t number;
+    uint8_t leds[LEDSBYPIXELMAX];
+  };
+
+  // Built in place with the leds of the configuration, a Show() sends no more
+  alignas(MyNeoPixelBrightnessBus) uint8_t _stripStorage[sizeof(MyNeoPixelBrightnessBus)];
   MyNeoPixelBrightnessBus *_pStrip;
-  cl_Lst<LedConfiguration *> _ledConfiguration;
+  LedConfigurationList _ledConfiguration;
   int _ledConfigurationIndex;
-  PixelsContainer _pixels;
+  LedMapEntry _ledMap[NPIXELS];
+  RgbColor _ledsShown[NPIXELS];
+  bool _ledsInvalid;
+  LedOutputMode _outputMode;
+  uint8_t _brightness;          // output level
+  uint8_t _brightnessTarget;
+  int32_t _brightnessLevel;     // 8.8 fixed point
+  bool _brightnessStarted;
+  Frame _brightnessFrame;
+  bool _outputRedraw;
+  uint8_t _ditherError[NPIXELS][3];
+  bool _ditherActive;
+  Frame _ditherFrame;
+  PixelsPipeline _pixels;
   bool _automaticBrightness;
-  cl_Lst<LedStripMode *> _modeList;
+  BrightnessCurve _brightnessCurve;
+  uint32_t _minimumKey;         // minute and settings the minimum brightness was computed for
+  int _minimum;
+  LedStripModeList _modeList;
   int _modeIndex;
 
-  bool refresh(PixelsContainer *pPixel)
+  // Led configurations and modes are members, nothing is allocated on the heap
+  LedConfiguration40x40 _ledConfiguration40x40;
+  LedConfiguration100x100_1 _ledConfiguration100x100_1;
+  LedConfiguration100x100_2 _ledConfiguration100x100_2;
+
+  LedStripModeNothing _modeNothing;
+  LedStripModeTime _modeTime;
+  LedStripModeSeconds _modeSeconds;
+  LedStripModeDay _modeDay;
+  LedStripModeTemperature _modeTemperature;
+  LedStripModeTestColors _modeTestColors;
+  LedStripModeTestSpeed _modeTestSpeed;
+  LedStripModeTestStrip _modeTestStrip;
+
+  // Write one pixel to its leds only if its color differs from the displayed one
+  bool updateLeds(int n, const RgbColor &c)
   {
-    if (!pPixel->hasChanged)
+    if (c == _ledsShown[n])
       return false;
 
-    if (!_pStrip->CanShow())
-      return false;
+    for (int l = 0; l < _ledMap[n].number; l++)
+      _pStrip->SetPixelColor(_ledMap[n].leds[l], c);
 
-    // Reset led strip
-    _pStrip->ClearTo(RgbColor(0, 0, 0));
+    _ledsShown[n] = c;
+
+    return true;
+  }
+
+  // Flatten the selected led configuration into a pixel to leds table
+  void initLedMap()
+  {
+    LedConfiguration *pConfig = _ledConfiguration[_ledConfigurationIndex];
 
-    // Fill leds strip with matrix pixels
     for (int r = 0; r < NROW; r++) {
       for (int c = 0; c < NCOL; c++) {
-        Pixel p = pPixel->pixelsArray.getPixel(r, c);
-        const uint8_t *i = _ledConfiguration[_ledConfigurationIndex]->getLedsMatrixId(r, c);
+        const uint8_t *i = pConfig->getLedsMatrixId(r, c);
+        LedMapEntry &m = _ledMap[(r * NCOL) + c];
 
-        if (!p.display) continue;
-
-        for (int l = 0; l < _ledConfiguration[_ledConfigurationIndex]->ledsByPixelForMatrix(); l++)
-          _pStrip->SetPixelColor(i[l], p.color);
+        m.number = pConfig->ledsByPixelForMatrix();
+        for (int l = 0; l < m.number; l++)
+          m.leds[l] = i[l];
       }
     }
 
-    // Fill leds strip with edge pixels
     for (int e = 0; e < NEDGE; e++) {
-      Pixel p = pPixel->pixelsEdge[e];
-      const uint8_t *i = _ledConfiguration[_ledConfigurationIndex]->getLedsEdgeId(e);
+      const uint8_t *i = pConfig->getLedsEdgeId(e);
+      LedMapEntry &m = _ledMap[(NROW * NCOL) + e];
+
+      m.number = pConfig->ledsByPixelForEdges();
+      for (int l = 0; l < m.number; l++)
+        m.leds[l] = i[l];
+    }
+
+    _ledsInvalid = true;
+  }
+
+  void clearLeds()
+  {
+    _pStrip->ClearTo(RgbColor(0, 0, 0));
+    for (int n = 0; n < NPIXELS; n++)
+      _ledsShown[n] = RgbColor(0, 0, 0);
+  }
 
-      if (!p.display) continue;
+  // Gamma correction and brightness on 16 bits, then back to 8 bits
+  // by rounding or by carrying the remainder to the next refresh (dithering)
+  uint8_t outputComponent(uint8_t v, uint8_t &error)
+  {
+    uint32_t v16 = ((uint32_t)gamma16(v) * (_brightness + 1)) >> 8;
 
-      for (int l = 0; l < _ledConfiguration[_ledConfigurationIndex]->ledsByPixelForEdges(); l++)
-        _pStrip->SetPixelColor(i[l], p.color);
+    if (_outputMode == OutputGammaDither) {
+      v16 += error;
+      error = v16 & 0xFF;
+      _ditherActive |= error != 0;
     }
+    else
+      v16 += 0x80;
 
-    // Refresh display
-    _pStrip->Show();
+    if (v16 > 0xFFFF)
+      v16 = 0xFFFF;
+
+    return v16 >> 8;
+  }
+
+  // The strip brightness stays at 255 : it would rescale its led buffer on
+  // each change, losing precision on the leds that are not written again
+  RgbColor outputColor(int n, const RgbColor &c)
+  {
+    if (_outputMode == OutputDirect)
+      return RgbColor((c.R * (_brightness + 1)) >> 8, (c.G * (_brightness + 1)) >> 8, (c.B * (_brightness + 1)) >> 8);
+
+    return RgbColor(outputComponent(c.R, _ditherError[n][0]),
+                    outputComponent(c.G, _ditherError[n][1]),
+                    outputComponent(c.B, _ditherError[n][2]));
+  }
+
+  bool refresh(PixelsPipeline *pPipeline)
+  {
+    // Keep the frame pending until the strip is ready
+    if (!_pStrip->CanShow())
+      return false;
+
+    // Without a new frame, the last one is redrawn only if the output stage needs it
+    // (brightness change, dithering at DITHERFPS at most)
+    if (!pPipeline->acquire() && (_ledsInvalid || !(_outputRedraw || (_ditherActive && _ditherFrame.next()))))
+      return false;
+
+    bool changed = false;
 
-    pPixel->hasChanged = false;
+    // Reset led strip if its content is unknown (first frame, direct strip access)
+    if (_ledsInvalid)
+    {
+      clearLeds();
+
+      _ledsInvalid = false;
+      changed = true;
+    }
+
+    _outputRedraw = false;
+    _ditherActive = false;
+
+    // Update leds of pixels that changed since the last frame
+    const PixelsArray &pa = pPipeline->front();
+    for (int n = 0; n < NPIXELS; n++)
+      changed |= updateLeds(n, outputColor(n, pa.isDisplayed(n) ? pa.color(n) : RgbColor(0, 0, 0)));
+
+    // Refresh display
+    if (changed) {
+      _perfShow.start();
+      _pStrip->Show();
+      _perfShow.stop();
+    }
 
     return true;
   }
 
+  // New brightness target, reached by the ramp. The first one applies at once.
+  void applyBrightness(uint8_t b)
+  {
+    _brightnessTarget = b;
+
+    if (!_brightnessStarted) {
+      _brightnessStarted = true;
+      _brightnessLevel = (int32_t)b << 8;
+      outputBrightness(b);
+    }
+  }
+
+  // The next refresh shows the new level with the frame
+  void outputBrightness(uint8_t b)
+  {
+    if (b == _brightness)
+      return;
+
+    _brightness = b;
+    _outputRedraw = true;
+  }
+
+  // One easing step by frame, nothing to draw while the output level is the same
+  void rampBrightness()
+  {
+    int32_t diff = ((int32_t)_brightnessTarget << 8) - _brightnessLevel;
+
+    if (!diff || !_brightnessFrame.next())
+      return;
+
+    // 1/16 of a level at least to land on the target
+    int32_t step = diff / (1 << BRIGHTNESSEASESHIFT);
+    if (step > -0x10 && step < 0x10)
+      step = diff > 0x10 ? 0x10 : (diff < -0x10 ? -0x10 : diff);
+
+    _brightnessLevel += step;
+    outputBrightness((_brightnessLevel + 0x80) >> 8);
+  }
+
+  // Minimum brightness for the time of day
+  int minimumBrightness()
+  {
+    int sd = _config.brightnessAutoMinDay;      // minimum brightness during the day
+    int sn = _config.brightnessAutoMinNight;    // minimum brightness during the night
+
+    int s = sn;
+
+    if (_dateTime.hour > 21 || _dateTime.hour < 9) s = sn; // between 22h and 9h
+    if (_dateTime.hour > 9 && _dateTime.hour < 21) s = sd; // between 10h and 21h
+
+    if (_dateTime.hour == 21) s = map(_dateTime.minute, 0, 59, sd, sn); // during the 21th hour
+    if (_dateTime.hour == 9) s = map(_dateTime.minute, 0, 59, sn, sd); // during the 9th hour
+
+    if (s == 0) s = 1;
+
+    return s;
+  }
+
   // Update brightness every 50ms
   void handleAutomaticBrightness()
   {
@@ -836,34 +1786,27 @@ protected:
 
     if (v != p)
     {
-      int sd = _config.brightnessAutoMinDay;      // minimum brightness during the day
-      int sn = _config.brightnessAutoMinNight;    // minimum brightness during the night
-      int sm = 255;                               // maximum brightness
-      int lmin = 0;                               // minimum lux sensitivity allowed
-      int lmax = _config.luxSensitivity * 10;     // maximum lux sensitivity allowed
-
-      int s = sn;
-
-      if (_dateTime.hour > 21 && _dateTime.hour < 9) s = sn; // between 22h and 9h
-      if (_dateTime.hour > 9 && _dateTime.hour < 21) s = sd; // between 10h and 21h
-
-      if (_dateTime.hour == 21) s = map(_dateTime.minute, 0, 59, sd, sn); // during the 21th hour
-      if (_dateTime.hour == 9) s = map(_dateTime.minute, 0, 59, sn, sd); // during the 9th hour
-
-      if (s == 0) s = 1;
-
-      int l = getAvgLux();
-      if (l < lmin) l = lmin;
-      if (l > lmax) l = lmax;
-      _pStrip->SetBrightness(map(l, lmin, lmax, s, sm)); // limit
+      // The minimum only moves with the minute or with its settings,
+      // and the curve with the minimum or with the sensitivity
+      uint32_t key = _dateTime.minute | (_config.brightnessAutoMinDay << 8) | ((uint32_t)_config.brightnessAutoMinNight << 16);
+      if (key != _minimumKey) {
+        _minimumKey = key;
+        _minimum = minimumBrightness();
+      }
+      _brightnessCurve.build(_config.luxSensitivity * 10, _minimum);
 
-      if (_pStrip->CanShow())
-        _pStrip->Show();
+      applyBrightness(_brightnessCurve.lookup(getFilteredLux()));
     }
 
     p = v;
   }
 
+  void handleBrightness()
+  {
+    handleAutomaticBrightness();
+    rampBrightness();
+  }
+
   bool handleMode()
   {
     if (_modeIndex < 0) return false;
@@ -877,66 +1820,82 @@ public:
   MyLedStrip()
     : _pStrip(NULL)
     , _ledConfigurationIndex(0)
+    , _ledsInvalid(true)
+    , _outputMode(OutputDirect)
+    , _brightness(255)
+    , _brightnessTarget(255)
+    , _brightnessLevel(255 << 8)
+    , _brightnessStarted(false)
+    , _brightnessFrame(BRIGHTNESSFPS)
+    , _outputRedraw(false)
+    , _ditherActive(false)
+    , _ditherFrame(DITHERFPS)
     , _automaticBrightness(false)
+    , _minimumKey(0xFFFFFFFF)
+    , _minimum(1)
     , _modeIndex(0)
+    , _modeNothing(&_pixels)
+    , _modeTime(&_pixels)
+    , _modeSeconds(&_pixels)
+    , _modeDay(&_pixels)
+    , _modeTemperature(&_pixels)
+    , _modeTestColors(&_pixels)
+    , _modeTestSpeed(&_pixels)
+    , _modeTestStrip(&_pixels, &_pStrip)
+  {
+    _ledConfiguration.push_back(&_ledConfiguration40x40);
+    _ledConfiguration.push_back(&_ledConfiguration100x100_1);
+    _ledConfiguration.push_back(&_ledConfiguration100x100_2);
+
+    _modeList.push_back(&_modeNothing);
+    _modeList.push_back(&_modeTime);
+    _modeList.push_back(&_modeSeconds);
+    _modeList.push_back(&_modeDay);
+    _modeList.push_back(&_modeTemperature);
+    _modeList.push_back(&_modeTestColors);
+    _modeList.push_back(&_modeTestSpeed);
+    _modeList.push_back(&_modeTestStrip);
+  }
+
+  LedStripModeList *getModesList()
   {
-
-    _ledConfiguration.push_back(new LedConfiguration40x40());
-    _ledConfiguration.push_back(new LedConfiguration100x100_1());
-    _ledConfiguration.push_back(new LedConfiguration100x100_2());
-
-    _modeList.push_back(new LedStripModeNothing(&_pixels));
-    _modeList.push_back(new LedStripModeTime(&_pixels));
-    _modeList.push_back(new LedStripModeSeconds(&_pixels));
-    _modeList.push_back(new LedStripModeDay(&_pixels));
-    _modeList.push_back(new LedStripModeTemperature(&_pixels));
-    _modeList.push_back(new LedStripModeTestColors(&_pixels));
-    _modeList.push_back(new LedStripModeTestSpeed(&_pixels));
-    _modeList.push_back(new LedStripModeTestStrip(&_pixels, &_pStrip));
-  }
-
-  ~MyLedStrip()
-  {
-    end();
-
-    _modeList.clear();
+    return &_modeList;
   }
 
-  cl_Lst<LedStripMode *> *getModesList()
+  LedConfigurationList *getLedConfigurationList()
   {
-    return &_modeList;
+    return &_ledConfiguration;
   }
 
-  cl_Lst<LedConfiguration *> *getLedConfigurationList()
+  int getLedConfigurationIndex()
   {
-    return &_ledConfiguration;
+    return _ledConfigurationIndex;
   }
 
+  // Apply the led configuration, the strip is built again if its length changes
   void begin()
   {
-    end();
+    _ledConfigurationIndex = _config.ledConfig;
+    if (_ledConfigurationIndex > _ledConfiguration.size() - 1)
+      _ledConfigurationIndex = _ledConfiguration.size() - 1;
+
+    initLedMap();
+
+    uint16_t count = _ledConfiguration[_ledConfigurationIndex]->ledsNumber();
+    if (!_pStrip || _pStrip->PixelCount() != count) {
+      if (_pStrip)
+        _pStrip->~MyNeoPixelBrightnessBus();
 
-    if (!_pStrip)
-    { 
-      _ledConfigurationIndex = _config.ledConfig;
-      
       // Cannot use DMA because DMA GPIO is already used by serial/USB bridge :(
-      _pStrip = new MyNeoPixelBrightnessBus(_ledConfiguration[_ledConfigurationIndex]->ledsNumber(), D4);
+      _pStrip = new (_stripStorage) MyNeoPixelBrightnessBus(count, D4);
       _pStrip->Begin();
     }
+    _pStrip->SetBrightness(255);
 
     _pStrip->ClearTo(RgbColor(0, 0, 0));
     _pStrip->Show();
   }
 
-  void end()
-  {
-    if (_pStrip)
-      delete _pStrip;
-
-    _pStrip = NULL;
-  }
-
   void setAutomaticBrightness(int b)
   {
     _automaticBrightness = b;
@@ -945,22 +1904,38 @@ public:
   void setBrightness(uint8_t b)
   {
     if (b < 1) b = 1;
-    if (b > 255) b = 255;
 
     if (_automaticBrightness)
       return;
 
-    _pStrip->SetBrightness(b);
+    applyBrightness(b);
+  }
 
-    if (_pStrip->CanShow())
-      _pStrip->Show();
+  uint8_t getBrightness()
+  {
+    return _brightness;
+  }
+
+  bool setOutputMode(int mode)
+  {
+    if (mode < OutputDirect) return false;
+    if (mode >= NLEDOUTPUTMODES) return false;
+
+    _outputMode = (LedOutputMode)mode;
 
-    //refresh();
+    // Redraw the last frame with the new output
+    clearLeds();
+    memset(_ditherError, 0, sizeof(_ditherError));
+    _outputRedraw = true;
+
+    _mqtt.publish(mqttTopicPubLedOutput.topic().c_str(), String(mode).c_str());
+
+    return true;
   }
 
-  uint8_t getBrightness()
+  int getOutputMode()
   {
-    return _pStrip->GetBrightness();
+    return _outputMode;
   }
 
   void setColor(byte r, byte g, byte b)
@@ -1005,6 +1980,15 @@ public:
 
     _modeIndex = mode;
 
+    // Some modes write directly to the strip, so redraw everything
+    _ledsInvalid = true;
+
+    // Drop the last frame of the previous mode
+    _pixels.reset();
+
+    // Timings are measured for each mode and animation
+    perfReset();
+
     _modeList[_modeIndex]->begin();
 
     _mqtt.publish(mqttTopicPubLedMode.topic().c_str(), String(mode).c_str());
@@ -1012,14 +1996,43 @@ public:
     return true;
   }
 
+  // Word layout of the clock face, 0 is the built-in one
+  bool setLayout(int index)
+  {
+    if (index < 0 || index >= _textTimeLayouts.size())
+      return false;
+
+    // An invalid file falls back to the built-in layout, redrawn as well
+    bool ok = _textTimeLayouts.select(index);
+
+    // Redraw the mode with the new layout
+    _pixels.reset();
+    _modeList[_modeIndex]->begin();
+
+    return ok;
+  }
+
+  int getLayout()
+  {
+    return _textTimeLayouts.getIndex();
+  }
+
   int getModeIndex()
   {
     return _modeIndex;
   }
 
+  const PixelsPipelineStats &getModeFramesStats()
+  {
+    return _pixels.stats();
+  }
+
   void handle()
   {
-    handleAutomaticBrightness();
+    // Same time for all the modes and animations of this loop pass
+    frameTick();
+
+    handleBrightness();
     handleMode();
     refresh(&_pixels);
   }
@@ -1040,15 +2053,49 @@ protected:
   };
 
 protected:
-  String _name;
-  PixelsContainer *_pPixelContainerInput;
-  PixelsContainer *_pPixelContainerOutput;
+  PGM_P _name;
+  PixelsPipeline *_pInput;
+  PixelsCompositor *_pCompositor;
+  PixelsLayer *_pLayer;
+  uint32_t _inputSequence;
+
+  // Returns true if the mode published a new frame since the last call
+  bool inputChanged()
+  {
+    if (_inputSequence == _pInput->frontSequence())
+      return false;
+
+    _inputSequence = _pInput->frontSequence();
+    return true;
+  }
+
+  // Last frame of the mode
+  const PixelsArray &input()
+  {
+    return _pInput->front();
+  }
+
+  // Draw the animation in its own layer
+  void useLayer(int id, LayerBlendMode blend)
+  {
+    _pLayer = &_pCompositor->enableLayer(id, blend);
+  }
+
+  // Layer being drawn
+  PixelsArray &output()
+  {
+    return _pLayer->pixels;
+  }
+
+  // Publish the layer being drawn
+  void commit()
+  {
+    _pLayer->dirty = true;
+  }
 
   void setPixelsColor(const Pixel &p)
   {
-    _pPixelContainerOutput->pixelsArray.fill(p);
-    for (int i = 0; i < NEDGE; i++)
-      _pPixelContainerOutput->pixelsEdge[i] = p;
+    output().fill(p);
   }
 
   void clearPixelsColor()
@@ -1058,14 +2105,16 @@ protected:
   }
 
 public:
-  LedStripAnimation(String name, PixelsContainer *pPixelContainerInput, PixelsContainer *pPixelContainerOutput)
+  LedStripAnimation(PGM_P name, PixelsPipeline *pInput, PixelsCompositor *pCompositor)
     : _name(name)
-    , _pPixelContainerInput(pPixelContainerInput)
-    , _pPixelContainerOutput(pPixelContainerOutput)
+    , _pInput(pInput)
+    , _pCompositor(pCompositor)
+    , _pLayer(NULL)
+    , _inputSequence(0)
   {
   }
 
-  String getName()
+  PGM_P getName()
   {
     return _name;
   }
@@ -1077,23 +2126,17 @@ public:
 class LedStripAnimationNormal : public LedStripAnimation
 {
 public:
-  LedStripAnimationNormal(PixelsContainer *pPixelContainerInput, PixelsContainer *pPixelContainerOutput)
-    : LedStripAnimation("Normal", pPixelContainerInput, pPixelContainerOutput)
+  LedStripAnimationNormal(PixelsPipeline *pInput, PixelsCompositor *pCompositor)
+    : LedStripAnimation(PSTR("Normal"), pInput, pCompositor)
   {
   }
 
   void begin()
   {
-    // Force refresh of input pixels because
-    // we copy them to the output buffer only
-    // When they change. (To limit CPU usage)
-    _pPixelContainerInput->hasChanged = true;
   }
 
   void handle()
-  { // Just copy input pixels to output pixels if they change
-    if (_pPixelContainerInput->hasChanged)
-      *_pPixelContainerOutput = *_pPixelContainerInput;
+  { // The mode pixels are displayed as is by the foreground layer
   }
 };
 
@@ -1101,7 +2144,7 @@ class LedStripAnimationBlink : public LedStripAnimation
 {
 private:
   Frame _frame;
-  cl_Lst<PixelPos> _pixelPosition;
+  StaticVector<PixelPos, NPIXELS> _pixelPosition;
 
   void initPixelsList()
   {
@@ -1111,13 +2154,13 @@ private:
     // Fill on pixels from matrix to the list
     for (int c = 0; c < NCOL; c++) {
       for (int r = 0; r < NROW; r++) {
-        Pixel p = _pPixelContainerInput->pixelsArray.getPixel(r, c);
+        Pixel p = input().getPixel(r, c);
         if (p.display) {
           PixelPos pp;
           pp.e = -1;
           pp.c = c;
           pp.r = r;
-          pp.p = p;
+          pp.p = pWHITE;
           _pixelPosition.push_back(pp);
         }
       }
@@ -1125,21 +2168,21 @@ private:
 
     // Fill on pixels from edge to the list
     for (int e = 0; e < NEDGE; e++) {
-      Pixel p = _pPixelContainerInput->pixelsEdge[e];
+      Pixel p = input().getEdge(e);
       if (p.display) {
         PixelPos pp;
         pp.e = e;
         pp.c = -1;
         pp.r = -1;
-        pp.p = p;
+        pp.p = pWHITE;
         _pixelPosition.push_back(pp);
       }
     }
   }
 
 public:
-  LedStripAnimationBlink(PixelsContainer *pPixelContainerInput, PixelsContainer *pPixelContainerOutput)
-    : LedStripAnimation("Blink", pPixelContainerInput, pPixelContainerOutput)
+  LedStripAnimationBlink(PixelsPipeline *pInput, PixelsCompositor *pCompositor)
+    : LedStripAnimation(PSTR("Blink"), pInput, pCompositor)
   {
   }
 
@@ -1147,14 +2190,20 @@ public:
   {
     _frame.init(50);
 
+    _inputSequence = _pInput->frontSequence();
     initPixelsList();
-    clearPixelsColor();
+
+    // Multiply all pixels by black to hide them,
+    // then reveal them one by one by multiplying them by white
+    useLayer(LayerEffect, BlendMultiply);
+    setPixelsColor(pBLACK);
+    commit();
   }
 
   void handle()
   {
     // If display has changed, reset the animation
-    if (_pPixelContainerInput->hasChanged)
+    if (inputChanged())
       begin();
 
     if (!_frame.next())
@@ -1165,14 +2214,14 @@ public:
 
     int idx = random(_pixelPosition.size());
     PixelPos pp = _pixelPosition[idx];
-    _pixelPosition.remove(idx);
+    _pixelPosition.swap_remove(idx);
 
     if (pp.e == -1)
-      _pPixelContainerOutput->pixelsArray.setPixel(pp.p, pp.r, pp.c);
+      output().setPixel(pp.p, pp.r, pp.c);
     else
-      _pPixelContainerOutput->pixelsEdge[pp.e] = pp.p;
+      output().setEdge(pp.p, pp.e);
 
-    _pPixelContainerOutput->hasChanged = true;
+    commit();
   }
 };
 
@@ -1190,14 +2239,16 @@ private:
   }
 
 public:
-  LedStripAnimationFire(PixelsContainer *pPixelContainerInput, PixelsContainer *pPixelContainerOutput)
-    : LedStripAnimation("Fire", pPixelContainerInput, pPixelContainerOutput)
+  LedStripAnimationFire(PixelsPipeline *pInput, PixelsCompositor *pCompositor)
+    : LedStripAnimation(PSTR("Fire"), pInput, pCompositor)
   {
   }
 
   void begin()
   {
     _frame.init(8);
+
+    useLayer(LayerBackground, BlendReplace);
   }
 
   void handle()
@@ -1205,29 +2256,13 @@ public:
     if (!_frame.next())
       return;
 
-    for (int c = 0; c < NCOL; c++) {
-      for (int r = 0; r < NROW; r++) {
-        Pixel pb;
-        pb.color = generateFireColor();
-        pb.display = true;
-
-        Pixel pf = _pPixelContainerInput->pixelsArray.getPixel(r, c);
-
-        _pPixelContainerOutput->pixelsArray.setPixel(pf.display ? pf : pb, r, c);
-      }
-    }
-
-    for (int e = 0; e < NEDGE; e++) {
-      Pixel pb;
-      pb.color = generateFireColor();
-      pb.display = true;
-
-      Pixel pf = _pPixelContainerInput->pixelsEdge[e];
+    PixelsArray &out = output();
 
-      _pPixelContainerOutput->pixelsEdge[e] = pf.display ? pf : pb;
-    }
+    // Fire background behind foreground pixels (matrix and edges)
+    for (int n = 0; n < NPIXELS; n++)
+      out.set(n, generateFireColor());
 
-    _pPixelContainerOutput->hasChanged = true;
+    commit();
   }
 };
 
@@ -1239,8 +2274,8 @@ private:
   int _matrixColumnSize;
 
 public:
-  LedStripAnimationMatrix(PixelsContainer *pPixelContainerInput, PixelsContainer *pPixelContainerOutput)
-    : LedStripAnimation("Matrix", pPixelContainerInput, pPixelContainerOutput)
+  LedStripAnimationMatrix(PixelsPipeline *pInput, PixelsCompositor *pCompositor)
+    : LedStripAnimation(PSTR("Matrix"), pInput, pCompositor)
     , _matrixColumnSize(9)
   {
   }
@@ -1251,6 +2286,8 @@ public:
 
     for (int i = 0; i < NCOL; i++)
       _matrixColumn[i] = -1;
+
+    useLayer(LayerBackground, BlendReplace);
   }
 
   void handle()
@@ -1260,8 +2297,6 @@ public:
 
     clearPixelsColor();
 
-    // Copy background matrix pixels
-
     // Create a new column if possible (= -1)
     for (int c = 0; c < NCOL; c++) {
       if (_matrixColumn[c] == -1) {
@@ -1278,7 +2313,7 @@ public:
 
       Pixel green = pGREEN;
       for (int r = _matrixColumn[c]; r > _matrixColumn[c] - _matrixColumnSize; r--) {
-        _pPixelContainerOutput->pixelsArray.setPixel(green, r, c);
+        output().setPixel(green, r, c);
         green.color.Darken(30);
       }
 
@@ -1288,23 +2323,7 @@ public:
         _matrixColumn[c] = -1;
     }
 
-    // Copy foreground matrix pixels
-    for (int c = 0; c < NCOL; c++) {
-      for (int r = 0; r < NROW; r++) {
-        Pixel pf = _pPixelContainerInput->pixelsArray.getPixel(r, c);
-        if (pf.display)
-          _pPixelContainerOutput->pixelsArray.setPixel(pf, r, c);
-      }
-    }
-
-    // Copy foreground edge pixels
-    for (int e = 0; e < NEDGE; e++) {
-      Pixel pf = _pPixelContainerInput->pixelsEdge[e];
-      if (pf.display)
-        _pPixelContainerOutput->pixelsEdge[e] = pf;
-    }
-
-    _pPixelContainerOutput->hasChanged = true;
+    commit();
   }
 };
 
@@ -1312,18 +2331,27 @@ class LedStripAnimationRainbow : public LedStripAnimation
 {
 private:
   Frame _frame;
-  double _rainbowIndex;
+  uint16_t _rainbowHue;
+
+  // Hue of a matrix cell: the rainbow spans 60 degrees over the matrix
+  uint16_t cellHue(int n)
+  {
+    return _rainbowHue + (uint32_t)n * 0x10000 / (NROW * NCOL * 6);
+  }
 
 public:
-  LedStripAnimationRainbow(PixelsContainer *pPixelContainerInput, PixelsContainer *pPixelContainerOutput)
-    : LedStripAnimation("Rainbow", pPixelContainerInput, pPixelContainerOutput)
-    , _rainbowIndex(0)
+  LedStripAnimationRainbow(PixelsPipeline *pInput, PixelsCompositor *pCompositor)
+    : LedStripAnimation(PSTR("Rainbow"), pInput, pCompositor)
+    , _rainbowHue(0)
   {
   }
 
   void begin()
   {
     _frame.init(10);
+
+    // Rainbow colors replace the foreground pixels colors
+    useLayer(LayerEffect, BlendMask);
   }
 
   void handle()
@@ -1333,40 +2361,26 @@ public:
 
     clearPixelsColor();
 
-    _rainbowIndex += 0.001;
-
-    if (_rainbowIndex > 1.0)
-      _rainbowIndex = 0.0;
-
-    // Copy foreground matrix pixels
-    for (int c = 0; c < NCOL; c++) {
-      for (int r = 0; r < NROW; r++) {
-
-        double hsl = ((double)((r * NCOL) + c) / (double)(NROW * NCOL)) * (60.0 / 360.0);
-        hsl += _rainbowIndex;
-        if (hsl > 1.0) hsl -= 1.0;
-
-        Pixel pf = _pPixelContainerInput->pixelsArray.getPixel(r, c);
-        pf.color = HslColor(hsl, 1.0, 0.5);
-
-        if (pf.display)
-          _pPixelContainerOutput->pixelsArray.setPixel(pf, r, c);
+    // About 0.001 turn by frame
+    _rainbowHue += 66;
 
-        if (c == 0 && r == 0 && _pPixelContainerInput->pixelsEdge[0].display)
-          _pPixelContainerOutput->pixelsEdge[0] = Pixel(pf.color);
+    const PixelsArray &in = input();
+    PixelsArray &out = output();
 
-        if (c == NCOL - 1 && r == 0 && _pPixelContainerInput->pixelsEdge[1].display)
-          _pPixelContainerOutput->pixelsEdge[1] = Pixel(pf.color);
-
-        if (c == NCOL - 1 && r == NROW - 1 && _pPixelContainerInput->pixelsEdge[2].display)
-          _pPixelContainerOutput->pixelsEdge[2] = Pixel(pf.color);
+    // Color foreground matrix pixels
+    for (int n = 0; n < NROW * NCOL; n++) {
+      if (in.isDisplayed(n))
+        out.set(n, hue16ToRgb(cellHue(n)));
+    }
 
-        if (c == 0 && r == NROW - 1 && _pPixelContainerInput->pixelsEdge[3].display)
-          _pPixelContainerOutput->pixelsEdge[3] = Pixel(pf.color);
-      }
+    // Color foreground edge pixels like their nearest corner
+    const int corners[NEDGE] = { PixelsArray::index(0, 0), PixelsArray::index(0, NCOL - 1), PixelsArray::index(NROW - 1, NCOL - 1), PixelsArray::index(NROW - 1, 0) };
+    for (int e = 0; e < NEDGE; e++) {
+      if (in.isDisplayed(PixelsArray::edgeIndex(e)))
+        out.set(PixelsArray::edgeIndex(e), hue16ToRgb(cellHue(corners[e])));
     }
 
-    _pPixelContainerOutput->hasChanged = true;
+    commit();
   }
 };
 
@@ -1378,8 +2392,8 @@ private:
   PixelPos _snowFlake[ANIMSNOWFLAKENB];
 
 public:
-  LedStripAnimationSnowFlake(PixelsContainer *pPixelContainerInput, PixelsContainer *pPixelContainerOutput)
-    : LedStripAnimation("Snowflakes", pPixelContainerInput, pPixelContainerOutput)
+  LedStripAnimationSnowFlake(PixelsPipeline *pInput, PixelsCompositor *pCompositor)
+    : LedStripAnimation(PSTR("Snowflakes"), pInput, pCompositor)
   {
   }
 
@@ -1390,6 +2404,8 @@ public:
     for (int i = 0; i < ANIMSNOWFLAKENB; i++) {
       _snowFlake[i].e = 0;
     }
+
+    useLayer(LayerBackground, BlendReplace);
   }
 
   void handle()
@@ -1426,55 +2442,70 @@ public:
 
     for (int i = 0; i < ANIMSNOWFLAKENB; i++) {
       if (_snowFlake[i].e > 0) {
-        _pPixelContainerOutput->pixelsArray.setPixel(_snowFlake[i].p.color, _snowFlake[i].r, _snowFlake[i].c);
+        output().setPixel(_snowFlake[i].p.color, _snowFlake[i].r, _snowFlake[i].c);
         _snowFlake[i].e -= 1;
         _snowFlake[i].p.color.Darken(5);
       }
     }
 
-    // Copy foreground matrix pixels
-    for (int c = 0; c < NCOL; c++) {
-      for (int r = 0; r < NROW; r++) {
-        Pixel pf = _pPixelContainerInput->pixelsArray.getPixel(r, c);
-        if (pf.display)
-          _pPixelContainerOutput->pixelsArray.setPixel(pf, r, c);
-      }
-    }
-
-    // Copy foreground edge pixels
-    for (int e = 0; e < NEDGE; e++) {
-      Pixel pf = _pPixelContainerInput->pixelsEdge[e];
-      if (pf.display)
-        _pPixelContainerOutput->pixelsEdge[e] = pf;
-    }
-
-    _pPixelContainerOutput->hasChanged = true;
+    commit();
   }
 };
 
+#define NANIMATIONSMAX 8
+
+typedef StaticVector<LedStripAnimation *, NANIMATIONSMAX> LedStripAnimationList;
+
 class MyLedStripAnimator : public MyLedStrip
 {
 protected:
-  PixelsContainer _animatedPixels;
-  cl_Lst<LedStripAnimation *> _animationList;
+  PixelsPipeline _animatedPixels;
+  PixelsCompositor _compositor;
+  PixelsTransition _transition;
+  PixelsSpeller _speller;
+  LedStripAnimationList _animationList;
   int _animationIndex;
 
+  LedStripAnimationNormal _animationNormal;
+  LedStripAnimationBlink _animationBlink;
+  LedStripAnimationFire _animationFire;
+  LedStripAnimationMatrix _animationMatrix;
+  LedStripAnimationRainbow _animationRainbow;
+  LedStripAnimationSnowFlake _animationSnowFlake;
+
   bool handleAnimation()
   {
     if (_animationIndex < 0) return false;
     if (_animationIndex > _animationList.size() - 1) return false;
 
-    // check if the animated pixel buffer is displayed
-    // if not, do not update the animated pixel buffer
-    if (_animatedPixels.hasChanged) return false;
+    // The last frame of the mode is the foreground layer,
+    // reached through a transition if one is selected
+    PixelsLayer &l = _compositor.layer(LayerForeground);
+    if (_pixels.hasPending()) {
+      _pixels.acquire();
+      if (!_transition.begin(l.pixels, _pixels.front())) {
+        l.pixels = _pixels.front();
+        l.dirty = true;
+      }
+    }
 
-    // update the animated pixel buffer
+    if (_transition.handle(l.pixels))
+      l.dirty = true;
+
+    // update the animation layer
     _animationList[_animationIndex]->handle();
 
-    // if output pixels buffer is updated
-    // then simulate update of the input buffer
-    if (_animatedPixels.hasChanged)
-      _pixels.hasChanged = false;
+    // text spelled over the other layers
+    if (_speller.running()) {
+      PixelsLayer &o = _compositor.layer(LayerOverlay);
+      if (_speller.handle(o.pixels))
+        o.dirty = true;
+      if (!_speller.running())
+        _compositor.disableLayer(LayerOverlay);
+    }
+
+    // and blend the layers in the animated pixel buffer
+    _compositor.compose();
 
     return true;
   }
@@ -1482,14 +2513,23 @@ protected:
 public:
   MyLedStripAnimator()
     : MyLedStrip()
+    , _compositor(&_animatedPixels)
     , _animationIndex(0)
+    , _animationNormal(&_pixels, &_compositor)
+    , _animationBlink(&_pixels, &_compositor)
+    , _animationFire(&_pixels, &_compositor)
+    , _animationMatrix(&_pixels, &_compositor)
+    , _animationRainbow(&_pixels, &_compositor)
+    , _animationSnowFlake(&_pixels, &_compositor)
   {
-    _animationList.push_back(new LedStripAnimationNormal(&_pixels, &_animatedPixels));
-    _animationList.push_back(new LedStripAnimationBlink(&_pixels, &_animatedPixels));
-    _animationList.push_back(new LedStripAnimationFire(&_pixels, &_animatedPixels));
-    _animationList.push_back(new LedStripAnimationMatrix(&_pixels, &_animatedPixels));
-    _animationList.push_back(new LedStripAnimationRainbow(&_pixels, &_animatedPixels));
-    _animationList.push_back(new LedStripAnimationSnowFlake(&_pixels, &_animatedPixels));
+    _compositor.enableLayer(LayerForeground, BlendReplace);
+
+    _animationList.push_back(&_animationNormal);
+    _animationList.push_back(&_animationBlink);
+    _animationList.push_back(&_animationFire);
+    _animationList.push_back(&_animationMatrix);
+    _animationList.push_back(&_animationRainbow);
+    _animationList.push_back(&_animationSnowFlake);
   }
 
   bool setAnimation(int mode)
@@ -1498,6 +2538,14 @@ public:
     if (mode > _animationList.size() - 1) return false;
 
     _animationIndex = mode;
+
+    // Drop the last frame and the layers of the previous animation
+    _animatedPixels.reset();
+    perfReset();
+    for (int i = 0; i < NLAYERS; i++)
+      if (i != LayerForeground && i != LayerOverlay)
+        _compositor.disableLayer(i);
+
     _animationList[_animationIndex]->begin();
 
     _mqtt.publish(mqttTopicPubLedAnim.topic().c_str(), String(mode).c_str());
@@ -1510,25 +2558,72 @@ public:
     return _animationIndex;
   }
 
-  cl_Lst<LedStripAnimation *> *getAnimationsList()
+  LedStripAnimationList *getAnimationsList()
   {
     return &_animationList;
   }
 
+  bool setTransition(int type)
+  {
+    if (type < TransitionNone) return false;
+    if (type >= NTRANSITIONS) return false;
+
+    _transition.setType((TransitionType)type);
+
+    return true;
+  }
+
+  int getTransition()
+  {
+    return _transition.getType();
+  }
+
+  // Spell a text on the grid in the color of the mode, an empty text stops it
+  bool spellText(String text)
+  {
+    if (!_speller.begin(text.c_str(), _modeList[_modeIndex]->getColor())) {
+      _compositor.disableLayer(LayerOverlay);
+      return false;
+    }
+
+    _compositor.enableLayer(LayerOverlay, BlendReplace);
+
+    return true;
+  }
+
+  const PixelsPipelineStats &getAnimationFramesStats()
+  {
+    return _animatedPixels.stats();
+  }
+
   void handle()
   {
-    handleAutomaticBrightness();
+    // Same time for all the modes and animations of this loop pass
+    frameTick();
+
+    handleBrightness();
 
-    if (!handleMode()) return;
+    _perfMode.start();
+    bool handled = handleMode();
+    _perfMode.stop();
+
+    if (!handled) return;
 
     if (_modeList[_modeIndex]->allowAnimation())
     {
+      _perfAnimation.start();
       handleAnimation();
+      _perfAnimation.stop();
+
+      _perfRefresh.start();
       refresh(&_animatedPixels);
+      _perfRefresh.stop();
     }
     else
     {
+      _perfRefresh.start();
       refresh(&_pixels);
+      _perfRefresh.stop();
     }
   }
 };
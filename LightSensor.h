@@ -1,27 +1,117 @@
 #define ALS_PIN A0
 #define ALS_AVG_SIZE 50
+#define ALS_EMA_SHIFT 2         // weight of a new sample : 1/4
+#define ALS_HYSTERESIS 3        // quarters of a brightness curve step
 
+// Light level filters, updated at each sample in constant time:
+// a running sum over the last ALS_AVG_SIZE samples for the reports, and for
+// the brightness a median of 3 against spikes followed by an exponential
+// average (lux * 16)
 int _avg[ALS_AVG_SIZE];
+int _avgIndex = 0;
+int _avgCount = 0;
+long _avgSum = 0;
+
+int _median[3];
+long _ema = -1;
 
 void updateAvgLux(int als)
 {
-  static int i = 0;
+  if (als < 0) als = 0;
+
+  _avgSum += als;
+  if (_avgCount == ALS_AVG_SIZE)
+    _avgSum -= _avg[_avgIndex];
+  else
+    _avgCount++;
+  _avg[_avgIndex++] = als;
+  if (_avgIndex == ALS_AVG_SIZE) _avgIndex = 0;
+
+  // The first sample fills the filters
+  if (_ema < 0) {
+    _median[0] = _median[1] = _median[2] = als;
+    _ema = (long)als << 4;
+    return;
+  }
+
+  _median[0] = _median[1];
+  _median[1] = _median[2];
+  _median[2] = als;
+
+  int a = _median[0], b = _median[1], c = _median[2];
+  int m = a;
+  if ((b >= a && b <= c) || (b <= a && b >= c)) m = b;
+  else if ((c >= a && c <= b) || (c <= a && c >= b)) m = c;
 
-  _avg[i++] = als;
-  if (i == ALS_AVG_SIZE) i = 0;
+  _ema += (((long)m << 4) - _ema) >> ALS_EMA_SHIFT;
 }
 
+// Average of the last samples, 0 before the first one
 int getAvgLux()
 {
-  int sum = 0;
+  return _avgCount ? _avgSum / _avgCount : 0;
+}
 
-  for (int i = 0; i < ALS_AVG_SIZE; i++)
-    sum += _avg[i];
+// Filtered light level for the brightness, 0 before the first sample
+int getFilteredLux()
+{
+  return _ema < 0 ? 0 : (_ema + 8) >> 4;
+}
 
-  if (sum < 0.0) sum = 0;
+// Light level to brightness, from the minimum brightness at 0 lux to 255 at
+// the sensitivity, along a square root : the eye adapts to the room light, so
+// the display brightens fast when a dark room gets some light and slowly in
+// daylight. The table is rebuilt when one of them changes only. A lookup
+// indexes it with a multiply by the reciprocal of the sensitivity and a shift,
+// a step moves after the light level went 3/4 of a step past it.
+#define LUXCURVESTEPS 128
 
-  return sum / ALS_AVG_SIZE;
-}
+class BrightnessCurve
+{
+private:
+  uint8_t _table[LUXCURVESTEPS + 1];
+  int _luxMax;
+  int _min;
+  uint32_t _scale;              // quarters of a step by lux (16.16)
+  int _step;
+
+public:
+  BrightnessCurve()
+    : _luxMax(-1)
+    , _min(-1)
+    , _scale(0)
+    , _step(0)
+  {
+  }
+
+  void build(int luxMax, int min)
+  {
+    if (luxMax < 1) luxMax = 1;
+    if (luxMax == _luxMax && min == _min)
+      return;
+
+    for (int i = 0; i <= LUXCURVESTEPS; i++)
+      _table[i] = min + (uint8_t)((255 - min) * sqrtf((float)i / LUXCURVESTEPS) + 0.5f);
+
+    _scale = ((uint32_t)LUXCURVESTEPS * 4 << 16) / luxMax;
+    _luxMax = luxMax;
+    _min = min;
+  }
+
+  uint8_t lookup(int lux)
+  {
+    if (lux < 0) lux = 0;
+    if (lux > _luxMax) lux = _luxMax;
+
+    // Position in quarters of a step
+    int q = ((uint32_t)lux * _scale + 0x8000) >> 16;
+
+    if (q > _step * 4 + ALS_HYSTERESIS || q < _step * 4 - ALS_HYSTERESIS)
+      _step = (q + 2) / 4;
+
+    return _table[_step];
+  }
+};
 
 void handleAmbientLightSensor()
 {
@@ -6,6 +6,15 @@
 */
 
 #define NTP_PACKET_SIZE 48
+#ifndef NTP_PORT
+#define NTP_PORT 123
+#endif
+#define NTP_LOCAL_PORT 2390
+#define NTPSERVERSMAX 3
+#define NTPTIMEOUT 2000                   // ms to wait for a DNS answer or a reply
+#define NTPRETRYMIN 4000                  // ms before the first retry, doubled on each failed round
+#define NTPRETRYMAX 300000
+#define NTPUNIXOFFSET 2208988800UL        // seconds from 1900 to 1970
 #define LEAP_YEAR(Y) ( ((1970+Y)>0) && !((1970+Y)%4) && ( ((1970+Y)%100) || !((1970+Y)%400) ) )
 
 struct strDateTime
@@ -21,83 +30,503 @@ struct strDateTime
 
 unsigned long _timestamp = 0;  	          // GLOBALTIME, will be refreshed every Second
 strDateTime _dateTime;                    // Global DateTime structure, will be refreshed every Second
-unsigned long _previousUpdate = 0;        // Used to save last automatic ntp update time
+unsigned long _localTimestamp = 0;        // Local time of _dateTime, with time zone and daylight saving
 
 
 static const uint8_t _monthDays[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
-byte _packetBuffer[NTP_PACKET_SIZE];
-WiFiUDP _UDPNTPClient;
 
 
-
-void getNTPtime()
+//
+// Disciplined clock : UTC in us, driven by micros64(). The oscillator error
+// is estimated from the NTP offsets (or from the RTC without NTP) and
+// corrected continuously, small offsets are slewed, large ones stepped.
+//
+#define CLOCKSTEPMIN 500                  // ms, larger offsets are stepped
+#define CLOCKSLEWRATE 2000                // ppm, small offsets are absorbed by 2ms each second
+#define CLOCKDRIFTMAX 500                 // ppm
+#define CLOCKDRIFTINTERVAL 900            // s between two NTP samples to estimate the drift
+#define CLOCKDRIFTAGREE 10                // ppm between two estimates to apply them, a server step gives one only
+#define CLOCKRTCDRIFTINTERVAL 86400       // s of RTC to estimate the drift without NTP
+#define CLOCKNTPVALIDITY 172800           // s after an NTP sample during which the RTC is not followed
+
+class SystemClock
 {
-  if (WiFi.status() == WL_CONNECTED)
+public:
+  enum Source { None, Rtc, Ntp };
+
+protected:
+  int64_t _utc;               // us since 1970
+  uint64_t _last;             // micros64() of _utc
+  int32_t _drift;             // ppb added to the oscillator
+  int64_t _driftRemainder;
+  int64_t _slew;              // us still to add
+  Source _source;
+
+  int32_t _offset;            // ms, last offset measured by NTP, or by the RTC without NTP
+  uint64_t _ntpSample;        // micros64() of the last NTP sample
+  int32_t _residual;          // ppb of the drift left by the previous NTP sample
+  bool _residualValid;
+
+  uint64_t _rtcAnchor;        // micros64() and RTC time of the first RTC sample
+  uint32_t _rtcAnchorSeconds;
+  int32_t _rtcDrift;          // ppb of the oscillator against the RTC
+
+  void update()
   {
-    _UDPNTPClient.begin(2390);  // Port for NTP receive
-    IPAddress timeServerIP;
-    WiFi.hostByName(_config.ntpServerName.c_str(), timeServerIP);
+    uint64_t m = micros64();
+    int64_t e = (int64_t)(m - _last);
+    _last = m;
+
+    // Oscillator correction, the remainder is kept for the next pass
+    int64_t c = e * _drift + _driftRemainder;
+    _driftRemainder = c % 1000000000LL;
+
+    // Slew, never backwards
+    int64_t s = e * CLOCKSLEWRATE / 1000000;
+    if (_slew > 0)
+      s = _slew < s ? _slew : s;
+    else
+      s = _slew > -s ? _slew : -s;
+    _slew -= s;
 
-    Serial.println("NTP:sending NTP packet...");
-    memset(_packetBuffer, 0, NTP_PACKET_SIZE);
-    _packetBuffer[0] = 0b11100011;   // LI, Version, Mode
-    _packetBuffer[1] = 0;     // Stratum, or type of clock
-    _packetBuffer[2] = 6;     // Polling Interval
-    _packetBuffer[3] = 0xEC;  // Peer Clock Precision
-    _packetBuffer[12] = 49;
-    _packetBuffer[13] = 0x4E;
-    _packetBuffer[14] = 49;
-    _packetBuffer[15] = 52;
-    _UDPNTPClient.beginPacket(timeServerIP, 123);
-    _UDPNTPClient.write(_packetBuffer, NTP_PACKET_SIZE);
-    _UDPNTPClient.endPacket();
+    _utc += e + c / 1000000000LL + s;
+  }
+
+  void adjust(int64_t offsetUs)
+  {
+    if (offsetUs >= CLOCKSTEPMIN * 1000LL || offsetUs <= -CLOCKSTEPMIN * 1000LL) {
+      _utc += offsetUs;
+      _slew = 0;
+    }
+    else
+      _slew = offsetUs;
+  }
+
+  static int32_t clampDrift(int64_t ppb)
+  {
+    if (ppb > CLOCKDRIFTMAX * 1000LL) return CLOCKDRIFTMAX * 1000L;
+    if (ppb < -CLOCKDRIFTMAX * 1000LL) return -CLOCKDRIFTMAX * 1000L;
+    return (int32_t)ppb;
+  }
+
+public:
+  SystemClock()
+    : _utc(0)
+    , _last(0)
+    , _drift(0)
+    , _driftRemainder(0)
+    , _slew(0)
+    , _source(None)
+    , _offset(0)
+    , _ntpSample(0)
+    , _residual(0)
+    , _residualValid(false)
+    , _rtcAnchor(0)
+    , _rtcAnchorSeconds(0)
+    , _rtcDrift(0)
+  {
+  }
+
+  int64_t nowMicros()
+  {
+    update();
+    return _utc;
+  }
+
+  int64_t nowMillis()
+  {
+    return nowMicros() / 1000;
+  }
+
+  unsigned long nowSeconds()
+  {
+    return (unsigned long)(nowMicros() / 1000000);
+  }
+
+  // Set the time without any estimation, e.g. on the host
+  void setTime(unsigned long seconds)
+  {
+    update();
+    _utc = (int64_t)seconds * 1000000;
+    _slew = 0;
+  }
+
+  // NTP offset in ms : slew or step, then the oscillator error since the previous sample
+  void ntpSample(int32_t offset)
+  {
+    update();
+    adjust((int64_t)offset * 1000);
+
+    // The offset accumulated since the previous sample is the drift left, applied when two samples agree.
+    // A stepped offset is a time change, not a drift.
+    uint64_t interval = _last - _ntpSample;
+    bool stepped = offset >= CLOCKSTEPMIN || offset <= -CLOCKSTEPMIN;
+    if (_source == Ntp && !stepped && interval >= CLOCKDRIFTINTERVAL * 1000000ULL) {
+      int32_t residual = clampDrift((int64_t)offset * 1000000000LL / (int64_t)(interval / 1000));
+      if (_residualValid && labs(residual - _residual) <= CLOCKDRIFTAGREE * 1000L) {
+        _drift = clampDrift((int64_t)_drift + residual);
+        residual = 0;
+      }
+      _residual = residual;
+      _residualValid = true;
+    }
+
+    _ntpSample = _last;
+    _offset = offset;
+    _source = Ntp;
+  }
+
+  // RTC time in whole seconds, its middle is the best guess
+  void rtcSample(uint32_t seconds)
+  {
+    update();
+
+    if (!_rtcAnchor) {
+      _rtcAnchor = _last;
+      _rtcAnchorSeconds = seconds;
+    }
+    else if (_last - _rtcAnchor >= CLOCKRTCDRIFTINTERVAL * 1000000ULL) {
+      int64_t span = (int64_t)(_last - _rtcAnchor);
+      _rtcDrift = clampDrift(((int64_t)(seconds - _rtcAnchorSeconds) * 1000000 - span) * 1000LL / (span / 1000000));
+    }
+
+    if (_source == Ntp && _last - _ntpSample < CLOCKNTPVALIDITY * 1000000ULL)
+      return;
+
+    // Without NTP, the RTC is followed beyond its resolution, and its drift used
+    int64_t offset = (int64_t)seconds * 1000000 + 500000 - _utc;
+    if (_source == None || offset >= 1000000 || offset <= -1000000)
+      adjust(offset);
+    if (_last - _rtcAnchor >= CLOCKRTCDRIFTINTERVAL * 1000000ULL)
+      _drift = _rtcDrift;
+
+    _offset = (int32_t)(offset / 1000);
+    _source = Rtc;
+  }
+
+  // The RTC has been set, its drift is measured again
+  void rtcSet()
+  {
+    _rtcAnchor = 0;
+  }
+
+  Source getSource() { return _source; }
+  int32_t getOffset() { return _offset; }
+  int32_t getDrift() { return _drift; }
+  int32_t getRtcDrift() { return _rtcDrift; }
+  int32_t getSlew() { return (int32_t)(_slew / 1000); }
+
+  const char *getSourceName()
+  {
+    const char *sources[] = { "none", "RTC", "NTP" };
+
+    return sources[_source];
   }
+};
+
+SystemClock _clock;
+
+// 64 bits NTP time stamp at an offset of the packet to ms since 1970
+int64_t ntpReadMillis(const byte *p)
+{
+  uint32_t seconds = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+  uint32_t fraction = ((uint32_t)p[4] << 24) | ((uint32_t)p[5] << 16) | ((uint32_t)p[6] << 8) | p[7];
+
+  return ((int64_t)seconds - NTPUNIXOFFSET) * 1000 + (((uint64_t)fraction * 1000 + 0x80000000UL) >> 32);
 }
 
-void handleNTPRequest()
+void ntpWriteMillis(byte *p, int64_t ms)
+{
+  uint32_t seconds = (uint32_t)(ms / 1000 + NTPUNIXOFFSET);
+  uint32_t fraction = (uint32_t)(((uint64_t)(ms % 1000) << 32) / 1000);
+
+  for (int i = 0; i < 4; i++) {
+    p[i] = seconds >> (24 - 8 * i);
+    p[4 + i] = fraction >> (24 - 8 * i);
+  }
+}
+
+struct NTPSample
+{
+  bool valid;
+  int32_t offset;   // ms to add to the local clock
+  int32_t delay;    // round trip, without the server processing time, in ms
+  byte stratum;
+  String server;
+};
+
+//
+// Non blocking NTP client : resolves and queries the servers one after the
+// other, keeps the reply with the shortest round trip and retries the failed
+// rounds with a growing delay. handle() never waits, it is called each loop.
+//
+class NTPClient
 {
-  unsigned long unixTime = 0;
+public:
+  enum State { Idle, Resolve, Send, Wait };
+
+protected:
+  State _state;
+  WiFiUDP _udp;
+  bool _udpStarted;
+  StaticVector<String, NTPSERVERSMAX> _servers;
+  int _server;
+  IPAddress _address;
+  int8_t _resolved;           // 1 found, -1 failed, 0 pending
+  uint64_t _stateTime;
+  int64_t _t1;                // local time of the request
+  byte _packet[NTP_PACKET_SIZE];
+  NTPSample _best;
+  NTPSample _last;
+  uint32_t _retryDelay;
+  uint64_t _nextRound;        // millis64() of the next round, 0 for none
+
+  static void dnsFound(const char *name, const ip_addr_t *ipaddr, void *arg)
+  {
+    NTPClient *client = (NTPClient *)arg;
+
+    // A late answer for a server given up
+    if (client->_state != Resolve || client->_servers[client->_server] != name)
+      return;
+
+    if (ipaddr)
+      client->_address = IPAddress(ipaddr->addr);
+    client->_resolved = ipaddr ? 1 : -1;
+  }
+
+  void setState(State state)
+  {
+    _state = state;
+    _stateTime = millis64();
+  }
 
-  if (WiFi.status() != WL_CONNECTED)
-    return ;
+  // Server list : names separated by spaces or commas
+  void parseServers(const String &names)
+  {
+    String name;
+
+    _servers.clear();
+    for (unsigned int i = 0; i <= names.length(); i++) {
+      char c = i < names.length() ? names[i] : ' ';
+      if (c == ' ' || c == ',') {
+        if (name.length() && !_servers.full())
+          _servers.push_back(name);
+        name = "";
+      }
+      else
+        name += c;
+    }
+  }
 
-  int cb = _UDPNTPClient.parsePacket();
+  void resolve()
+  {
+    ip_addr_t addr;
+
+    setState(Resolve);
+    _resolved = 0;
 
-  if (cb != 0)
+    err_t err = dns_gethostbyname(_servers[_server].c_str(), &addr, dnsFound, this);
+    if (err == ERR_OK) {
+      _address = IPAddress(addr.addr);
+      _resolved = 1;
+    }
+    else if (err != ERR_INPROGRESS)
+      _resolved = -1;
+  }
+
+  void send()
+  {
+    memset(_packet, 0, NTP_PACKET_SIZE);
+    _packet[0] = 0b11100011;   // LI, Version, Mode
+    _packet[1] = 0;     // Stratum, or type of clock
+    _packet[2] = 6;     // Polling Interval
+    _packet[3] = 0xEC;  // Peer Clock Precision
+    _packet[12] = 49;
+    _packet[13] = 0x4E;
+    _packet[14] = 49;
+    _packet[15] = 52;
+
+    // The server copies the transmit time stamp into the originate one
+    _t1 = _clock.nowMillis();
+    ntpWriteMillis(_packet + 40, _t1);
+
+    _udp.beginPacket(_address, NTP_PORT);
+    _udp.write(_packet, NTP_PACKET_SIZE);
+    _udp.endPacket();
+
+    setState(Wait);
+  }
+
+  // Reply to the pending request, with the four time stamps
+  bool receive()
   {
-    Serial.print("NTP:NTP packet received, length=");
-    Serial.println(cb);
+    byte reply[NTP_PACKET_SIZE];
+    int size = _udp.parsePacket();
+
+    if (size <= 0)
+      return false;
+
+    int64_t t4 = _clock.nowMillis();
+    if (size < NTP_PACKET_SIZE || _udp.read(reply, NTP_PACKET_SIZE) != NTP_PACKET_SIZE)
+      return false;
+
+    // Server mode, synchronized, and answering our request
+    if ((reply[0] & 0x07) != 4 || (reply[0] >> 6) == 3 || reply[1] == 0 || reply[1] > 15 || memcmp(reply + 24, _packet + 40, 8))
+      return false;
 
-    _UDPNTPClient.read(_packetBuffer, NTP_PACKET_SIZE); // read the packet into the buffer
-    unsigned long highWord = word(_packetBuffer[40], _packetBuffer[41]);
-    unsigned long lowWord = word(_packetBuffer[42], _packetBuffer[43]);
-    unsigned long secsSince1900 = highWord << 16 | lowWord;
-    const unsigned long seventyYears = 2208988800UL;
+    int64_t t1 = _t1;
+    int64_t t2 = ntpReadMillis(reply + 32);
+    int64_t t3 = ntpReadMillis(reply + 40);
 
-    unixTime = secsSince1900 - seventyYears;
+    NTPSample sample;
+    sample.valid = true;
+    sample.offset = (int32_t)(((t2 - t1) + (t3 - t4)) / 2);
+    sample.delay = (int32_t)((t4 - t1) - (t3 - t2));
+    if (sample.delay < 0)
+      sample.delay = 0;
+    sample.stratum = reply[1];
+    sample.server = _servers[_server];
+
+    Serial.println("NTP:" + sample.server + " offset " + String(sample.offset) + "ms, delay " + String(sample.delay) + "ms");
+
+    if (!_best.valid || sample.delay < _best.delay)
+      _best = sample;
+
+    return true;
   }
 
-  if (unixTime > 0)
+  void nextServer()
   {
-    Serial.println("NTP Sync Dt : " + String((int32_t)(unixTime - _timestamp)) + "s");
-    _timestamp = unixTime; // store universally available time stamp
+    if (++_server < _servers.size())
+      resolve();
+    else
+      finish();
   }
 
-  if (unixTime > 0)
+  void finish()
   {
-    // Update RTC
+    setState(Idle);
+
+    if (!_best.valid) {
+      Serial.println("NTP:no reply, retry in " + String(_retryDelay / 1000) + "s");
+      _nextRound = millis64() + _retryDelay;
+      _retryDelay = (_retryDelay * 2 < NTPRETRYMAX) ? _retryDelay * 2 : NTPRETRYMAX;
+      return;
+    }
+
+    apply(_best);
+    _last = _best;
+    _retryDelay = NTPRETRYMIN;
+    _nextRound = _config.Update_Time_Via_NTP_Every ? millis64() + (uint64_t)_config.Update_Time_Via_NTP_Every * 1000 : 0;
+  }
+
+  void apply(const NTPSample &sample)
+  {
+    Serial.println("NTP Sync Dt : " + String(sample.offset) + "ms");
+    _clock.ntpSample(sample.offset);
+
+    // Update RTC, only when it is off by more than its resolution to keep measuring its drift
+    unsigned long t = _clock.nowSeconds();
+    if (RTC.GetIsRunning()) {
+      long dt = (long)(RTC.GetDateTime().Epoch32Time() - t);
+      if (dt >= -1 && dt <= 1)
+        return;
+    }
+
     RtcDateTime dt;
-    dt.InitWithEpoch32Time(_timestamp);
+    dt.InitWithEpoch32Time(t);
     RTC.SetDateTime(dt);
+    _clock.rtcSet();
+  }
+
+public:
+  NTPClient()
+    : _state(Idle)
+    , _udpStarted(false)
+    , _server(0)
+    , _resolved(0)
+    , _stateTime(0)
+    , _t1(0)
+    , _retryDelay(NTPRETRYMIN)
+    , _nextRound(0)
+  {
+    _best.valid = false;
+    _last.valid = false;
+  }
+
+  // Start a round now, unless one is running
+  void request()
+  {
+    if (_state != Idle || WiFi.status() != WL_CONNECTED)
+      return;
+
+    parseServers(_config.ntpServerName);
+    if (!_servers.size())
+      return;
+
+    if (!_udpStarted)
+      _udpStarted = _udp.begin(NTP_LOCAL_PORT);  // Port for NTP receive
+
+    _best.valid = false;
+    _server = 0;
+    Serial.println("NTP:sending NTP packet...");
+    resolve();
   }
 
-  // Resync with NTP
-  if (_previousUpdate == 0) _previousUpdate = _timestamp;
-  if (_config.Update_Time_Via_NTP_Every && ((long)(_timestamp - _previousUpdate) >= _config.Update_Time_Via_NTP_Every))
+  void handle()
   {
-    _previousUpdate = _timestamp;
-    getNTPtime();
+    if (WiFi.status() != WL_CONNECTED) {
+      if (_state != Idle) {
+        setState(Idle);
+        _nextRound = millis64() + _retryDelay;
+      }
+      return;
+    }
+
+    bool timeout = millis64() - _stateTime >= NTPTIMEOUT;
+
+    switch (_state) {
+    case Idle:
+      if (_nextRound && millis64() >= _nextRound) {
+        _nextRound = 0;
+        request();
+      }
+      break;
+
+    case Resolve:
+      if (_resolved > 0)
+        setState(Send);
+      else if (_resolved < 0 || timeout)
+        nextServer();
+      break;
+
+    case Send:
+      send();
+      break;
+
+    case Wait:
+      // Late replies of a previous server are dropped by receive()
+      if (receive() || timeout)
+        nextServer();
+      break;
+    }
   }
+
+  State getState() { return _state; }
+  uint32_t getRetryDelay() { return _retryDelay; }
+  const NTPSample &getLastSample() { return _last; }
+};
+
+NTPClient _ntp;
+
+void getNTPtime()
+{
+  _ntp.request();
+}
+
+void handleNTPRequest()
+{
+  _ntp.handle();
 }
 
 
@@ -112,13 +541,26 @@ strDateTime convertDateTimeToUptime(const strDateTime &d)
   return dt;
 }
 
+// Days since 1970-01-01 to a civil date in constant time, without walking the years
+// (H. Hinnant, chrono-Compatible Low-Level Date Algorithms)
+void civilFromDays(uint32_t days, int &year, byte &month, byte &day)
+{
+  uint32_t z = days + 719468;                                            // days since 0000-03-01
+  uint32_t era = z / 146097;
+  uint32_t doe = z - era * 146097;                                       // day of era [0:146096]
+  uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;  // year of era [0:399]
+  uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);                // day of year from March 1st [0:365]
+  uint32_t mp = (5 * doy + 2) / 153;                                     // month from March [0:11]
+
+  day = doy - (153 * mp + 2) / 5 + 1;
+  month = mp < 10 ? mp + 3 : mp - 9;
+  year = era * 400 + yoe + (month <= 2);
+}
+
 strDateTime convertUnixTimeStamp(unsigned long tempTimeStamp)
 {
   strDateTime _tempDateTime;
-  uint8_t year;
-  uint8_t month, monthLength;
   uint32_t time;
-  unsigned long days;
 
   time = (uint32_t)tempTimeStamp;
   _tempDateTime.second = time % 60;
@@ -129,70 +571,316 @@ strDateTime convertUnixTimeStamp(unsigned long tempTimeStamp)
   time /= 24; // now it is days
   _tempDateTime.wday = ((time + 4) % 7) + 1;  // Sunday is day 1
 
-  year = 0;
-  days = 0;
-  while ((unsigned)(days += (LEAP_YEAR(year) ? 366 : 365)) <= time) {
-    year++;
-  }
-  _tempDateTime.year = year; // year is offset from 1970
-
-  days -= LEAP_YEAR(year) ? 366 : 365;
-  time  -= days; // now it is days in this year, starting at 0
-
-  days = 0;
-  month = 0;
-  monthLength = 0;
-  for (month = 0; month < 12; month++) {
-    if (month == 1) { // february
-      if (LEAP_YEAR(year)) {
-        monthLength = 29;
-      } else {
-        monthLength = 28;
-      }
-    } else {
-      monthLength = _monthDays[month];
-    }
-
-    if (time >= monthLength) {
-      time -= monthLength;
-    } else {
-      break;
-    }
-  }
-  _tempDateTime.month = month + 1;  // jan is month 1
-  _tempDateTime.day = time + 1;     // day of month
-  _tempDateTime.year += 1970;
+  civilFromDays(time, _tempDateTime.year, _tempDateTime.month, _tempDateTime.day);
 
   return _tempDateTime;
 }
 
+byte monthLength(int year, byte month)
+{
+  if (month == 2)
+    return LEAP_YEAR(year - 1970) ? 29 : 28;
+
+  return _monthDays[month - 1];
+}
+
+// Advance a date by one second
+void tickDateTime(strDateTime &d)
+{
+  if (++d.second < 60) return;
+  d.second = 0;
+  if (++d.minute < 60) return;
+  d.minute = 0;
+  if (++d.hour < 24) return;
+  d.hour = 0;
+  d.wday = (d.wday % 7) + 1;
+  if (++d.day <= monthLength(d.year, d.month)) return;
+  d.day = 1;
+  if (++d.month <= 12) return;
+  d.month = 1;
+  d.year++;
+}
+
 
 //
-// Summertime calculates the daylight saving time for middle Europe. Input: Unixtime in UTC
+// Time zone rules in the POSIX TZ format, e.g. "CET-1CEST,M3.5.0,M10.5.0/3".
+// The daylight saving changes are computed once a year, converting a time
+// stamp is then a compare against the cached instants.
 //
-boolean summerTime(unsigned long timeStamp) {
-  strDateTime  _tempDateTime = convertUnixTimeStamp(timeStamp);
-  // printTime("Innerhalb ", _tempDateTime);
+#define TZNAMEMAX 8
+#define TZSTRINGMAX 63
 
-  if ((_tempDateTime.month < 3) || (_tempDateTime.month > 10)) return false; // keine Sommerzeit in Jan, Feb, Nov, Dez
-  if ((_tempDateTime.month > 3) && (_tempDateTime.month < 10)) return true; // Sommerzeit in Apr, Mai, Jun, Jul, Aug, Sep
-  if (((_tempDateTime.month == 3) && ((_tempDateTime.hour + 24 * _tempDateTime.day) >= (3 +  24 * (31 - (5 * _tempDateTime.year / 4 + 4) % 7)))) || ((_tempDateTime.month == 10) && ((_tempDateTime.hour + 24 * _tempDateTime.day) < (3 +  24 * (31 - (5 * _tempDateTime.year / 4 + 1) % 7)))))
-    return true;
-  else
-    return false;
+// Civil date to days since 1970-01-01, from 1970 on
+uint32_t daysFromCivil(int year, byte month, byte day)
+{
+  uint32_t y = year - (month <= 2);
+  uint32_t era = y / 400;
+  uint32_t yoe = y - era * 400;                                          // year of era [0:399]
+  uint32_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;  // day of year from March 1st [0:365]
+  uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;                  // day of era [0:146096]
+
+  return era * 146097 + doe - 719468;
 }
 
-unsigned long adjustTimeZone(unsigned long timeStamp, int timeZone, bool isDayLightSavingSaving) {
-  timeStamp += timeZone * 360; // adjust timezone
-  if (isDayLightSavingSaving && summerTime(timeStamp)) timeStamp += 3600; // Sommerzeit beachten
-  return timeStamp;
+struct TimeZoneRule
+{
+  char type;     // 'J' : day [1:365] without February 29, 'D' : day [0:365], 'M' : month.week.weekday
+  byte month;    // [1:12]
+  byte week;     // [1:5], 5 is the last one of the month
+  byte wday;     // [0:6], Sunday is 0
+  int day;
+  long time;     // Local time of the change, in seconds
+
+  // First day of the rule in a year, in days since 1970-01-01
+  uint32_t days(int year) const
+  {
+    if (type == 'J')
+      return daysFromCivil(year, 1, 1) + day - 1 + ((day >= 60) && LEAP_YEAR(year - 1970));
+    if (type == 'D')
+      return daysFromCivil(year, 1, 1) + day;
+
+    uint32_t first = daysFromCivil(year, month, 1);
+    uint32_t d = first + ((wday + 7 - ((first + 4) % 7)) % 7) + (week - 1) * 7;
+    if (d >= first + monthLength(year, month))
+      d -= 7;
+    return d;
+  }
+};
+
+class TimeZone
+{
+protected:
+  char _stdName[TZNAMEMAX + 1];
+  char _dstName[TZNAMEMAX + 1];
+  long _stdOffset;               // Seconds east of UTC
+  long _dstOffset;
+  bool _hasDst;
+  TimeZoneRule _dstStart;
+  TimeZoneRule _dstEnd;
+
+  // Cache of the year of the last conversion, in UTC
+  uint32_t _yearBegin;
+  uint32_t _yearEnd;
+  int64_t _dstBegin;
+  int64_t _dstFinish;
+
+  static bool parseName(const char *&p, char *name)
+  {
+    int n = 0;
+
+    if (*p == '<') {
+      for (p++; *p && *p != '>'; p++)
+        if (n < TZNAMEMAX) name[n++] = *p;
+      if (*p++ != '>')
+        return false;
+    }
+    else
+      for (; isalpha(*p); p++)
+        if (n < TZNAMEMAX) name[n++] = *p;
+
+    name[n] = 0;
+    return n >= 3;
+  }
+
+  // [+|-]hh[:mm[:ss]] to seconds
+  static bool parseTime(const char *&p, long &seconds)
+  {
+    long sign = 1;
+
+    if (*p == '+' || *p == '-')
+      sign = (*p++ == '-') ? -1 : 1;
+    if (!isdigit(*p))
+      return false;
+
+    long v[3] = { 0, 0, 0 };
+    for (int i = 0; i < 3; i++) {
+      while (isdigit(*p))
+        v[i] = v[i] * 10 + (*p++ - '0');
+      if (i == 2 || *p != ':' || !isdigit(p[1]))
+        break;
+      p++;
+    }
+
+    seconds = sign * (v[0] * 3600 + v[1] * 60 + v[2]);
+    return v[0] <= 167 && v[1] < 60 && v[2] < 60;
+  }
+
+  static bool parseNumber(const char *&p, int &v, int min, int max)
+  {
+    if (!isdigit(*p))
+      return false;
+
+    v = 0;
+    while (isdigit(*p))
+      v = v * 10 + (*p++ - '0');
+    return v >= min && v <= max;
+  }
+
+  // ,Jn[/time] or ,n[/time] or ,Mm.w.d[/time]
+  static bool parseRule(const char *&p, TimeZoneRule &rule)
+  {
+    int m, w, d;
+
+    if (*p++ != ',')
+      return false;
+
+    rule.time = 2 * 3600;
+    if (*p == 'M') {
+      p++;
+      if (!parseNumber(p, m, 1, 12) || *p++ != '.' || !parseNumber(p, w, 1, 5) || *p++ != '.' || !parseNumber(p, d, 0, 6))
+        return false;
+      rule.type = 'M';
+      rule.month = m;
+      rule.week = w;
+      rule.wday = d;
+    }
+    else if (*p == 'J') {
+      p++;
+      if (!parseNumber(p, rule.day, 1, 365))
+        return false;
+      rule.type = 'J';
+    }
+    else {
+      if (!parseNumber(p, rule.day, 0, 365))
+        return false;
+      rule.type = 'D';
+    }
+
+    if (*p == '/') {
+      p++;
+      return parseTime(p, rule.time);
+    }
+    return true;
+  }
+
+  // Daylight saving instants of the year of a time stamp
+  void cacheYear(uint32_t utc)
+  {
+    int year;
+    byte month, day;
+
+    civilFromDays(utc / 86400, year, month, day);
+
+    uint64_t end = (uint64_t)daysFromCivil(year + 1, 1, 1) * 86400;
+    _yearBegin = daysFromCivil(year, 1, 1) * 86400;
+    _yearEnd = end > 0xFFFFFFFFULL ? 0xFFFFFFFFUL : (uint32_t)end;
+
+    // Rules are in local time, standard time before the start and daylight saving time before the end
+    _dstBegin = (int64_t)_dstStart.days(year) * 86400 + _dstStart.time - _stdOffset;
+    _dstFinish = (int64_t)_dstEnd.days(year) * 86400 + _dstEnd.time - _dstOffset;
+  }
+
+public:
+  TimeZone()
+  {
+    setOffset(0, false);
+  }
+
+  // POSIX TZ string, false when invalid and the rules are left unchanged
+  bool begin(const char *tz)
+  {
+    TimeZone z;
+    const char *p = tz;
+
+    if (!parseName(p, z._stdName) || !parseTime(p, z._stdOffset))
+      return false;
+    z._stdOffset = -z._stdOffset; // POSIX offsets are west of UTC
+
+    z._hasDst = *p != 0;
+    if (z._hasDst) {
+      if (!parseName(p, z._dstName))
+        return false;
+
+      z._dstOffset = z._stdOffset + 3600;
+      if (*p && *p != ',') {
+        if (!parseTime(p, z._dstOffset))
+          return false;
+        z._dstOffset = -z._dstOffset;
+      }
+
+      // Without rules, the US ones like the C library
+      if (!*p) {
+        const char *us = ",M3.2.0,M11.1.0";
+        parseRule(us, z._dstStart);
+        parseRule(us, z._dstEnd);
+      }
+      else if (!parseRule(p, z._dstStart) || !parseRule(p, z._dstEnd) || *p)
+        return false;
+    }
+
+    *this = z;
+    return true;
+  }
+
+  // Fixed offset, with the European daylight saving rule (last Sundays of March and October at 01:00 UTC)
+  void setOffset(long offset, bool europeanDst)
+  {
+    strcpy(_stdName, "STD");
+    strcpy(_dstName, "DST");
+    _stdOffset = offset;
+    _dstOffset = offset + 3600;
+    _hasDst = europeanDst;
+
+    const char *eu = ",M3.5.0,M10.5.0";
+    parseRule(eu, _dstStart);
+    parseRule(eu, _dstEnd);
+    _dstStart.time = 3600 + _stdOffset;
+    _dstEnd.time = 3600 + _dstOffset;
+
+    _yearBegin = _yearEnd = 0;
+  }
+
+  bool isDst(uint32_t utc)
+  {
+    if (!_hasDst)
+      return false;
+
+    if (utc < _yearBegin || utc >= _yearEnd)
+      cacheYear(utc);
+
+    // Southern hemisphere : daylight saving time over the new year
+    if (_dstBegin < _dstFinish)
+      return (utc >= _dstBegin) && (utc < _dstFinish);
+    return (utc >= _dstBegin) || (utc < _dstFinish);
+  }
+
+  // Seconds to add to UTC
+  long getOffset(uint32_t utc)
+  {
+    return isDst(utc) ? _dstOffset : _stdOffset;
+  }
+
+  uint32_t toLocal(uint32_t utc)
+  {
+    return utc + getOffset(utc);
+  }
+
+  const char *getName(uint32_t utc)
+  {
+    return isDst(utc) ? _dstName : _stdName;
+  }
+};
+
+TimeZone _timeZone;
+
+// TZ string of the configuration, or the time zone and daylight saving fields without it
+void applyTimeZone()
+{
+  if (_config.tz.length() && _timeZone.begin(_config.tz.c_str()))
+    return;
+
+  if (_config.tz.length())
+    Serial.println("Invalid TZ : " + _config.tz);
+
+  _timeZone.setOffset(_config.timeZone * 360, _config.isDayLightSaving);
 }
 
 String printDateTime(const strDateTime &d)
 {
   //return String(d.day) + String("/") + String(d.month) + String("/") + String(d.year) + String(" ") + String(d.hour) + String(":") + String(d.minute) + String(":") + String(d.second);
 
-  char datestring[20];
+  // Room for any year, not only 4 digits
+  char datestring[32];
 
   snprintf_P(datestring,
     countof(datestring),
@@ -207,7 +895,7 @@ String printDateTime(const strDateTime &d)
   return datestring;
 }
 
-String printDateTime(const RtcDateTime& dt)
+strDateTime convertRtcDateTime(const RtcDateTime& dt)
 {
   strDateTime d;
 
@@ -218,52 +906,52 @@ String printDateTime(const RtcDateTime& dt)
   d.minute = dt.Minute();
   d.second = dt.Second();
 
-  return printDateTime(d);
+  return d;
 }
 
-
-void handleTimeFromRTC()
+String printDateTime(const RtcDateTime& dt)
 {
-  static uint64_t p = 1;
+  return printDateTime(convertRtcDateTime(dt));
+}
 
-  uint64_t v = millis64() / (1000 * 60 * 60); // Resync time from RTC every 1 hour
 
-  if (v != p)
+// Resync time from RTC, every hour from the scheduler
+void handleTimeFromRTC()
+{
+  if (RTC.GetIsRunning())
   {
-    if (RTC.GetIsRunning())
-    {
-      unsigned long t = (unsigned long)RTC.GetDateTime().Epoch32Time();
-      Serial.println("RTC Sync Dt : " + String((int)(t - _timestamp)) + "s");
-      _timestamp = t;
-    }
-    else
-      Serial.println("RTC not working :(");
-
-    p = v;
+    unsigned long t = (unsigned long)RTC.GetDateTime().Epoch32Time();
+    Serial.println("RTC Sync Dt : " + String((int)(t - _clock.nowSeconds())) + "s");
+    _clock.rtcSample(t);
   }
+  else
+    Serial.println("RTC not working :(");
 }
 
 void updateTime()
 {
+  unsigned long t = _timeZone.toLocal(_timestamp);
+
+  // One second later : tick the date, full conversion on jumps only
+  if (_dateTime.year && (t == _localTimestamp + 1))
+    tickDateTime(_dateTime);
+  else if (!_dateTime.year || (t != _localTimestamp))
+    _dateTime = convertUnixTimeStamp(t);  //  convert to DateTime format
 
-  unsigned long t = adjustTimeZone(_timestamp, _config.timeZone, _config.isDayLightSaving);
-  _dateTime = convertUnixTimeStamp(t);  //  convert to DateTime format
+  _localTimestamp = t;
 
   //Serial.print("TS:" + String(_timestamp));
   //Serial.println(" Date:" + printDate());
 }
 
+// The second changes with the clock, within a loop pass
 void handleISRsecondTick()
 {
-  static uint64_t s = millis64() / 1000;
-  static uint64_t pe = 0;
-
-  uint64_t c = millis64() / 1000;
+  unsigned long t = _clock.nowSeconds();
 
-  while (pe < c - s)
+  if (t != _timestamp)
   {
-    _timestamp++;
+    _timestamp = t;
     updateTime();
-    pe++;
   }
 }
@@ -25,6 +25,14 @@ const char PAGE_general[] PROGMEM = R"=====(
 <select id="ledconfig" name="ledconfig" >
 </select>
 </td></tr>
+<tr><td align="right">Layout :</td><td>
+<select id="layout" name="layout" onchange="updatelayout()" >
+</select>
+</td></tr>
+<tr><td align="right">Led output :</td><td>
+<select id="ledoutput" name="ledoutput" onchange="updateledoutput()" >
+</select>
+</td></tr>
 <tr><td align="right">Color :</td><td><input class="jscolor" onchange="updatecolor(this.jscolor)" value="" id="color" name="color" ></td></tr>
 <tr><td align="right">Color random :</td><td>
 <select id="colorrandom" name="colorrandom" onchange="updatecolorrandom()" >
@@ -43,6 +51,11 @@ const char PAGE_general[] PROGMEM = R"=====(
 </select>
 </td></tr>
 
+<tr><td align="right">Transition :</td><td>
+<select id="transition" name="transition" onchange="updatetransition()" >
+</select>
+</td></tr>
+
 <tr><td colspan="2" align="center"><hr></td></tr>
 
 <tr><td colspan="2" align="center"><input type="submit" style="width:150px" class="btn btn--m btn--blue" value="Save"></td></tr>
@@ -65,6 +78,14 @@ function updatebrightnessnight() {
   setValues("/admin/led?brightnessnight=" + document.getElementById("brightnessnight").value);
 }
 
+function updatelayout() {
+  setValues("/admin/led?layout=" + document.getElementById("layout").value);
+}
+
+function updateledoutput() {
+  setValues("/admin/led?ledoutput=" + document.getElementById("ledoutput").value);
+}
+
 function updatecolor(picker) {
   setValues("/admin/led?color=" + picker);
 }
@@ -81,6 +102,10 @@ function updateanimation() {
   setValues("/admin/led?animation=" + document.getElementById("animation").value);
 }
 
+function updatetransition() {
+  setValues("/admin/led?transition=" + document.getElementById("transition").value);
+}
+
 function validatebrightnessauto() {
   document.getElementById("brightness").disabled = document.getElementById('brightnessauto').checked;
   document.getElementById("brightnessday").disabled = !document.getElementById('brightnessauto').checked;
@@ -116,10 +141,16 @@ window.onload = function ()
 		load("microajax.js","js", function() 
 		{
         setValues("/admin/generalledconfigvalues", function() {
-          setValues("/admin/generalmodesvalues", function() {
-            setValues("/admin/generalanimationsvalues", function() {
-              setValues("/admin/generalfieldsvalues", function() {
-                validatebrightnessauto();
+          setValues("/admin/generallayoutvalues", function() {
+            setValues("/admin/generalmodesvalues", function() {
+              setValues("/admin/generalanimationsvalues", function() {
+                setValues("/admin/generaloutputvalues", function() {
+                  setValues("/admin/generaltransitionvalues", function() {
+                    setValues("/admin/generalfieldsvalues", function() {
+                      validatebrightnessauto();
+                    });
+                  });
+                });
               });
             });
           });
@@ -158,6 +189,9 @@ void send_general_html()
       if (_server.argName(i) == "animation") _config.animation = _server.arg(i).toInt();
       if (_server.argName(i) == "colorrandom") _config.colorRandom = _server.arg(i).toInt();
       if (_server.argName(i) == "ledconfig") _config.ledConfig = _server.arg(i).toInt();
+      if (_server.argName(i) == "layout") _config.layout = _server.arg(i).toInt();
+      if (_server.argName(i) == "ledoutput") _config.ledOutput = _server.arg(i).toInt();
+      if (_server.argName(i) == "transition") _config.transition = _server.arg(i).toInt();
       if (_server.argName(i) == "brightnesssensibility") _config.luxSensitivity = _server.arg(i).toInt();
     }
 
@@ -165,6 +199,7 @@ void send_general_html()
 
     QTLed.begin();
 
+    QTLed.setOutputMode(_config.ledOutput);
     QTLed.setAutomaticBrightness(_config.brightnessAuto);
     if (!_config.brightnessAuto)
       QTLed.setBrightness(_config.brightness);
@@ -174,6 +209,8 @@ void send_general_html()
 
     QTLed.setMode(_config.mode);
     QTLed.setAnimation(_config.animation);
+    QTLed.setTransition(_config.transition);
+    QTLed.setLayout(_config.layout);
 
     //ESP.restart();
 	}
@@ -184,53 +221,70 @@ void send_general_html()
 
 void send_general_configuration_values_html()
 {
-	String values = "";
-  values += "brightnessauto|" + (String)(_config.brightnessAuto ? "checked" : "") + "|chk\n";
-  values += "brightness|" + (String)_config.brightness + "|input\n";
-  values += "brightnessday|" + (String)_config.brightnessAutoMinDay + "|input\n";
-  values += "brightnessnight|" + (String)_config.brightnessAutoMinNight + "|input\n";
-  values += "color|" + dec2hex2(_config.color[0]) + dec2hex2(_config.color[1]) + dec2hex2(_config.color[2]) + "|jscolor\n";
-  values += "mode|" + (String)_config.mode + "|input\n";
-  values += "animation|" + (String)_config.animation + "|input\n";
-  values += "colorrandom|" + (String)_config.colorRandom + "|input\n";
-  values += "ledconfig|" + (String)_config.ledConfig + "|input\n";
-  values += "brightnesssensibility|" + (String)_config.luxSensitivity + "|input\n";
-
-	_server.send(200, "text/plain", values);
+  ResponseWriter w(_server);
+
+  w.field("brightnessauto", _config.brightnessAuto ? "checked" : "", "chk");
+  w.field("brightness", _config.brightness, "input");
+  w.field("brightnessday", _config.brightnessAutoMinDay, "input");
+  w.field("brightnessnight", _config.brightnessAutoMinNight, "input");
+  w.write("color|").writeHex2(_config.color[0]).writeHex2(_config.color[1]).writeHex2(_config.color[2]).write("|jscolor\n");
+  w.field("mode", _config.mode, "input");
+  w.field("animation", _config.animation, "input");
+  w.field("colorrandom", _config.colorRandom, "input");
+  w.field("ledconfig", _config.ledConfig, "input");
+  w.field("layout", _config.layout, "input");
+  w.field("ledoutput", _config.ledOutput, "input");
+  w.field("transition", _config.transition, "input");
+  w.field("brightnesssensibility", _config.luxSensitivity, "input");
 	//Serial.println(__FUNCTION__); 
 }
 
 void send_general_ledconfig_values_html()
 {
-  cl_Lst<LedConfiguration *> *pl = QTLed.getLedConfigurationList();
+  LedConfigurationList *pl = QTLed.getLedConfigurationList();
 
-  String values = "";
+  ResponseWriter w(_server);
   for (int i = 0; i < pl->size(); i++)
-    values += "ledconfig|" + (*pl)[i]->getName() + "|select\n";
+    w.field("ledconfig", FPSTR((*pl)[i]->getName()), "select");
+}
 
-  _server.send(200, "text/plain", values);
+void send_general_layout_values_html()
+{
+  ResponseWriter w(_server);
+  for (int i = 0; i < _textTimeLayouts.size(); i++)
+    w.field("layout", _textTimeLayouts.getName(i), "select");
 }
 
 void send_general_modes_values_html()
 {
-  cl_Lst<LedStripMode *> *pl = QTLed.getModesList();
+  LedStripModeList *pl = QTLed.getModesList();
 
-  String values = "";
+  ResponseWriter w(_server);
   for (int i = 0; i < pl->size(); i++)
-    values += "mode|" + (*pl)[i]->getName() + "|select\n";
-
-  _server.send(200, "text/plain", values);
+    w.field("mode", FPSTR((*pl)[i]->getName()), "select");
 }
 
 void send_general_animations_values_html()
 {
-  cl_Lst<LedStripAnimation *> *pl = QTLed.getAnimationsList();
+  LedStripAnimationList *pl = QTLed.getAnimationsList();
 
-  String values = "";
+  ResponseWriter w(_server);
   for (int i = 0; i < pl->size(); i++)
-    values += "animation|" + (*pl)[i]->getName() + "|select\n";
+    w.field("animation", FPSTR((*pl)[i]->getName()), "select");
+}
 
-  _server.send(200, "text/plain", values);
+void send_general_output_values_html()
+{
+  ResponseWriter w(_server);
+  for (int i = 0; i < NLEDOUTPUTMODES; i++)
+    w.field("ledoutput", FPSTR(getLedOutputName(i)), "select");
+}
+
+void send_general_transition_values_html()
+{
+  ResponseWriter w(_server);
+  for (int i = 0; i < NTRANSITIONS; i++)
+    w.field("transition", FPSTR(getTransitionName(i)), "select");
 }
 
 void send_general_led()
@@ -281,11 +335,33 @@ void send_general_led()
       {
         QTLed.setColorRandom((RandomColorMode)_server.arg(i).toInt());
       }
+      if (_server.argName(i) == "transition")
+      {
+        QTLed.setTransition(_server.arg(i).toInt());
+      }
+
+      if (_server.argName(i) == "ledoutput")
+      {
+        QTLed.setOutputMode(_server.arg(i).toInt());
+      }
+
+      if (_server.argName(i) == "layout")
+      {
+        QTLed.setLayout(_server.arg(i).toInt());
+      }
+
+      if (_server.argName(i) == "text")
+      {
+        QTLed.spellText(_server.arg(i));
+      }
+
       if (_server.argName(i) == "brightnesssensibility")
       {
         _config.luxSensitivity = _server.arg(i).toInt();
       }
     }
   }
-  _server.send(200, "text/plain", "OK");
+
+  ResponseWriter w(_server);
+  w.write("OK");
 }
@@ -16,6 +16,7 @@ const char PAGE_information[] PROGMEM = R"=====(
 
 <tr><td align="right">Date :</td><td><span id="x_date"></span></td></tr>
 <tr><td align="right">Uptime :</td><td><span id="x_boot"></span></td></tr>
+<tr><td align="right">Clock :</td><td><span id="x_clock"></span></td></tr>
 <tr><td align="right">Build Date :</td><td><span id="x_version"></span></td></tr>
 
 <tr><td colspan="2" align="center"><hr></td></tr>
@@ -69,30 +70,86 @@ function load(e,t,n){if("js"==t){var a=document.createElement("script");a.src=e,
 
 void send_information_configuration_values_html ()
 {
-  String values ="";
-
-  values += "x_ssid|" + (String)WiFi.SSID() + "|div\n";
-  values += "x_rssi|" + (String)GetRSSIinPercent(WiFi.RSSI()) + "|div\n";
-  values += "x_ip|" +  (String) WiFi.localIP()[0] + "." +  (String) WiFi.localIP()[1] + "." +  (String) WiFi.localIP()[2] + "." + (String) WiFi.localIP()[3] +  "|div\n";
-  values += "x_gateway|" +  (String) WiFi.gatewayIP()[0] + "." +  (String) WiFi.gatewayIP()[1] + "." +  (String) WiFi.gatewayIP()[2] + "." + (String) WiFi.gatewayIP()[3] +  "|div\n";
-  values += "x_netmask|" + (String)WiFi.subnetMask()[0] + "." + (String)WiFi.subnetMask()[1] + "." + (String)WiFi.subnetMask()[2] + "." + (String)WiFi.subnetMask()[3] + "|div\n";
-  values += "x_dns|" + (String)WiFi.dnsIP()[0] + "." + (String)WiFi.dnsIP()[1] + "." + (String)WiFi.dnsIP()[2] + "." + (String)WiFi.dnsIP()[3] + "|div\n";
-  values += "x_mac|" + GetMacAddress() + "|div\n";
-  values += "x_version|" + printDateTime(RtcDateTime(__DATE__, __TIME__)) + "|div\n";
-  values += "x_boot|" + printDateTime(convertDateTimeToUptime(convertUnixTimeStamp(millis64() / 1000))) + "|div\n";
-  values += "x_date|" + printDateTime(_dateTime) + "|div\n";
-  values += "x_als|" + String(getAvgLux()) + "|div\n";
-  values += "x_temp|" + (RTC.GetIsRunning() ? String(RTC.GetTemperature().AsFloatDegC()) : String("N/A")) + "|div\n";
-  values += "x_brightness|" + String((int)QTLed.getBrightness()) + "|div\n";
-
-  _server.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-  _server.sendHeader("Pragma", "no-cache");
-  _server.sendHeader("Expires", "-1");
-
-  _server.send ( 200, "text/plain", values);
+  ResponseWriter w(_server, true);
+  uint8_t mac[6];
+
+  w.field("x_ssid", WiFi.SSID(), "div");
+  w.field("x_rssi", GetRSSIinPercent(WiFi.RSSI()), "div");
+  w.fieldIP("x_ip", WiFi.localIP(), "div");
+  w.fieldIP("x_gateway", WiFi.gatewayIP(), "div");
+  w.fieldIP("x_netmask", WiFi.subnetMask(), "div");
+  w.fieldIP("x_dns", WiFi.dnsIP(), "div");
+  w.write("x_mac|").writeMac(WiFi.macAddress(mac)).write("|div\n");
+  w.write("x_version|").writeDateTime(convertRtcDateTime(RtcDateTime(__DATE__, __TIME__))).write("|div\n");
+  w.write("x_boot|").writeDateTime(convertDateTimeToUptime(convertUnixTimeStamp(millis64() / 1000))).write("|div\n");
+  w.write("x_date|").writeDateTime(_dateTime).write(' ').write(_timeZone.getName(_timestamp)).write("|div\n");
+
+  w.write("x_clock|").write(_clock.getSourceName()).write(", offset ").write((long)_clock.getOffset()).write(" ms, drift ");
+  w.write(_clock.getDrift() / 1000.0f, 1).write(" ppm, RTC drift ");
+  if (_clock.getRtcDrift())
+    w.write(_clock.getRtcDrift() / 1000.0f, 1).write(" ppm");
+  else
+    w.write("N/A");
+  w.write("|div\n");
+
+  w.field("x_als", getAvgLux(), "div");
+  if (_sensorTemperature.getValue().isValid())
+    w.field("x_temp", _sensorTemperature.getValue().value, "div");
+  else
+    w.field("x_temp", "N/A", "div");
+  w.field("x_brightness", QTLed.getBrightness(), "div");
 
   //Serial.println(__FUNCTION__);
 }
 
 
+//
+// RENDER TIMINGS
+//
+
+// "name|count min mean max|histogram" of a stage, the name is written before
+void writePerfStage(ResponseWriter &w, PerfStage &p)
+{
+  char summary[PERFSUMMARYMAX];
+
+  w.write('|').write(p.summary(summary)).write('|');
+  for (int i = 0; i < PERFBUCKETS; i++) {
+    if (i) w.write(' ');
+    w.write((unsigned long)p.getBucket(i));
+  }
+  w.write('\n');
+}
+
+// One line by stage: "name|count min mean max (us)|histogram (log2 cycles buckets)"
+// then the same for each scheduler task and its lateness, and the totals of
+// the responses of the values pages
+// Add "?reset" to restart the measures
+void send_perf_values_html()
+{
+  if (_server.hasArg("reset")) {
+    perfReset();
+    _scheduler.reset();
+  }
+
+  ResponseWriter w(_server);
+  w.write("mode|").write(FPSTR((*QTLed.getModesList())[QTLed.getModeIndex()]->getName())).write('\n');
+  w.write("animation|").write(FPSTR((*QTLed.getAnimationsList())[QTLed.getAnimationIndex()]->getName())).write('\n');
+  w.write("ledconfig|").write(FPSTR((*QTLed.getLedConfigurationList())[QTLed.getLedConfigurationIndex()]->getName())).write('\n');
+
+  for (unsigned int i = 0; i < NPERFSTAGES; i++)
+    writePerfStage(w.write(_perfStages[i]->getName()), *_perfStages[i]);
+
+  TaskList &tasks = _scheduler.getTasks();
+  for (int i = 0; i < tasks.size(); i++) {
+    writePerfStage(w.write("task ").write(tasks[i]->getName()), tasks[i]->getRunStats());
+    writePerfStage(w.write("task ").write(tasks[i]->getName()).write("/late"), tasks[i]->getLateStats());
+  }
+  w.write("passes|").write(_scheduler.getBusyPasses()).write(" busy ").write(_scheduler.getIdlePasses()).write(" idle\n");
+
+  // "count bytes chunks|largest heap use of a response, free heap, largest free block (bytes)"
+  w.write("responses|").write(_responseStats.count).write(' ').write(_responseStats.bytes).write(' ').write(_responseStats.chunks);
+  w.write('|').write(_responseStats.heapUsedMax).write(' ').write(ESP.getFreeHeap()).write(' ').write((unsigned long)ESP.getMaxFreeBlockSize()).write('\n');
+}
+
+
 #endif
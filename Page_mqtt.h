@@ -108,45 +108,40 @@ void send_mqtt_configuration_html()
 
 void send_mqtt_configuration_values_html()
 {
-
-	String values ="";
-
-	values += "host|" + (String) _config.MQTTServer + "|input\n";
-	values += "port|" + String(_config.MQTTPort) + "|input\n";
-	values += "login|" +  (String) _config.MQTTLogin + "|input\n";
-	values += "password|" +  (String) _config.MQTTPassword + "|input\n";
-  values += "interval|" + String(_config.MQTTPubInterval) + "|input\n";
-
-
-  String sublist;
-  sublist += "\"" + mqttTopicSubLedColor.topic() + "\" : set display color. Value in hex. eg : #00FF00<br>";
-  sublist += "\"" + mqttTopicSubLedMode.topic() + "\" : set display mode. Value in dec. eg : 1<br>";
-  sublist += "\"" + mqttTopicSubLedAnim.topic() + "\" : set display animation. Value in dec. eg : 3<br>";
-  sublist += "<i>Empty payload returns current value. See publishing \"stat\" topics.</i><br>";
-
-  String publist;
-  publist += "\"" + mqttTopicPubLedColor.topic() + "\" : get display color. Value in hex. eg : #00FF00<br>";
-  publist += "\"" + mqttTopicPubLedMode.topic() + "\" : get display mode. Value in dec. eg : 1<br>";
-  publist += "\"" + mqttTopicPubLedAnim.topic() + "\" : get display animation. Value in dec. eg : 3<br>";
-  publist += "<br>";
-  publist += "\"" + mqttTopicPubTemp.topic() + "\" : get temperature. Value in degrees celius.<br>";
-  publist += "\"" + mqttTopicPubLight.topic() + "\" : get ambient light. Value in lumens.<br>";
-  publist += "\"" + mqttTopicPubRssi.topic() + "\" : get WiFi RSSI. Value in %.<br>";
-
-  values += "sublist|" + sublist + "|div\n";
-  values += "publist|" + publist + "|div\n";
-
-  _server.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-  _server.sendHeader("Pragma", "no-cache");
-  _server.sendHeader("Expires", "-1");
-
-	_server.send ( 200, "text/plain", values);
-	//Serial.println(__FUNCTION__); 
+  ResponseWriter w(_server, true);
+
+  w.field("host", _config.MQTTServer, "input");
+  w.field("port", _config.MQTTPort, "input");
+  w.field("login", _config.MQTTLogin, "input");
+  w.field("password", _config.MQTTPassword, "input");
+  w.field("interval", _config.MQTTPubInterval, "input");
+
+  w.write("sublist|");
+  w.write("\"").write(mqttTopicSubLedColor.topic()).write("\" : set display color. Value in hex. eg : #00FF00<br>");
+  w.write("\"").write(mqttTopicSubLedMode.topic()).write("\" : set display mode. Value in dec. eg : 1<br>");
+  w.write("\"").write(mqttTopicSubLedAnim.topic()).write("\" : set display animation. Value in dec. eg : 3<br>");
+  w.write("\"").write(mqttTopicSubLedOutput.topic()).write("\" : set led output. 0 direct, 1 gamma, 2 gamma + dithering. eg : 1<br>");
+  w.write("\"").write(mqttTopicSubLedText.topic()).write("\" : spell a text on the grid, up to 64 letters. Empty payload stops it. eg : HELLO<br>");
+  w.write("<i>Empty payload returns current value. See publishing \"stat\" topics.</i><br>");
+  w.write("|div\n");
+
+  w.write("publist|");
+  w.write("\"").write(mqttTopicPubLedColor.topic()).write("\" : get display color. Value in hex. eg : #00FF00<br>");
+  w.write("\"").write(mqttTopicPubLedMode.topic()).write("\" : get display mode. Value in dec. eg : 1<br>");
+  w.write("\"").write(mqttTopicPubLedAnim.topic()).write("\" : get display animation. Value in dec. eg : 3<br>");
+  w.write("\"").write(mqttTopicPubLedOutput.topic()).write("\" : get led output. Value in dec. eg : 1<br>");
+  w.write("<br>");
+  w.write("\"").write(mqttTopicPubTemp.topic()).write("\" : get temperature. Value in degrees celius.<br>");
+  w.write("\"").write(mqttTopicPubLight.topic()).write("\" : get ambient light. Value in lumens.<br>");
+  w.write("\"").write(mqttTopicPubRssi.topic()).write("\" : get WiFi RSSI. Value in %.<br>");
+  w.write("\"").write(mqttTopicPubPerf.topic()).write("\" : get timings, not retained. One line by render stage and task : name, count, min, mean and max in us. eg : refresh 500 40 52 130<br>");
+  w.write("|div\n");
+  //Serial.println(__FUNCTION__); 
 }
 
 void send_mqtt_connection_values_html()
 {
-  String s = "";
+  const char *s;
   switch (_mqtt.state())
   {
   case MQTT_CONNECTION_TIMEOUT: s = "MQTT_CONNECTION_TIMEOUT"; break;
@@ -162,13 +157,7 @@ void send_mqtt_connection_values_html()
   default: s = "MQTT_UNKNOW_ERROR"; break;
   }
 
-  String values = "";
-  values += "connectionstate|" + s + "|div\n";
-
-  _server.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-  _server.sendHeader("Pragma", "no-cache");
-  _server.sendHeader("Expires", "-1");
-
-  _server.send(200, "text/plain", values);
+  ResponseWriter w(_server, true);
+  w.field("connectionstate", s, "div");
   //Serial.println(__FUNCTION__); 
 }
\ No newline at end of file
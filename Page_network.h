@@ -154,36 +154,29 @@ void send_network_configuration_html()
 
 void send_network_configuration_values_html()
 {
-
-	String values ="";
-
-	values += "ssid|" + (String) _config.ssid + "|input\n";
-	values += "password|" +  (String) _config.password + "|input\n";
-	values += "ip_0|" +  (String) _config.IP[0] + "|input\n";
-	values += "ip_1|" +  (String) _config.IP[1] + "|input\n";
-	values += "ip_2|" +  (String) _config.IP[2] + "|input\n";
-	values += "ip_3|" +  (String) _config.IP[3] + "|input\n";
-	values += "nm_0|" +  (String) _config.Netmask[0] + "|input\n";
-	values += "nm_1|" +  (String) _config.Netmask[1] + "|input\n";
-	values += "nm_2|" +  (String) _config.Netmask[2] + "|input\n";
-	values += "nm_3|" +  (String) _config.Netmask[3] + "|input\n";
-	values += "gw_0|" +  (String) _config.Gateway[0] + "|input\n";
-	values += "gw_1|" +  (String) _config.Gateway[1] + "|input\n";
-	values += "gw_2|" +  (String) _config.Gateway[2] + "|input\n";
-	values += "gw_3|" +  (String) _config.Gateway[3] + "|input\n";
-  values += "dn_0|" + (String)_config.DNS[0] + "|input\n";
-  values += "dn_1|" + (String)_config.DNS[1] + "|input\n";
-  values += "dn_2|" + (String)_config.DNS[2] + "|input\n";
-  values += "dn_3|" + (String)_config.DNS[3] + "|input\n";
-	values += "dhcp|" +  (String) (_config.dhcp ? "checked" : "") + "|chk\n";
-  values += "devicename|" + (String)_config.DeviceName + "|input\n";
-
-  _server.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-  _server.sendHeader("Pragma", "no-cache");
-  _server.sendHeader("Expires", "-1");
-
-	_server.send ( 200, "text/plain", values);
-	//Serial.println(__FUNCTION__); 
+  ResponseWriter w(_server, true);
+
+  w.field("ssid", _config.ssid, "input");
+  w.field("password", _config.password, "input");
+  w.field("ip_0", _config.IP[0], "input");
+  w.field("ip_1", _config.IP[1], "input");
+  w.field("ip_2", _config.IP[2], "input");
+  w.field("ip_3", _config.IP[3], "input");
+  w.field("nm_0", _config.Netmask[0], "input");
+  w.field("nm_1", _config.Netmask[1], "input");
+  w.field("nm_2", _config.Netmask[2], "input");
+  w.field("nm_3", _config.Netmask[3], "input");
+  w.field("gw_0", _config.Gateway[0], "input");
+  w.field("gw_1", _config.Gateway[1], "input");
+  w.field("gw_2", _config.Gateway[2], "input");
+  w.field("gw_3", _config.Gateway[3], "input");
+  w.field("dn_0", _config.DNS[0], "input");
+  w.field("dn_1", _config.DNS[1], "input");
+  w.field("dn_2", _config.DNS[2], "input");
+  w.field("dn_3", _config.DNS[3], "input");
+  w.field("dhcp", _config.dhcp ? "checked" : "", "chk");
+  w.field("devicename", _config.DeviceName, "input");
+  //Serial.println(__FUNCTION__); 
 }
 
 
@@ -193,9 +186,7 @@ void send_network_configuration_values_html()
 
 void send_network_connection_values_html()
 {
-
-	String state = "N/A";
-	String Networks = "";
+	const char *state = "N/A";
 	if (WiFi.status() == 0) state = "Idle";
 	else if (WiFi.status() == 1) state = "NO SSID AVAILBLE";
 	else if (WiFi.status() == 2) state = "SCAN COMPLETED";
@@ -204,37 +195,32 @@ void send_network_connection_values_html()
 	else if (WiFi.status() == 5) state = "CONNECTION LOST";
 	else if (WiFi.status() == 6) state = "DISCONNECTED";
 
+	int n = WiFi.scanNetworks();
 
+	// The network table is written row by row into the response
+	ResponseWriter w(_server, true);
 
-	 int n = WiFi.scanNetworks();
+	w.field("connectionstate", state, "div");
 
-	 if (n == 0)
-	 {
-		 Networks = "<font color='#FF0000'>No networks found!</font>";
-	 }
+	w.write("networks|");
+	if (n == 0)
+	{
+		w.write("<font color='#FF0000'>No networks found!</font>");
+	}
 	else
-    {
-	 
-		
-		Networks = "Found " +String(n) + " Networks<br>";
-		Networks += "<table border='0' cellspacing='0' cellpadding='3'>";
-		Networks += "<tr bgcolor='#DDDDDD' ><td><strong>Name</strong></td><td><strong>Quality</strong></td><td><strong>Enc</strong></td><tr>";
+	{
+		w.write("Found ").write(n).write(" Networks<br>");
+		w.write("<table border='0' cellspacing='0' cellpadding='3'>");
+		w.write("<tr bgcolor='#DDDDDD' ><td><strong>Name</strong></td><td><strong>Quality</strong></td><td><strong>Enc</strong></td><tr>");
 		for (int i = 0; i < n; ++i)
 		{
-      Networks += "<tr><td><a href='javascript:selssid(\"" + String(WiFi.SSID(i)) + "\"); void 0'>" + String(WiFi.SSID(i)) + "</a></td><td>" + String(GetRSSIinPercent(WiFi.RSSI(i))) + "%</td><td>" + String((WiFi.encryptionType(i) == ENC_TYPE_NONE) ? " " : "*") + "</td></tr>";
+			String ssid = WiFi.SSID(i);
+			w.write("<tr><td><a href='javascript:selssid(\"").write(ssid).write("\"); void 0'>").write(ssid).write("</a></td><td>");
+			w.write(GetRSSIinPercent(WiFi.RSSI(i))).write("%</td><td>").write((WiFi.encryptionType(i) == ENC_TYPE_NONE) ? " " : "*").write("</td></tr>");
 		}
-		Networks += "</table>";
+		w.write("</table>");
 	}
-   
-	String values ="";
-	values += "connectionstate|" + state + "|div\n";
-	values += "networks|" +  Networks + "|div\n";
-
-  _server.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-  _server.sendHeader("Pragma", "no-cache");
-  _server.sendHeader("Expires", "-1");
-
-	_server.send ( 200, "text/plain", values);
+	w.write("|div\n");
 	//Serial.println(__FUNCTION__); 
 }
 
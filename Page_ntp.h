@@ -6,7 +6,8 @@ const char PAGE_ntp[] PROGMEM = R"=====(
 <hr>
 <form action="" method="get">
 <table border="0"  cellspacing="0" cellpadding="3" >
-<tr><td align="right">NTP Server:</td><td><input type="text" id="ntpserver" name="ntpserver" maxlength="172" value=""></td></tr>
+<tr><td align="right">NTP Servers:</td><td><input type="text" id="ntpserver" name="ntpserver" maxlength="63" value=""></td></tr>
+<tr><td></td><td>Up to 3 servers separated by spaces</td></tr>
 <tr><td align="right">Update:</td><td><input type="text" id="update" name="update" size="3"maxlength="6" value=""> seconds (0=disable)</td></tr>
 <tr><td align="right">Timezone:</td><td>
 <select  id="tz" name="tz">
@@ -47,6 +48,8 @@ const char PAGE_ntp[] PROGMEM = R"=====(
 </select>
 </td></tr>
 <tr><td align="right">Daylight saving:</td><td><input type="checkbox" id="dst" name="dst"></td></tr>
+<tr><td align="right">TZ rules:</td><td><input type="text" id="tzrules" name="tzrules" maxlength="63" placeholder="CET-1CEST,M3.5.0,M10.5.0/3" value=""></td></tr>
+<tr><td></td><td>POSIX TZ string, replaces the time zone and daylight saving above</td></tr>
 <tr><td colspan="2" align="center"><input type="submit" style="width:150px" class="btn btn--m btn--blue" value="Save"></td></tr>
 </table>
 </form>
@@ -82,8 +85,10 @@ void send_NTP_configuration_html()
       if (_server.argName(i) == "update") _config.Update_Time_Via_NTP_Every =  _server.arg(i).toInt(); 
       if (_server.argName(i) == "tz") _config.timeZone =  _server.arg(i).toInt(); 
       if (_server.argName(i) == "dst") _config.isDayLightSaving = true; 
+      if (_server.argName(i) == "tzrules") _config.tz = _server.arg(i).substring(0, TZSTRINGMAX);
     }
     WriteConfig();
+    applyTimeZone();
     getNTPtime(); // Update NTP time
   }
   _server.send_P ( 200, "text/html", PAGE_ntp); 
@@ -95,17 +100,13 @@ void send_NTP_configuration_html()
 
 void send_ntp_configuration_values_html()
 {
-    
-  String values ="";
-  values += "ntpserver|" + (String) _config.ntpServerName + "|input\n";
-  values += "update|" +  (String) _config.Update_Time_Via_NTP_Every + "|input\n";
-  values += "tz|" +  (String) _config.timeZone + "|input\n";
-  values += "dst|" +  (String) (_config.isDayLightSaving ? "checked" : "") + "|chk\n";
+  ResponseWriter w(_server, true);
 
-  _server.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-  _server.sendHeader("Pragma", "no-cache");
-  _server.sendHeader("Expires", "-1");
-  _server.send ( 200, "text/plain", values);
+  w.field("ntpserver", _config.ntpServerName, "input");
+  w.field("update", _config.Update_Time_Via_NTP_Every, "input");
+  w.field("tz", _config.timeZone, "input");
+  w.field("dst", _config.isDayLightSaving ? "checked" : "", "chk");
+  w.field("tzrules", _config.tz, "input");
 
   //Serial.println(__FUNCTION__); 
 }
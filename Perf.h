@@ -0,0 +1,122 @@
+#ifndef PERF_H
+#define PERF_H
+
+// Histogram buckets: bucket 0 < 2^PERFBUCKETBASE cycles (2^PERFBUCKETBASEMICROS us),
+// then one bucket by power of 2
+#define PERFBUCKETS 12
+#define PERFBUCKETBASE 10
+#define PERFBUCKETBASEMICROS 4
+
+// Longest "count min mean max" summary
+#define PERFSUMMARYMAX 48
+
+enum PerfUnit
+{
+  PerfCycles = 0,   // CPU cycles, timed by start() and stop()
+  PerfMicros        // us given to add(), for delays longer than the cycle counter
+};
+
+// Timing of a render stage in CPU cycles
+class PerfStage
+{
+private:
+  const char *_name;
+  PerfUnit _unit;
+  uint32_t _start;
+  uint32_t _count;
+  uint32_t _min;
+  uint32_t _max;
+  uint64_t _total;
+  uint32_t _histogram[PERFBUCKETS];
+
+  uint32_t toMicros(uint32_t v)
+  {
+    return _unit == PerfCycles ? v / ESP.getCpuFreqMHz() : v;
+  }
+
+public:
+  PerfStage(const char *name, PerfUnit unit = PerfCycles)
+    : _name(name)
+    , _unit(unit)
+    , _start(0)
+  {
+    reset();
+  }
+
+  void reset()
+  {
+    _count = 0;
+    _min = 0xFFFFFFFF;
+    _max = 0;
+    _total = 0;
+    memset(_histogram, 0, sizeof(_histogram));
+  }
+
+  void start()
+  {
+    _start = ESP.getCycleCount();
+  }
+
+  void stop()
+  {
+    add(ESP.getCycleCount() - _start);
+  }
+
+  // In the unit of the stage
+  void add(uint32_t v)
+  {
+    _count++;
+    _total += v;
+    if (v < _min) _min = v;
+    if (v > _max) _max = v;
+
+    int b = v ? 32 - __builtin_clz(v) - (_unit == PerfCycles ? PERFBUCKETBASE : PERFBUCKETBASEMICROS) : 0;
+    if (b < 0) b = 0;
+    if (b > PERFBUCKETS - 1) b = PERFBUCKETS - 1;
+    _histogram[b]++;
+  }
+
+  const char *getName()
+  {
+    return _name;
+  }
+
+  // "count min mean max" in us, into a buffer of PERFSUMMARYMAX
+  const char *summary(char *s)
+  {
+    if (!_count)
+      strcpy(s, "0 0 0 0");
+    else
+      snprintf(s, PERFSUMMARYMAX, "%u %u %u %u", (unsigned int)_count, (unsigned int)toMicros(_min),
+               (unsigned int)toMicros(_total / _count), (unsigned int)toMicros(_max));
+    return s;
+  }
+
+  String summary()
+  {
+    char s[PERFSUMMARYMAX];
+    return summary(s);
+  }
+
+  // Number of samples in a bucket
+  uint32_t getBucket(int i)
+  {
+    return _histogram[i];
+  }
+};
+
+PerfStage _perfMode("mode");
+PerfStage _perfAnimation("animation");
+PerfStage _perfRefresh("refresh");
+PerfStage _perfShow("show");
+
+PerfStage *_perfStages[] = { &_perfMode, &_perfAnimation, &_perfRefresh, &_perfShow };
+#define NPERFSTAGES (sizeof(_perfStages) / sizeof(_perfStages[0]))
+
+void perfReset()
+{
+  for (unsigned int i = 0; i < NPERFSTAGES; i++)
+    _perfStages[i]->reset();
+}
+
+#endif
@@ -0,0 +1,234 @@
+#ifndef RESPONSEWRITER_H
+#define RESPONSEWRITER_H
+
+//
+// Chunked HTTP response formatted into a fixed buffer : numbers and addresses
+// are written in place, a chunk is sent each time the buffer is full.
+// Replaces the String concatenations of the /admin/* values pages.
+//
+
+#define RESPONSEBUFFER 256
+
+// Totals of the responses, and the largest heap use seen during one of them
+struct ResponseStats
+{
+  uint32_t count;
+  uint32_t bytes;
+  uint32_t chunks;
+  uint32_t heapUsedMax;
+};
+
+ResponseStats _responseStats = { 0, 0, 0, 0 };
+
+class ResponseWriter
+{
+private:
+  ESP8266WebServer &_server;
+  char _buffer[RESPONSEBUFFER];
+  int _length;
+  uint32_t _bytes;
+  bool _ended;
+  uint32_t _heapStart;
+  uint32_t _heapMin;
+
+  void heapSample()
+  {
+    uint32_t h = ESP.getFreeHeap();
+    if (h < _heapMin) _heapMin = h;
+  }
+
+  void flush()
+  {
+    if (!_length)
+      return;
+
+    heapSample();
+    // sendContent_P() frames the chunk on every core, it reads RAM as well
+    _server.sendContent_P(_buffer, _length);
+    _responseStats.chunks++;
+    _bytes += _length;
+    _length = 0;
+  }
+
+public:
+  // Status line and headers are sent at once, the body follows in chunks
+  ResponseWriter(ESP8266WebServer &server, bool noCache = false, const char *type = "text/plain")
+    : _server(server)
+    , _length(0)
+    , _bytes(0)
+    , _ended(false)
+  {
+    _heapStart = _heapMin = ESP.getFreeHeap();
+
+    if (noCache) {
+      _server.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
+      _server.sendHeader("Pragma", "no-cache");
+      _server.sendHeader("Expires", "-1");
+    }
+
+    _server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    _server.send(200, type, "");
+  }
+
+  ~ResponseWriter()
+  {
+    end();
+  }
+
+  // Last chunk, then the empty one closing the response
+  void end()
+  {
+    if (_ended)
+      return;
+
+    flush();
+    _server.sendContent_P(_buffer, 0);
+
+    _responseStats.count++;
+    _responseStats.bytes += _bytes;
+    if (_heapStart > _heapMin && _heapStart - _heapMin > _responseStats.heapUsedMax)
+      _responseStats.heapUsedMax = _heapStart - _heapMin;
+
+    _ended = true;
+  }
+
+  ResponseWriter &write(char c)
+  {
+    if (_length == RESPONSEBUFFER)
+      flush();
+    _buffer[_length++] = c;
+    return *this;
+  }
+
+  ResponseWriter &write(const char *s)
+  {
+    while (*s)
+      write(*s++);
+    return *this;
+  }
+
+  ResponseWriter &write(const __FlashStringHelper *s)
+  {
+    PGM_P p = reinterpret_cast<PGM_P>(s);
+    char c;
+    while ((c = pgm_read_byte(p++)))
+      write(c);
+    return *this;
+  }
+
+  ResponseWriter &write(const String &s)
+  {
+    return write(s.c_str());
+  }
+
+  // At least width digits, zero padded
+  ResponseWriter &write(unsigned long v, int width = 1)
+  {
+    char d[3 * sizeof(unsigned long)];
+    int n = 0;
+    do {
+      d[n++] = '0' + v % 10;
+      v /= 10;
+    } while (v);
+
+    for (; width > n; width--)
+      write('0');
+    while (n)
+      write(d[--n]);
+    return *this;
+  }
+
+  ResponseWriter &write(long v)
+  {
+    if (v < 0) {
+      write('-');
+      return write((unsigned long)(-(v + 1)) + 1);
+    }
+    return write((unsigned long)v);
+  }
+
+  ResponseWriter &write(int v) { return write((long)v); }
+  ResponseWriter &write(unsigned int v) { return write((unsigned long)v); }
+
+  // Fixed decimals, like String(float)
+  ResponseWriter &write(float v, int decimals = 2)
+  {
+    if (v < 0) {
+      write('-');
+      v = -v;
+    }
+
+    unsigned long scale = 1;
+    for (int i = 0; i < decimals; i++)
+      scale *= 10;
+
+    unsigned long f = (unsigned long)(v * scale + 0.5f);
+    write(f / scale);
+
+    if (decimals) {
+      write('.');
+      f %= scale;
+      for (unsigned long s = scale / 10; s; s /= 10) {
+        write((char)('0' + f / s));
+        f %= s;
+      }
+    }
+    return *this;
+  }
+
+  ResponseWriter &writeHex2(byte v)
+  {
+    const char *digits = "0123456789ABCDEF";
+    write(digits[v >> 4]);
+    return write(digits[v & 0x0F]);
+  }
+
+  // "dd/mm/yyyy hh:mm:ss", like printDateTime()
+  ResponseWriter &writeDateTime(const strDateTime &d)
+  {
+    write((unsigned long)d.day, 2).write('/').write((unsigned long)d.month, 2).write('/').write((unsigned long)d.year, 4);
+    write(' ');
+    return write((unsigned long)d.hour, 2).write(':').write((unsigned long)d.minute, 2).write(':').write((unsigned long)d.second, 2);
+  }
+
+  ResponseWriter &writeMac(const uint8_t *mac)
+  {
+    for (int i = 0; i < 6; i++) {
+      if (i) write(':');
+      writeHex2(mac[i]);
+    }
+    return *this;
+  }
+
+  ResponseWriter &writeIP(const IPAddress &ip)
+  {
+    for (int i = 0; i < 4; i++) {
+      if (i) write('.');
+      write((unsigned int)ip[i]);
+    }
+    return *this;
+  }
+
+  // One "id|value|type" line of the values pages
+  template <class T> ResponseWriter &field(const char *id, const T &value, const char *type)
+  {
+    write(id);
+    write('|');
+    write(value);
+    write('|');
+    write(type);
+    return write('\n');
+  }
+
+  ResponseWriter &fieldIP(const char *id, const IPAddress &ip, const char *type)
+  {
+    write(id);
+    write('|');
+    writeIP(ip);
+    write('|');
+    write(type);
+    return write('\n');
+  }
+};
+
+#endif
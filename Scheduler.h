@@ -0,0 +1,207 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+//
+// Cooperative scheduler: tasks wait in a timer wheel of 1ms slots and the
+// due ones run by priority. Between two tasks the wheel is checked again, so
+// a led frame due meanwhile runs before the remaining housekeeping.
+//
+
+#define SCHEDULERSLOTS 64          // 1ms slots, later deadlines wait for the wheel to come back
+#define SCHEDULERTASKSMAX 16
+
+// Returns the ms to the next run, 0 for the period of the task
+typedef uint32_t (*TaskCallback)();
+
+class Task
+{
+  friend class Scheduler;
+
+protected:
+  TaskCallback _callback;
+  uint32_t _period;       // ms
+  uint8_t _priority;      // 0 is the highest
+  uint64_t _deadline;     // us
+  Task *_next;            // next task of the same wheel slot
+  PerfStage _run;         // execution time
+  PerfStage _late;        // start time after the deadline, reported as name/late
+
+public:
+  Task(const char *name, TaskCallback callback, uint32_t period, uint8_t priority)
+    : _callback(callback)
+    , _period(period ? period : 1)
+    , _priority(priority)
+    , _deadline(0)
+    , _next(NULL)
+    , _run(name)
+    , _late(name, PerfMicros)
+  {
+  }
+
+  const char *getName() { return _run.getName(); }
+  uint8_t getPriority() { return _priority; }
+  PerfStage &getRunStats() { return _run; }
+  PerfStage &getLateStats() { return _late; }
+};
+
+typedef StaticVector<Task *, SCHEDULERTASKSMAX> TaskList;
+
+class Scheduler
+{
+protected:
+  Task *_slots[SCHEDULERSLOTS];
+  TaskList _tasks;
+  TaskList _ready;        // due tasks, by priority then deadline
+  uint64_t _tick;         // last ms visited in the wheel
+  uint32_t _idle;         // passes without anything to run
+  uint32_t _busy;
+
+  void insert(Task *t)
+  {
+    // Never in a slot already visited for this turn of the wheel
+    if (t->_deadline / 1000 <= _tick)
+      t->_deadline = (_tick + 1) * 1000;
+
+    Task **slot = &_slots[(t->_deadline / 1000) % SCHEDULERSLOTS];
+    t->_next = *slot;
+    *slot = t;
+  }
+
+  void ready(Task *t)
+  {
+    int i = _ready.push_back(t);
+
+    for (; i > 0; i--) {
+      Task *p = _ready[i - 1];
+      if (p->_priority < t->_priority || (p->_priority == t->_priority && p->_deadline <= t->_deadline))
+        break;
+      _ready[i] = p;
+      _ready[i - 1] = t;
+    }
+  }
+
+  // Move the tasks of the slots from the last visited ms up to now to the ready list
+  void collect(uint64_t now)
+  {
+    uint64_t tick = now / 1000;
+    uint64_t from = (tick - _tick > SCHEDULERSLOTS) ? tick - SCHEDULERSLOTS + 1 : _tick + 1;
+
+    for (uint64_t k = from; k <= tick; k++) {
+      Task **p = &_slots[k % SCHEDULERSLOTS];
+      while (*p) {
+        Task *t = *p;
+        if (t->_deadline / 1000 <= tick) {
+          *p = t->_next;
+          ready(t);
+        }
+        else
+          p = &t->_next;
+      }
+    }
+
+    _tick = tick;
+  }
+
+public:
+  Scheduler()
+    : _tick(0)
+    , _idle(0)
+    , _busy(0)
+  {
+    memset(_slots, 0, sizeof(_slots));
+  }
+
+  // The task runs after the delay (ms), then on its period
+  bool add(Task *t, uint32_t delay = 0)
+  {
+    if (_tasks.push_back(t) < 0)
+      return false;
+
+    uint64_t now = micros64();
+    if (!_tick)
+      _tick = now / 1000;
+    t->_deadline = now + (uint64_t)delay * 1000;
+    insert(t);
+    return true;
+  }
+
+  // Bring a waiting task to the next pass
+  void wake(Task *t)
+  {
+    Task **p = &_slots[(t->_deadline / 1000) % SCHEDULERSLOTS];
+    while (*p && *p != t)
+      p = &(*p)->_next;
+
+    // Ready or running already
+    if (!*p)
+      return;
+
+    *p = t->_next;
+    t->_deadline = micros64();
+    insert(t);
+  }
+
+  void run()
+  {
+    uint64_t now = micros64();
+
+    // Nothing can be due within the same ms
+    if (now / 1000 == _tick) {
+      _idle++;
+      return;
+    }
+
+    collect(now);
+    if (!_ready.size()) {
+      _idle++;
+      return;
+    }
+
+    _busy++;
+    while (_ready.size()) {
+      Task *t = _ready[0];
+      _ready.remove(0);
+
+      // In us, a blocking call of more than 71 minutes is counted as 71
+      uint64_t late = now > t->_deadline ? now - t->_deadline : 0;
+      t->_late.add(late > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)late);
+
+      t->_run.start();
+      uint32_t next = t->_callback();
+      t->_run.stop();
+
+      // Periods stay on their grid, late runs are skipped
+      now = micros64();
+      if (next)
+        t->_deadline = now + (uint64_t)next * 1000;
+      else {
+        uint64_t period = (uint64_t)t->_period * 1000;
+        t->_deadline += period;
+        if (t->_deadline <= now)
+          t->_deadline += ((now - t->_deadline) / period + 1) * period;
+      }
+      insert(t);
+
+      // A task of higher priority may be due now
+      if (now / 1000 != _tick)
+        collect(now);
+    }
+  }
+
+  TaskList &getTasks() { return _tasks; }
+  uint32_t getIdlePasses() { return _idle; }
+  uint32_t getBusyPasses() { return _busy; }
+
+  void reset()
+  {
+    _idle = _busy = 0;
+    for (int i = 0; i < _tasks.size(); i++) {
+      _tasks[i]->_run.reset();
+      _tasks[i]->_late.reset();
+    }
+  }
+};
+
+Scheduler _scheduler;
+
+#endif
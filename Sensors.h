@@ -0,0 +1,232 @@
+#ifndef SENSORS_H
+#define SENSORS_H
+
+//
+// I2C sensors sampled from the scheduler. Each sample is split in short bus
+// transactions, one by pass, with the conversion delays spent out of the loop.
+// A register read keeps its pointer write in the same pass (repeated start):
+// the RTC shares the bus and moves the pointer between two passes.
+// The last values are cached with their time : consumers never touch the bus.
+//
+
+#define SENSORSMAX 4
+
+// Last value of a sensor
+struct SensorValue
+{
+  float value;
+  uint64_t time;          // millis64() of the sample, 0 before the first one
+  uint32_t maxAge;        // ms before the value is stale
+
+  bool isValid() const
+  {
+    return time && millis64() - time <= maxAge;
+  }
+};
+
+class I2CSensor
+{
+protected:
+  const char *_name;
+  TwoWire &_wire;
+  uint8_t _address;
+  uint32_t _period;       // ms between two samples
+  uint8_t _step;          // next transaction of the sample
+  uint64_t _next;         // millis64() of the next transaction
+  uint32_t _errors;
+  SensorValue _value;
+
+  // Without stop, the bus is kept for a read with a repeated start
+  bool writeBytes(const uint8_t *data, int length, bool stop = true)
+  {
+    _wire.beginTransmission(_address);
+    for (int i = 0; i < length; i++)
+      _wire.write(data[i]);
+    return _wire.endTransmission(stop) == 0;
+  }
+
+  bool readBytes(uint8_t *data, int length)
+  {
+    if (_wire.requestFrom(_address, (uint8_t)length) != length)
+      return false;
+
+    for (int i = 0; i < length; i++)
+      data[i] = _wire.read();
+    return true;
+  }
+
+  void sample(float value)
+  {
+    _value.value = value;
+    _value.time = millis64();
+  }
+
+  // The transaction of the current step, ms to the next one
+  virtual uint32_t transaction(bool &ok) = 0;
+
+public:
+  I2CSensor(const char *name, TwoWire &wire, uint8_t address, uint32_t period)
+    : _name(name)
+    , _wire(wire)
+    , _address(address)
+    , _period(period)
+    , _step(0)
+    , _next(0)
+    , _errors(0)
+  {
+    _value.value = 0;
+    _value.time = 0;
+    _value.maxAge = 3 * period;
+  }
+
+  // Start again from the first transaction after a bus error
+  uint32_t step()
+  {
+    bool ok = true;
+    uint32_t next = transaction(ok);
+
+    if (!ok) {
+      _errors++;
+      _step = 0;
+      next = _period;
+    }
+
+    _next = millis64() + next;
+    return next;
+  }
+
+  uint64_t getNext() { return _next; }
+  const char *getName() { return _name; }
+  uint32_t getErrors() { return _errors; }
+  const SensorValue &getValue() { return _value; }
+};
+
+// DS3231 temperature : converted by the chip every 64s, read with the
+// oscillator state from the control register
+#define DS3231ADDRESS 0x68
+#define DS3231REGCONTROL 0x0E
+#define DS3231EOSC 0x80
+
+class SensorDS3231 : public I2CSensor
+{
+protected:
+  bool _running;
+
+  uint32_t transaction(bool &ok)
+  {
+    // Register pointer on control, status, aging, temperature, then read
+    uint8_t reg = DS3231REGCONTROL;
+    uint8_t r[5];
+    ok = writeBytes(&reg, 1, false) && readBytes(r, 5);
+    if (!ok)
+      return _period;
+
+    _running = !(r[0] & DS3231EOSC);
+    if (_running)
+      sample((int8_t)r[3] + (r[4] >> 6) * 0.25f);
+
+    return _period;
+  }
+
+public:
+  SensorDS3231(TwoWire &wire, uint32_t period)
+    : I2CSensor("temperature", wire, DS3231ADDRESS, period)
+    , _running(false)
+  {
+  }
+
+  bool isRunning() { return _running; }
+};
+
+// BH1750 light sensor in continuous high resolution mode, configured again
+// after a bus error in case it was powered off
+#define BH1750ADDRESS 0x23
+#define BH1750CONTINUOUSHIGHRES 0x10
+#define BH1750CONVERSION 180    // ms, max of the high resolution mode
+
+class SensorBH1750 : public I2CSensor
+{
+protected:
+  uint32_t transaction(bool &ok)
+  {
+    if (_step == 0) {
+      uint8_t mode = BH1750CONTINUOUSHIGHRES;
+      ok = writeBytes(&mode, 1);
+      _step = 1;
+      return BH1750CONVERSION;
+    }
+
+    uint8_t r[2];
+    ok = readBytes(r, 2);
+    if (ok)
+      sample(((r[0] << 8) | r[1]) / 1.2f);
+
+    return _period;
+  }
+
+public:
+  SensorBH1750(TwoWire &wire, uint32_t period)
+    : I2CSensor("light", wire, BH1750ADDRESS, period)
+  {
+  }
+};
+
+typedef void (*SensorCallback)(I2CSensor *sensor);
+
+class SensorHub
+{
+protected:
+  StaticVector<I2CSensor *, SENSORSMAX> _sensors;
+  SensorCallback _onSample;
+
+public:
+  SensorHub()
+    : _onSample(NULL)
+  {
+  }
+
+  void add(I2CSensor *s)
+  {
+    _sensors.push_back(s);
+  }
+
+  // Called after each new value
+  void onSample(SensorCallback callback)
+  {
+    _onSample = callback;
+  }
+
+  // One transaction at most by call, ms to the next due one
+  uint32_t handle()
+  {
+    uint64_t now = millis64();
+    I2CSensor *due = NULL;
+
+    for (int i = 0; i < _sensors.size(); i++)
+      if (_sensors[i]->getNext() <= now && (!due || _sensors[i]->getNext() < due->getNext()))
+        due = _sensors[i];
+
+    if (due) {
+      uint64_t t = due->getValue().time;
+      due->step();
+      if (_onSample && due->getValue().time != t)
+        _onSample(due);
+    }
+
+    uint64_t next = now + 60000;
+    for (int i = 0; i < _sensors.size(); i++)
+      if (_sensors[i]->getNext() < next)
+        next = _sensors[i]->getNext();
+
+    now = millis64();
+    return next > now ? (uint32_t)(next - now) : 1;
+  }
+
+  StaticVector<I2CSensor *, SENSORSMAX> &getSensors() { return _sensors; }
+};
+
+SensorDS3231 _sensorTemperature(Wire, 10000);
+SensorBH1750 _sensorLight(Wire, 1000);
+SensorHub _sensors;
+
+#endif
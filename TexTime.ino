@@ -22,18 +22,26 @@
 #include <ESP8266NetBIOS.h>
 #include <ESP8266LLMNR.h>
 
+extern "C" {
+#include <lwip/dns.h>
+}
+
 #include "PubSubClient.h"
 
 #include "WiFiMgr.h"
 #include "global.h"
 #include "mqtt_topics.h"
 #include "list.h"
+#include "Color.h"
+#include "Perf.h"
+#include "Scheduler.h"
 #include "RTC.h"
 #include "NTP.h"
 #include "LightSensor.h"
+#include "Sensors.h"
 #include "LedStrip.h"
 #include "mqtt.h"
-#include <BH1750.h> 
+#include "ResponseWriter.h"
 
 // Include the HTML, STYLE and Script "Pages"
 
@@ -47,10 +55,6 @@
 #include "Page_script.js.h"
 #include "Page_style.css.h"
 
-// - BH1750 - 
-BH1750 lightMeter;
-__int32_t nextTime;
-
 extern "C" {
 #include "user_interface.h"
 }
@@ -58,6 +62,87 @@ extern "C" {
 IPAddress _apIP(192, 168, 1, 1);
 IPAddress _apNetMsk(255, 255, 255, 0);
 
+// Scheduler tasks : each returns the ms to its next run, 0 for its period
+
+uint32_t taskLed()
+{
+  QTLed.handle();
+  return 0;
+}
+
+// Wake up on the next second of the clock
+uint32_t taskSecondTick()
+{
+  handleISRsecondTick();
+  return 1000 - _clock.nowMillis() % 1000;
+}
+
+// Handle WiFi AP/STA
+uint32_t taskWiFi()
+{
+  if (WiFiMgr.handle())
+    getNTPtime();
+  return 0;
+}
+
+// Follow a running NTP round closely
+uint32_t taskNTP()
+{
+  handleNTPRequest();
+  return _ntp.getState() != NTPClient::Idle ? 1 : 0;
+}
+
+uint32_t taskRTC()
+{
+  handleTimeFromRTC();
+  return 0;
+}
+
+uint32_t taskOTA()
+{
+  ArduinoOTA.handle();
+  return 0;
+}
+
+uint32_t taskWebServer()
+{
+  _server.handleClient();
+  return 0;
+}
+
+uint32_t taskMqtt()
+{
+  _mqtt.loop();
+  return 0;
+}
+
+// Temperature and light, one I2C transaction by run
+uint32_t taskSensors()
+{
+  return _sensors.handle();
+}
+
+// For debug purpose only
+uint32_t taskStatusLed()
+{
+  toggleLed(_timestamp);
+  return 0;
+}
+
+// Led frames first, then time keeping, then network housekeeping
+Task _taskLed("led", taskLed, 1, 0);
+Task _taskSecondTick("tick", taskSecondTick, 1000, 1);
+Task _taskNTP("ntp", taskNTP, 10, 2);
+Task _taskRTC("rtc", taskRTC, 3600000, 2);
+Task _taskWiFi("wifi", taskWiFi, 10, 3);
+Task _taskWebServer("web", taskWebServer, 5, 3);
+Task _taskOTA("ota", taskOTA, 20, 3);
+Task _taskMqtt("mqtt", taskMqtt, 10, 4);
+Task _taskMqttReconnect("mqttconnect", mqttReconnect, 1000, 4);
+Task _taskMqttPublish("mqttpublish", mqttPollingPublisher, 1000, 5);
+Task _taskSensors("sensors", taskSensors, 1000, 5);
+Task _taskStatusLed("status", taskStatusLed, 100, 6);
+
 //*** Normal code definition here ...
 void setup() {
   String chipID;
@@ -91,10 +176,11 @@ void setup() {
     _config.DNS[0] = 192; _config.DNS[1] = 168; _config.DNS[2] = 1; _config.DNS[3] = 1;
     _config.DeviceName = "TexTime";
 
-    _config.ntpServerName = "0.ch.pool.ntp.org"; // to be adjusted to PT ntp.ist.utl.pt
+    _config.ntpServerName = "0.ch.pool.ntp.org 1.ch.pool.ntp.org 2.ch.pool.ntp.org"; // queried one after the other
     _config.Update_Time_Via_NTP_Every = 86400;
     _config.timeZone = 10;
     _config.isDayLightSaving = true;
+    _config.tz = ""; // POSIX TZ rules, e.g. CET-1CEST,M3.5.0,M10.5.0/3, override the two fields above
 
     _config.brightnessAuto = true;
     _config.brightness = 128; // [0:255]
@@ -108,6 +194,9 @@ void setup() {
     _config.animation = 0;
     _config.ledConfig = 0;
     _config.luxSensitivity = 40;
+    _config.ledOutput = 0; // direct, gamma and dithering are opt-in
+    _config.transition = 0; // none
+    _config.layout = 0; // built-in
 
     _config.MQTTServer = "";
     _config.MQTTLogin = "";
@@ -116,6 +205,10 @@ void setup() {
     _config.MQTTPubInterval = 120; // in sec
   }
 
+  // Word layouts stored on the file system
+  SPIFFS.begin();
+  _textTimeLayouts.begin();
+
   // Start led strip
   QTLed.begin(); // Must be called after Serial.begin() and EEPROM configuration
 
@@ -124,6 +217,7 @@ void setup() {
   RTC.Enable32kHzPin(false);
   RTC.SetSquareWavePin(DS3231SquareWavePin_ModeNone);
   handleTimeFromRTC();
+  applyTimeZone();
   updateTime();
 
   //  Connect to WiFi access point or start as Access point
@@ -203,8 +297,12 @@ void setup() {
   _server.on("/admin/generalmodesvalues", send_general_modes_values_html);
   _server.on("/admin/generalanimationsvalues", send_general_animations_values_html);
   _server.on("/admin/generalledconfigvalues", send_general_ledconfig_values_html);
+  _server.on("/admin/generallayoutvalues", send_general_layout_values_html);
+  _server.on("/admin/generaloutputvalues", send_general_output_values_html);
+  _server.on("/admin/generaltransitionvalues", send_general_transition_values_html);
 
   _server.on("/admin/led", send_general_led);
+  _server.on("/admin/perf", send_perf_values_html);
 
 
   _server.onNotFound([]() {
@@ -269,19 +367,41 @@ void setup() {
   _mqtt.setServer(_config.MQTTServer.c_str(), _config.MQTTPort);
   _mqtt.setCallback(mqttCallback);
 
+  QTLed.setOutputMode(_config.ledOutput);
   QTLed.setAutomaticBrightness(_config.brightnessAuto);
   if (!_config.brightnessAuto) QTLed.setBrightness(_config.brightness);
   QTLed.setColor(_config.color[0], _config.color[1], _config.color[2]);
   QTLed.setColorRandom((RandomColorMode)_config.colorRandom);
   QTLed.setMode(_config.mode);
   QTLed.setAnimation(_config.animation);
+  QTLed.setTransition(_config.transition);
+  QTLed.setLayout(_config.layout);
 
   Serial.println("Ready");
 
-  // start light Sensor
+  // start I2C sensors, both support the 400kHz fast mode
   Wire.begin(D2, D1);                       // (SDA,SCL) 
-  lightMeter.begin();
-  nextTime = millis() + 10000;
+  Wire.setClock(400000);
+  _sensors.add(&_sensorTemperature);
+  _sensors.add(&_sensorLight);
+  _sensors.onSample([](I2CSensor *sensor) {
+    if (sensor == &_sensorLight)
+      updateAvgLux(sensor->getValue().value);
+  });
+
+  // Start the tasks, the RTC was just read
+  _scheduler.add(&_taskLed);
+  _scheduler.add(&_taskSecondTick);
+  _scheduler.add(&_taskNTP);
+  _scheduler.add(&_taskRTC, 3600000);
+  _scheduler.add(&_taskWiFi);
+  _scheduler.add(&_taskWebServer);
+  _scheduler.add(&_taskOTA);
+  _scheduler.add(&_taskMqtt);
+  _scheduler.add(&_taskMqttReconnect);
+  _scheduler.add(&_taskMqttPublish);
+  _scheduler.add(&_taskSensors);
+  _scheduler.add(&_taskStatusLed);
   
   //**** Normal Sketch code here...
 
@@ -292,50 +412,6 @@ void setup() {
 // the loop function runs over and over again forever
 void loop() {
 
-  // Handle WiFi AP/STA
-  if (WiFiMgr.handle()) {
-    getNTPtime();
-  }
-
-  // Update time from RTC
-  handleTimeFromRTC();
-
-  // Handle NTP receive packets
-  handleNTPRequest();
-
-  // Update time
-  handleISRsecondTick();
-
-  // OTA request handling
-  ArduinoOTA.handle();
-
-  // WebServer requests handling
-  _server.handleClient();
-
-  // DNS requests handling 
-  //_dnsServer.processNextRequest();
-
-  // MQTT
-  mqttReconnect();
-  _mqtt.loop();
-  mqttPollingPublisher();
-
-  // Read current light value every 100 ms
-  //handleAmbientLightSensor();
-  if (millis() > nextTime) {
-    int tempLux;
-    tempLux = (lightMeter.readLightLevel());
-    updateAvgLux(tempLux);
-    Serial.println(tempLux);
-    nextTime = millis() + 1000;
-  }
-
-  // Handle led display
-  QTLed.handle();
-
-  // For debug purpose only
-  toggleLed(_timestamp);
+  // Run the due tasks, led frames first
+  _scheduler.run();
 }
-
-
-
@@ -33,6 +33,9 @@ struct strConfig {
   byte brightnessAutoMinNight;          // 1 Byte - EEPROM 394
   byte ledConfig;                       // 1 Byte - EEPROM 395
   byte luxSensitivity;                  // 1 Byte - EEPROM 396
+  byte ledOutput;                       // 1 Byte - EEPROM 397
+  byte transition;                      // 1 Byte - EEPROM 398
+  byte layout;                          // 1 Byte - EEPROM 399
 
   String MQTTServer;                    // up to 64 Byte - EEPROM 512
   String MQTTLogin;                     // up to 64 Byte - EEPROM 576
@@ -40,6 +43,8 @@ struct strConfig {
   long MQTTPort;                        // 4 Byte - EEPROM 704
   long MQTTPubInterval;                 // 4 Byte - EEPROM 708
 
+  String tz;                            // up to 64 Byte - EEPROM 768
+
 } _config;
 
 
@@ -177,6 +182,9 @@ void WriteConfig(){
   EEPROM.write(394, _config.brightnessAutoMinNight);
   EEPROM.write(395, _config.ledConfig);
   EEPROM.write(396, _config.luxSensitivity);
+  EEPROM.write(397, _config.ledOutput);
+  EEPROM.write(398, _config.transition);
+  EEPROM.write(399, _config.layout);
 
   WriteStringToEEPROM(512, _config.MQTTServer);
   WriteStringToEEPROM(576, _config.MQTTLogin);
@@ -184,6 +192,8 @@ void WriteConfig(){
   EEPROMWritelong(704, _config.MQTTPort);
   EEPROMWritelong(708, _config.MQTTPubInterval);
 
+  WriteStringToEEPROM(768, _config.tz);
+
   EEPROM.commit();
 }
 
@@ -231,6 +241,9 @@ boolean ReadConfig(){
     _config.brightnessAutoMinNight = EEPROM.read(394);
     _config.ledConfig = EEPROM.read(395);
     _config.luxSensitivity = EEPROM.read(396);
+    _config.ledOutput = EEPROM.read(397);
+    _config.transition = EEPROM.read(398);
+    _config.layout = EEPROM.read(399);
 
     _config.MQTTServer = ReadStringFromEEPROM(512);
     _config.MQTTLogin = ReadStringFromEEPROM(576);
@@ -238,6 +251,8 @@ boolean ReadConfig(){
     _config.MQTTPort = EEPROMReadlong(704);
     _config.MQTTPubInterval = EEPROMReadlong(708);
 
+    _config.tz = ReadStringFromEEPROM(768);
+
     return true;
 
   }
@@ -259,6 +274,7 @@ void printConfig(){
 
   Serial.printf("NTP update every %ld sec\n", _config.Update_Time_Via_NTP_Every); // 4 Byte
   Serial.printf("Timezone %ld\n", _config.timeZone); // 4 Byte
+  Serial.printf("TZ:%s\n", _config.tz.c_str());
 
   Serial.printf("IP:%d.%d.%d.%d\n", _config.IP[0],_config.IP[1],_config.IP[2],_config.IP[3]);
   Serial.printf("Mask:%d.%d.%d.%d\n", _config.Netmask[0],_config.Netmask[1],_config.Netmask[2],_config.Netmask[3]);
@@ -281,6 +297,8 @@ void printConfig(){
   Serial.printf("Minimum brightness auto during the day:%d\n", _config.brightnessAutoMinDay);
   Serial.printf("Minimum brightness auto during the night:%d\n", _config.brightnessAutoMinNight);
   Serial.printf("Led Configuration:%d\n", _config.ledConfig);
+  Serial.printf("Led Output:%d\n", _config.ledOutput);
+  Serial.printf("Transition:%d\n", _config.transition);
 }
 
 
@@ -365,6 +383,14 @@ uint64_t millis64() {
   return (uint64_t)high32 << 32 | low32;
 }
 
+uint64_t micros64() {
+  static uint32_t low32, high32;
+  uint32_t new_low32 = micros();
+  if (new_low32 < low32) high32++;
+  low32 = new_low32;
+  return (uint64_t)high32 << 32 | low32;
+}
+
 void toggleLed(unsigned long counter)
 {
   static int p = 0;
@@ -390,35 +416,88 @@ String dec2hex2(byte v)
 }
 
 
+enum FramePolicy
+{
+  FrameSkip = 0,  // late frames are dropped, next frames stay on the nominal grid
+  FrameCatchUp    // late frames are run back to back until the schedule is met
+};
+
+// Late frames run by a catch up scheduler before it gives up and resynchronizes
+#define FRAMECATCHUPMAX 4
+
+// Time shared by all the frame schedulers during a loop pass (us)
+uint64_t _frameTick = 0;
+
+void frameTick()
+{
+  _frameTick = micros64();
+}
+
+// Frame scheduler with integer deadlines:
+// a frame is due every period from the first one, whatever the loop latency.
 class Frame
 {
 private:
-  double _fps;
-  uint64_t _framePrevious;
+  uint32_t _period;
+  uint64_t _deadline;
+  bool _started;
+  FramePolicy _policy;
+  uint32_t _skipped;
 
 public:
-  Frame() :
-    _fps(10),
-    _framePrevious(0)
+  Frame(double fps = 10, FramePolicy policy = FrameSkip)
   {
+    init(fps, policy);
   }
 
-  void init(double fps)
+  void init(double fps, FramePolicy policy = FrameSkip)
   {
-    _fps = fps;
-    _framePrevious = 0;
+    _period = 1000000.0 / fps;
+    if (_period == 0) _period = 1;
+    _deadline = 0;
+    _started = false;
+    _policy = policy;
+    _skipped = 0;
   }
 
   bool next()
   {
-    uint64_t frame = millis64();
+    uint64_t now = _frameTick;
+
+    // First frame is due now
+    if (!_started) {
+      _started = true;
+      _deadline = now + _period;
+      return true;
+    }
 
-    if (frame - _framePrevious < (1000.0 / _fps))
+    if (now < _deadline)
       return false;
 
-    _framePrevious = frame;
+    _deadline += _period;
+
+    // Late by more than a period
+    if (now >= _deadline) {
+      uint32_t late = (now - _deadline) / _period + 1;
+
+      if (_policy == FrameSkip || late > FRAMECATCHUPMAX) {
+        _deadline += (uint64_t)late * _period;
+        _skipped += late;
+      }
+    }
+
     return true;
   }
+
+  uint32_t period() const
+  {
+    return _period;
+  }
+
+  uint32_t skipped() const
+  {
+    return _skipped;
+  }
 };
 
 #endif
@@ -1,23 +1,66 @@
 
 
-uint64_t _mqttPollingPublisherTimer = 0;
-void mqttPollingPublisher()
+extern Task _taskMqttPublish;
+
+// Line i of the timings, render stages then scheduler tasks and their lateness:
+// "name count min mean max" (us). Empty past the last one.
+int mqttPerfLine(char *s, size_t size, int i)
 {
-  // if not connected, exit
-  if (!_mqtt.connected())
-    return;
+  TaskList &tasks = _scheduler.getTasks();
+  char summary[PERFSUMMARYMAX];
+  int n;
+
+  if (i < (int)NPERFSTAGES)
+    n = snprintf(s, size, "%s %s\n", _perfStages[i]->getName(), _perfStages[i]->summary(summary));
+  else if (i - (int)NPERFSTAGES < 2 * tasks.size()) {
+    i -= NPERFSTAGES;
+    Task *t = tasks[i / 2];
+    if (i & 1)
+      n = snprintf(s, size, "task %s/late %s\n", t->getName(), t->getLateStats().summary(summary));
+    else
+      n = snprintf(s, size, "task %s %s\n", t->getName(), t->getRunStats().summary(summary));
+  }
+  else
+    n = 0;
 
-  // polling not to fast
-  if (millis64() - _mqttPollingPublisherTimer < (uint64_t)_config.MQTTPubInterval * 1000 && _mqttPollingPublisherTimer != 0)
+  return n < (int)size ? n : size - 1;
+}
+
+// All the timings in one message, not retained : the lines are sized, then
+// written again straight to the client
+void mqttPublishPerf()
+{
+  char line[80];
+  unsigned int length = 0;
+
+  for (int i = 0, n; (n = mqttPerfLine(line, sizeof(line), i)); i++)
+    length += n;
+
+  if (!_mqtt.beginPublish(mqttTopicPubPerf.topic().c_str(), length, false))
     return;
 
-  if (RTC.GetIsRunning())
-    _mqtt.publish(mqttTopicPubTemp.topic().c_str(), String(RTC.GetTemperature().AsFloatDegC(), 2).c_str(), true);
+  for (int i = 0, n; (n = mqttPerfLine(line, sizeof(line), i)); i++)
+    _mqtt.write((const uint8_t *)line, n);
+
+  _mqtt.endPublish();
+}
+
+// Scheduler task : ms to the next publication
+uint32_t mqttPollingPublisher()
+{
+  // if not connected, check again on the task period
+  if (!_mqtt.connected())
+    return 0;
+
+  if (_sensorTemperature.getValue().isValid())
+    _mqtt.publish(mqttTopicPubTemp.topic().c_str(), String(_sensorTemperature.getValue().value, 2).c_str(), true);
 
   _mqtt.publish(mqttTopicPubLight.topic().c_str(), String(getAvgLux()).c_str(), true);
 
   _mqtt.publish(mqttTopicPubRssi.topic().c_str(), String(GetRSSIinPercent(WiFi.RSSI())).c_str(), true);
 
+  mqttPublishPerf();
+
   byte r, g, b;
   QTLed.getColor(r, g, b);
 
@@ -32,7 +75,9 @@ void mqttPollingPublisher()
 
   _mqtt.publish(mqttTopicPubLedAnim.topic().c_str(), String(QTLed.getAnimationIndex()).c_str(), true);
 
-  _mqttPollingPublisherTimer = millis64();
+  _mqtt.publish(mqttTopicPubLedOutput.topic().c_str(), String(QTLed.getOutputMode()).c_str(), true);
+
+  return (uint32_t)_config.MQTTPubInterval * 1000;
 }
 
 void mqttCallback(char* topic, byte* payloadraw, unsigned int length) {
@@ -111,22 +156,42 @@ void mqttCallback(char* topic, byte* payloadraw, unsigned int length) {
     Serial.print("Set animation from MQTT : ");
     Serial.println(payload);
   }
-}
 
-void mqttReconnect() {
-  static uint64_t t = 0;
+  // Set output mode (0: direct, 1: gamma, 2: gamma + dithering)
+  if (!strncmp(topic, mqttTopicSubLedOutput.topic().c_str(), mqttTopicSubLedOutput.topic().length())) {
+
+    // If there is no payload, send back the current value
+    if (payload.length() == 0) {
+      _mqtt.publish(mqttTopicPubLedOutput.topic().c_str(), String(QTLed.getOutputMode()).c_str(), true);
+      return;
+    }
+
+    if (!QTLed.setOutputMode(payload.toInt()))
+      return;
 
+    Serial.print("Set output mode from MQTT : ");
+    Serial.println(payload);
+  }
+
+  // Spell a text on the grid, an empty payload stops it
+  if (!strncmp(topic, mqttTopicSubLedText.topic().c_str(), mqttTopicSubLedText.topic().length())) {
+
+    QTLed.spellText(payload);
+
+    Serial.print("Spell text from MQTT : ");
+    Serial.println(payload);
+  }
+}
+
+// Scheduler task : ms to the next check
+uint32_t mqttReconnect() {
   // if connected, exit
   if (_mqtt.connected())
-    return;
+    return 0;
 
   // if there is no mqtt broker, exit
   if (_config.MQTTServer.length() == 0)
-    return;
-
-  // retry not to fast
-  if (millis64() - t < 5000)
-    return;
+    return 0;
 
   // Connect
   int r = 0;
@@ -142,12 +207,11 @@ void mqttReconnect() {
     Serial.print(_mqtt.state());
     Serial.println(" try again in 5 seconds");
 
-    t = millis64();
-
-    return;
+    return 5000;
   }
 
-  _mqttPollingPublisherTimer = 0;
+  // Publish now
+  _scheduler.wake(&_taskMqttPublish);
 
   // Connection OK
   Serial.println("MQTT connected :)");
@@ -155,4 +219,8 @@ void mqttReconnect() {
   _mqtt.subscribe(mqttTopicSubLedColor.topic().c_str());
   _mqtt.subscribe(mqttTopicSubLedMode.topic().c_str());
   _mqtt.subscribe(mqttTopicSubLedAnim.topic().c_str());
+  _mqtt.subscribe(mqttTopicSubLedOutput.topic().c_str());
+  _mqtt.subscribe(mqttTopicSubLedText.topic().c_str());
+
+  return 0;
 }
@@ -22,11 +22,15 @@ public:
 MQTTTopic mqttTopicSubLedColor("cmnd", "led/color");
 MQTTTopic mqttTopicSubLedMode("cmnd", "led/mode");
 MQTTTopic mqttTopicSubLedAnim("cmnd", "led/animation");
+MQTTTopic mqttTopicSubLedOutput("cmnd", "led/output");
+MQTTTopic mqttTopicSubLedText("cmnd", "led/text");
 
 MQTTTopic mqttTopicPubLedColor("stat", "led/color");
 MQTTTopic mqttTopicPubLedMode("stat", "led/mode");
 MQTTTopic mqttTopicPubLedAnim("stat", "led/animation");
+MQTTTopic mqttTopicPubLedOutput("stat", "led/output");
 
 MQTTTopic mqttTopicPubTemp("tele", "temperature");
 MQTTTopic mqttTopicPubLight("tele", "ambientlight");
-MQTTTopic mqttTopicPubRssi("tele", "rssi");
\ No newline at end of file
+MQTTTopic mqttTopicPubRssi("tele", "rssi");
+MQTTTopic mqttTopicPubPerf("tele", "perf");
\ No newline at end of file
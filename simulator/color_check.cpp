@@ -0,0 +1,51 @@
+// Host check of the integer hue kernels of Color.h against the float
+// conversion of HslColor, over their whole input range
+//
+//   make check
+
+#include <Arduino.h>
+#include <NeoPixelBus.h>
+
+#include "Color.h"
+
+uint64_t _simMicros = 0;
+uint32_t _simRandom = 1;
+
+static int distance(const RgbColor &a, const RgbColor &b)
+{
+  int d = abs(a.R - b.R);
+  if (abs(a.G - b.G) > d) d = abs(a.G - b.G);
+  if (abs(a.B - b.B) > d) d = abs(a.B - b.B);
+  return d;
+}
+
+int main()
+{
+  int failures = 0;
+
+  int worst8 = 0;
+  for (int h = 0; h < 256; h++) {
+    int d = distance(hue8ToRgb(h), RgbColor(HslColor(h / 255.0f, 1.0f, 0.5f)));
+    if (d > worst8) worst8 = d;
+  }
+  if (worst8 > 1) {
+    printf("FAILED: hue8ToRgb differs by %d from HslColor\n", worst8);
+    failures++;
+  }
+
+  int worst16 = 0;
+  for (uint32_t h = 0; h < 65536; h++) {
+    int d = distance(hue16ToRgb(h), RgbColor(HslColor(h / 65536.0f, 1.0f, 0.5f)));
+    if (d > worst16) worst16 = d;
+  }
+  if (worst16 > 1) {
+    printf("FAILED: hue16ToRgb differs by %d from HslColor\n", worst16);
+    failures++;
+  }
+
+  if (failures)
+    return 1;
+
+  printf("Hue kernels checked, within %d and %d of HslColor over 256 and 65536 hues\n", worst8, worst16);
+  return 0;
+}
@@ -0,0 +1,231 @@
+// Host check of the date conversions of NTP.h against the former year by
+// year conversion and the host C library, over the whole 32 bits range
+// (1970 to 2106), and of the time zone rules against the C library
+//
+//   make check
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <ESP8266WebServer.h>
+#include <ESP8266HTTPUpdateServer.h>
+#include <WiFiUdp.h>
+#include <lwip/dns.h>
+#include <EEPROM.h>
+#include <DNSServer.h>
+#include <Wire.h>
+#include <RtcDS3231.h>
+#include <PubSubClient.h>
+
+#include "global.h"
+#include "list.h"
+#include "Perf.h"
+#include "RTC.h"
+#include "NTP.h"
+
+#include <time.h>
+
+uint64_t _simMicros = 0;
+uint32_t _simRandom = 1;
+
+HardwareSerial Serial;
+EspClass ESP;
+ESP8266WiFiClass WiFi;
+EEPROMClass EEPROM;
+TwoWire Wire;
+
+uint32_t EspClass::getCycleCount()
+{
+  return 0;
+}
+
+// The former conversion, walking every year since 1970
+static strDateTime referenceConvert(uint32_t time)
+{
+  strDateTime d;
+  uint16_t year;
+  uint8_t month, monthLength;
+  unsigned long days;
+
+  d.second = time % 60;
+  time /= 60;
+  d.minute = time % 60;
+  time /= 60;
+  d.hour = time % 24;
+  time /= 24;
+  d.wday = ((time + 4) % 7) + 1;
+
+  year = 0;
+  days = 0;
+  while ((unsigned)(days += (LEAP_YEAR(year) ? 366 : 365)) <= time)
+    year++;
+
+  days -= LEAP_YEAR(year) ? 366 : 365;
+  time -= days;
+
+  for (month = 0; month < 12; month++) {
+    monthLength = month == 1 ? (LEAP_YEAR(year) ? 29 : 28) : _monthDays[month];
+    if (time >= monthLength)
+      time -= monthLength;
+    else
+      break;
+  }
+
+  d.year = year + 1970;
+  d.month = month + 1;
+  d.day = time + 1;
+
+  return d;
+}
+
+static bool same(const strDateTime &a, const strDateTime &b)
+{
+  return a.year == b.year && a.month == b.month && a.day == b.day && a.wday == b.wday &&
+         a.hour == b.hour && a.minute == b.minute && a.second == b.second;
+}
+
+static bool sameLibc(uint32_t t, const strDateTime &d)
+{
+  time_t tt = (time_t)t;
+  struct tm tm;
+  gmtime_r(&tt, &tm);
+
+  return d.year == tm.tm_year + 1900 && d.month == tm.tm_mon + 1 && d.day == tm.tm_mday && d.wday == tm.tm_wday + 1 &&
+         d.hour == tm.tm_hour && d.minute == tm.tm_min && d.second == tm.tm_sec;
+}
+
+static int fail(const char *what, uint32_t t, const strDateTime &d)
+{
+  fprintf(stderr, "%s differs at %u : %s\n", what, t, printDateTime(d).c_str());
+  return 1;
+}
+
+// Offsets of TimeZone and localtime() on every hour, and around every change
+static int checkTimeZone(const char *tz, uint32_t &checks)
+{
+  TimeZone z;
+  if (!z.begin(tz)) {
+    fprintf(stderr, "Cannot parse %s\n", tz);
+    return 1;
+  }
+
+  setenv("TZ", tz, 1);
+  tzset();
+
+  long previous = 0;
+  for (uint32_t t = 86400; t < 0x7FFFFFFFUL - 3600; t += 3600) {
+    time_t tt = (time_t)t;
+    struct tm tm;
+    localtime_r(&tt, &tm);
+
+    long offset = z.getOffset(t);
+    if (offset != tm.tm_gmtoff) {
+      fprintf(stderr, "%s : offset %ld instead of %ld at %u\n", tz, offset, (long)tm.tm_gmtoff, t);
+      return 1;
+    }
+    checks++;
+
+    // Find the change second by second
+    if (t > 86400 && offset != previous)
+      for (uint32_t s = t - 3600; s <= t; s++) {
+        tt = (time_t)s;
+        localtime_r(&tt, &tm);
+        if (z.getOffset(s) != tm.tm_gmtoff) {
+          fprintf(stderr, "%s : offset %ld instead of %ld at %u\n", tz, z.getOffset(s), (long)tm.tm_gmtoff, s);
+          return 1;
+        }
+        checks++;
+      }
+    previous = offset;
+  }
+
+  return 0;
+}
+
+int main()
+{
+  const uint32_t lastDay = 0xFFFFFFFFUL / 86400;
+  const uint32_t seconds[] = { 0, 1, 3599, 43200, 86398 };
+  uint32_t checks = 0;
+
+  for (uint32_t day = 0; day <= lastDay; day++) {
+    for (uint32_t s : seconds) {
+      uint32_t t = day * 86400 + s;
+      if (t < day * 86400)
+        break;
+
+      strDateTime d = convertUnixTimeStamp(t);
+      if (!same(d, referenceConvert(t)))
+        return fail("Conversion", t, d);
+      if (!sameLibc(t, d))
+        return fail("C library", t, d);
+      checks++;
+    }
+
+    // Tick across midnight, months and years
+    uint32_t t = day * 86400 + 86398;
+    if (day == lastDay)
+      continue;
+
+    strDateTime d = convertUnixTimeStamp(t);
+    for (int i = 1; i <= 4; i++) {
+      tickDateTime(d);
+      if (!same(d, convertUnixTimeStamp(t + i)))
+        return fail("Tick", t + i, d);
+      checks++;
+    }
+  }
+
+  // Ticking a whole leap year second by second
+  uint32_t t = 946684800UL; // 2000-01-01
+  strDateTime d = convertUnixTimeStamp(t);
+  for (uint32_t i = 0; i < 366UL * 86400; i++) {
+    tickDateTime(d);
+    t++;
+    if (d.second == 0 && !same(d, convertUnixTimeStamp(t)))
+      return fail("Tick", t, d);
+  }
+
+  printf("Dates match from 1970 to 2106, %u checks\n", checks);
+
+  // The C library applies the rules to every year up to 2038
+  const char *zones[] = {
+    "CET-1CEST,M3.5.0,M10.5.0/3",
+    "EST5EDT,M3.2.0,M11.1.0",
+    "AEST-10AEDT,M10.1.0,M4.1.0/3",
+    "NZST-12NZDT,M9.5.0,M4.1.0/3",
+    "<-03>3<-02>,M3.5.0/-2,M10.5.0/-1",
+    "IST-5:30",
+    "<+0545>-5:45",
+    "IST-1GMT0,M10.5.0,M3.5.0/1",
+    "WET0WEST,J60/1,J300/2",
+    "XXX3YYY,59/2,299",
+  };
+  checks = 0;
+  for (const char *tz : zones)
+    if (checkTimeZone(tz, checks))
+      return 1;
+
+  // Without rules, the US ones. The fallback of the time zone and daylight saving fields is the European rule
+  TimeZone us, usDefault, eu, fallback;
+  us.begin("XST8XDT,M3.2.0,M11.1.0");
+  usDefault.begin("XST8XDT");
+  eu.begin("CET-1CEST,M3.5.0,M10.5.0/3");
+  fallback.setOffset(3600, true);
+  for (uint32_t t = 0; t < 0xFFFFFFFFUL - 900; t += 900)
+    if (us.getOffset(t) != usDefault.getOffset(t) || eu.getOffset(t) != fallback.getOffset(t)) {
+      fprintf(stderr, "Default rules differ at %u\n", t);
+      return 1;
+    }
+
+  const char *invalid[] = { "", "CET", "C-1", "CET-1CEST,M3.5.0", "CET-1CEST,M13.5.0,M10.5.0", "CET-1CEST,M3.5.0,M10.5.0/3x" };
+  for (const char *tz : invalid) {
+    TimeZone z;
+    if (z.begin(tz)) {
+      fprintf(stderr, "Invalid rule %s accepted\n", tz);
+      return 1;
+    }
+  }
+
+  printf("Time zones match the C library, %u checks\n", checks);
+  return 0;
+}
@@ -0,0 +1,217 @@
+// Arduino core stand-in for the host simulator.
+// Only what the LED rendering code uses is implemented, network and
+// storage classes are inert.
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define PGM_P const char *
+#define FPSTR(p) (p)
+#define F(s) (s)
+class __FlashStringHelper;
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_byte_near(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define strlen_P strlen
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+#define snprintf_P snprintf
+
+#define HEX 16
+#define DEC 10
+#define INPUT 0
+#define OUTPUT 1
+#define LOW 0
+#define HIGH 1
+#define D1 5
+#define D2 4
+#define D4 2
+#define A0 17
+#define LED_BUILTIN 2
+
+// Simulated time, driven by the simulator main loop
+extern uint64_t _simMicros;
+
+inline unsigned long millis() { return (unsigned long)(_simMicros / 1000); }
+inline unsigned long micros() { return (unsigned long)_simMicros; }
+inline void delay(unsigned long ms) { _simMicros += (uint64_t)ms * 1000; }
+inline void yield() {}
+
+// Seedable random, independent from the host libc
+extern uint32_t _simRandom;
+
+inline void randomSeed(unsigned long seed) { _simRandom = seed ? seed : 1; }
+inline long random(long max)
+{
+  // xorshift32
+  _simRandom ^= _simRandom << 13;
+  _simRandom ^= _simRandom >> 17;
+  _simRandom ^= _simRandom << 5;
+  return max > 0 ? (long)(_simRandom % (uint32_t)max) : 0;
+}
+inline long random(long min, long max) { return min < max ? min + random(max - min) : min; }
+
+inline long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+inline uint16_t word(uint8_t h, uint8_t l) { return (h << 8) | l; }
+template <class T> T constrain(T x, T a, T b) { return x < a ? a : (x > b ? b : x); }
+
+inline void pinMode(int, int) {}
+inline void digitalWrite(int, int) {}
+inline int analogRead(int) { return 0; }
+
+class String
+{
+private:
+  std::string _s;
+
+  static std::string fromInt(long long v, int base)
+  {
+    char b[32];
+    if (base == HEX) snprintf(b, sizeof(b), "%llx", v); else snprintf(b, sizeof(b), "%lld", v);
+    return b;
+  }
+
+  static std::string fromUInt(unsigned long long v, int base)
+  {
+    char b[32];
+    if (base == HEX) snprintf(b, sizeof(b), "%llx", v); else snprintf(b, sizeof(b), "%llu", v);
+    return b;
+  }
+
+public:
+  String() {}
+  String(const char *s) : _s(s ? s : "") {}
+  String(const std::string &s) : _s(s) {}
+  explicit String(char c) : _s(1, c) {}
+  String(int v, int base = DEC) : _s(fromInt(v, base)) {}
+  String(long v, int base = DEC) : _s(fromInt(v, base)) {}
+  String(long long v, int base = DEC) : _s(fromInt(v, base)) {}
+  String(unsigned char v, int base = DEC) : _s(fromUInt(v, base)) {}
+  String(unsigned int v, int base = DEC) : _s(fromUInt(v, base)) {}
+  String(unsigned long v, int base = DEC) : _s(fromUInt(v, base)) {}
+  String(unsigned long long v, int base = DEC) : _s(fromUInt(v, base)) {}
+  String(double v, int digits = 2)
+  {
+    char b[48];
+    snprintf(b, sizeof(b), "%.*f", digits, v);
+    _s = b;
+  }
+
+  const char *c_str() const { return _s.c_str(); }
+  unsigned int length() const { return _s.size(); }
+  bool reserve(unsigned int n) { _s.reserve(n); return true; }
+  String substring(unsigned int from) const { return from < _s.size() ? _s.substr(from) : std::string(); }
+  String substring(unsigned int from, unsigned int to) const { return from < _s.size() ? _s.substr(from, to - from) : std::string(); }
+  int indexOf(char c, unsigned int from = 0) const { size_t p = _s.find(c, from); return p == std::string::npos ? -1 : (int)p; }
+  int indexOf(const String &s, unsigned int from = 0) const { size_t p = _s.find(s._s, from); return p == std::string::npos ? -1 : (int)p; }
+  bool startsWith(const String &s) const { return _s.compare(0, s._s.size(), s._s) == 0; }
+  bool endsWith(const String &s) const { return _s.size() >= s._s.size() && _s.compare(_s.size() - s._s.size(), s._s.size(), s._s) == 0; }
+  void toUpperCase() { for (size_t i = 0; i < _s.size(); i++) _s[i] = toupper(_s[i]); }
+  void toLowerCase() { for (size_t i = 0; i < _s.size(); i++) _s[i] = tolower(_s[i]); }
+  void trim()
+  {
+    size_t b = _s.find_first_not_of(" \t\r\n");
+    size_t e = _s.find_last_not_of(" \t\r\n");
+    _s = b == std::string::npos ? std::string() : _s.substr(b, e - b + 1);
+  }
+  long toInt() const { return atol(_s.c_str()); }
+  float toFloat() const { return atof(_s.c_str()); }
+  void toCharArray(char *buf, unsigned int size) const { if (size) { strncpy(buf, _s.c_str(), size - 1); buf[size - 1] = 0; } }
+  bool concat(char c) { _s += c; return true; }
+  bool concat(const String &s) { _s += s._s; return true; }
+
+  char operator[](unsigned int i) const { return _s[i]; }
+  char &operator[](unsigned int i) { return _s[i]; }
+  String &operator+=(const String &s) { _s += s._s; return *this; }
+  String &operator+=(const char *s) { _s += s; return *this; }
+  String &operator+=(char c) { _s += c; return *this; }
+  bool operator==(const String &s) const { return _s == s._s; }
+  bool operator==(const char *s) const { return _s == s; }
+  bool operator!=(const String &s) const { return _s != s._s; }
+  bool operator!=(const char *s) const { return _s != s; }
+
+  friend String operator+(const String &a, const String &b) { return a._s + b._s; }
+  friend String operator+(const String &a, const char *b) { return a._s + b; }
+  friend String operator+(const char *a, const String &b) { return a + b._s; }
+  friend String operator+(const String &a, char b) { return a._s + b; }
+};
+
+// Output is discarded, the simulator prints its own report
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t) { return 1; }
+  virtual size_t write(const uint8_t *, size_t n) { return n; }
+  size_t printf(const char *, ...) { return 0; }
+  template <class T> size_t print(const T &) { return 0; }
+  template <class T> size_t print(const T &, int) { return 0; }
+  template <class T> size_t println(const T &) { return 0; }
+  template <class T> size_t println(const T &, int) { return 0; }
+  size_t println() { return 0; }
+};
+
+class Stream : public Print
+{
+public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+  virtual int peek() { return -1; }
+  virtual void flush() {}
+  void setTimeout(unsigned long) {}
+};
+
+class HardwareSerial : public Stream
+{
+public:
+  void begin(unsigned long) {}
+};
+
+extern HardwareSerial Serial;
+
+class IPAddress
+{
+private:
+  uint8_t _b[4];
+
+public:
+  IPAddress() { memset(_b, 0, sizeof(_b)); }
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) { _b[0] = a; _b[1] = b; _b[2] = c; _b[3] = d; }
+  // Network order, like lwIP
+  IPAddress(uint32_t address) { memcpy(_b, &address, sizeof(_b)); }
+  operator uint32_t() const { uint32_t a; memcpy(&a, _b, sizeof(a)); return a; }
+  uint8_t operator[](int i) const { return _b[i]; }
+  uint8_t &operator[](int i) { return _b[i]; }
+};
+
+class EspClass
+{
+public:
+  uint32_t getChipId() { return 0x5173; }
+  uint32_t getCpuFreqMHz() { return 80; }
+  uint32_t getFreeHeap() { return 0; }
+  uint32_t getMaxFreeBlockSize() { return 0; }
+  // Host time converted to cycles of an 80MHz CPU
+  uint32_t getCycleCount();
+  void restart() {}
+};
+
+extern EspClass ESP;
+
+#endif
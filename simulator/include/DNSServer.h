@@ -0,0 +1,11 @@
+// DNSServer stand-in for the host simulator
+#ifndef SIM_DNSSERVER_H
+#define SIM_DNSSERVER_H
+
+#include <Arduino.h>
+
+class DNSServer
+{
+};
+
+#endif
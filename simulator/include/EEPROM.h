@@ -0,0 +1,22 @@
+// EEPROM stand-in for the host simulator: an erased memory
+#ifndef SIM_EEPROM_H
+#define SIM_EEPROM_H
+
+#include <Arduino.h>
+
+class EEPROMClass
+{
+private:
+  uint8_t _data[1024];
+
+public:
+  EEPROMClass() { memset(_data, 0xFF, sizeof(_data)); }
+  void begin(size_t) {}
+  uint8_t read(int address) { return _data[address]; }
+  void write(int address, uint8_t value) { _data[address] = value; }
+  bool commit() { return true; }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,11 @@
+// ESP8266HTTPUpdateServer stand-in for the host simulator
+#ifndef SIM_ESP8266HTTPUPDATESERVER_H
+#define SIM_ESP8266HTTPUPDATESERVER_H
+
+#include <ESP8266WebServer.h>
+
+class ESP8266HTTPUpdateServer
+{
+};
+
+#endif
@@ -0,0 +1,95 @@
+// ESP8266WebServer stand-in for the host simulator: the response is kept
+// in a string, chunked bodies are framed like the real server does, the
+// arguments of the request are set by the host tool
+#ifndef SIM_ESP8266WEBSERVER_H
+#define SIM_ESP8266WEBSERVER_H
+
+#include <Arduino.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+
+class ESP8266WebServer
+{
+private:
+  size_t _contentLength;
+  bool _chunked;
+
+public:
+  std::vector<std::pair<String, String> > simArgs;
+  std::string simHeaders;
+  std::string simBody;      // body as sent, with the chunk framing
+  uint32_t simWrites;       // writes to the client
+
+  ESP8266WebServer(int) : _contentLength(0), _chunked(false), simWrites(0) {}
+
+  // Room reserved so that the stand-in itself does not allocate while a body is sent
+  void simReset()
+  {
+    simHeaders.clear();
+    simBody.clear();
+    simHeaders.reserve(1024);
+    simBody.reserve(4096);
+    simWrites = 0;
+  }
+
+  int args() { return (int)simArgs.size(); }
+  String argName(int i) { return simArgs[i].first; }
+  String arg(int i) { return simArgs[i].second; }
+
+  String arg(const String &name)
+  {
+    for (size_t i = 0; i < simArgs.size(); i++)
+      if (simArgs[i].first == name) return simArgs[i].second;
+    return "";
+  }
+
+  bool hasArg(const String &name)
+  {
+    for (size_t i = 0; i < simArgs.size(); i++)
+      if (simArgs[i].first == name) return true;
+    return false;
+  }
+
+  void sendHeader(const String &name, const String &value, bool = false)
+  {
+    simHeaders += std::string(name.c_str()) + ": " + value.c_str() + "\r\n";
+  }
+
+  void setContentLength(size_t length) { _contentLength = length; }
+
+  void send(int code, const char *type, const String &content)
+  {
+    _chunked = _contentLength == CONTENT_LENGTH_UNKNOWN;
+    simHeaders += "HTTP/1.1 " + std::to_string(code) + "\r\nContent-Type: " + type + "\r\n";
+    simWrites++;
+    if (content.length())
+      sendContent(content.c_str(), content.length());
+    _contentLength = 0;
+  }
+
+  void send_P(int code, const char *type, PGM_P content) { send(code, type, content); }
+
+  void sendContent(const char *content, size_t size)
+  {
+    char header[20];
+    if (_chunked) {
+      snprintf(header, sizeof(header), "%zx\r\n", size);
+      simBody += header;
+    }
+    simBody.append(content, size);
+    if (_chunked) {
+      simBody += "\r\n";
+      if (size == 0)
+        _chunked = false;
+    }
+    simWrites++;
+  }
+
+  void sendContent_P(PGM_P content, size_t size) { sendContent(content, size); }
+};
+
+#endif
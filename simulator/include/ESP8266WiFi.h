@@ -0,0 +1,42 @@
+// ESP8266WiFi stand-in for the host simulator: not connected unless a host tool sets simStatus
+#ifndef SIM_ESP8266WIFI_H
+#define SIM_ESP8266WIFI_H
+
+#include <Arduino.h>
+
+#define WL_CONNECTED 3
+#define ENC_TYPE_NONE 7
+
+class WiFiClient : public Stream
+{
+public:
+  void setNoDelay(bool) {}
+  uint8_t connected() { return 0; }
+};
+
+class ESP8266WiFiClass
+{
+public:
+  int simStatus;
+
+  ESP8266WiFiClass() : simStatus(0) {}
+
+  int status() { return simStatus; }
+  int hostByName(const char *, IPAddress &) { return 0; }
+  int32_t RSSI() { return -100; }
+  int32_t RSSI(int) { return -100; }
+  String SSID() { return ""; }
+  String SSID(int) { return ""; }
+  uint8_t encryptionType(int) { return ENC_TYPE_NONE; }
+  int scanNetworks() { return 0; }
+  IPAddress localIP() { return IPAddress(); }
+  IPAddress gatewayIP() { return IPAddress(); }
+  IPAddress subnetMask() { return IPAddress(); }
+  IPAddress dnsIP(int = 0) { return IPAddress(); }
+  uint8_t *macAddress(uint8_t *mac) { memset(mac, 0, 6); return mac; }
+  uint8_t *softAPmacAddress(uint8_t *mac) { memset(mac, 0, 6); return mac; }
+};
+
+extern ESP8266WiFiClass WiFi;
+
+#endif
@@ -0,0 +1,94 @@
+// SPIFFS stand-in for the host simulator: files are read from a host directory
+#ifndef SIM_FS_H
+#define SIM_FS_H
+
+#include <Arduino.h>
+#include <algorithm>
+#include <dirent.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Host directory used as the root of the file system
+extern const char *_simFsRoot;
+
+class File
+{
+private:
+  FILE *_f;
+
+public:
+  File(FILE *f = NULL) : _f(f) {}
+
+  operator bool() const { return _f != NULL; }
+
+  size_t size()
+  {
+    long p = ftell(_f);
+    fseek(_f, 0, SEEK_END);
+    long s = ftell(_f);
+    fseek(_f, p, SEEK_SET);
+    return s;
+  }
+
+  size_t read(uint8_t *buf, size_t size) { return fread(buf, 1, size, _f); }
+  void close() { if (_f) fclose(_f); _f = NULL; }
+};
+
+// Entries of a directory and its sub directories whose path starts with a prefix
+class Dir
+{
+private:
+  std::vector<std::string> _names;
+  size_t _next;
+
+public:
+  Dir() : _next(0) {}
+
+  void add(const std::string &name) { _names.push_back(name); }
+  void sort() { std::sort(_names.begin(), _names.end()); }
+  bool next() { return ++_next <= _names.size(); }
+  String fileName() { return _names[_next - 1].c_str(); }
+};
+
+class FSClass
+{
+private:
+  static std::string hostPath(const char *path) { return std::string(_simFsRoot) + path; }
+
+  static void scan(Dir &d, const std::string &dir, const std::string &prefix)
+  {
+    DIR *pd = opendir(hostPath(dir.c_str()).c_str());
+    if (!pd) return;
+
+    struct dirent *e;
+    while ((e = readdir(pd)) != NULL) {
+      std::string n = e->d_name;
+      if (n == "." || n == "..") continue;
+
+      std::string p = (dir == "/" ? "" : dir) + "/" + n;
+      if (e->d_type == DT_DIR)
+        scan(d, p, prefix);
+      else if (p.compare(0, prefix.size(), prefix) == 0)
+        d.add(p);
+    }
+    closedir(pd);
+  }
+
+public:
+  bool begin() { return true; }
+
+  File open(const String &path, const char *mode) { return File(fopen(hostPath(path.c_str()).c_str(), mode)); }
+
+  Dir openDir(const String &path)
+  {
+    Dir d;
+    scan(d, "/", path.c_str());
+    d.sort();
+    return d;
+  }
+};
+
+extern FSClass SPIFFS;
+
+#endif
@@ -0,0 +1,109 @@
+// NeoPixelBrightnessBus stand-in for the host simulator.
+// The virtual strip takes as long as a WS2812 strip to send its data
+// and hands every Show() to simStripShow(). As in the library, the colors
+// are scaled by the brightness when they are set, and rescaled with a loss
+// of precision when the brightness changes.
+#ifndef SIM_NEOPIXELBRIGHTNESSBUS_H
+#define SIM_NEOPIXELBRIGHTNESSBUS_H
+
+#include <NeoPixelBus.h>
+
+// Implemented by the simulator: leds as sent on the wire
+void simStripShow(const RgbColor *leds, uint16_t count);
+
+template <typename T_COLOR_FEATURE, typename T_METHOD> class NeoPixelBrightnessBus
+{
+private:
+  uint16_t _count;
+  RgbColor *_leds;
+  uint8_t _brightness;
+  uint64_t _showEnd;
+
+  // Like the library, colors are stored scaled by the brightness
+  static uint8_t scale(uint8_t v, uint8_t b)
+  {
+    return (v * (b + 1)) >> 8;
+  }
+
+  static uint8_t recover(uint8_t v, uint8_t b)
+  {
+    uint16_t r = ((uint16_t)v << 8) / (b + 1);
+    return r > 255 ? 255 : r;
+  }
+
+public:
+  NeoPixelBrightnessBus(uint16_t count, uint8_t pin)
+    : _count(count)
+    , _leds(new RgbColor[count])
+    , _brightness(255)
+    , _showEnd(0)
+  {
+    (void)pin;
+  }
+
+  ~NeoPixelBrightnessBus()
+  {
+    delete[] _leds;
+  }
+
+  void Begin() {}
+
+  // 30us by led at 800kHz plus 50us of reset
+  bool CanShow() const
+  {
+    return _simMicros >= _showEnd;
+  }
+
+  void Show()
+  {
+    _showEnd = _simMicros + (uint64_t)_count * 30 + 50;
+    simStripShow(_leds, _count);
+  }
+
+  uint16_t PixelCount() const
+  {
+    return _count;
+  }
+
+  void SetPixelColor(uint16_t i, RgbColor c)
+  {
+    if (i < _count)
+      _leds[i] = RgbColor(scale(c.R, _brightness), scale(c.G, _brightness), scale(c.B, _brightness));
+  }
+
+  RgbColor GetPixelColor(uint16_t i) const
+  {
+    if (i >= _count)
+      return RgbColor();
+
+    const RgbColor &c = _leds[i];
+    return RgbColor(recover(c.R, _brightness), recover(c.G, _brightness), recover(c.B, _brightness));
+  }
+
+  void ClearTo(RgbColor c)
+  {
+    for (uint16_t i = 0; i < _count; i++)
+      SetPixelColor(i, c);
+  }
+
+  // Like the library, the stored colors are rescaled and lose precision
+  void SetBrightness(uint8_t b)
+  {
+    if (b == _brightness)
+      return;
+
+    for (uint16_t i = 0; i < _count; i++) {
+      RgbColor c = GetPixelColor(i);
+      _leds[i] = RgbColor(scale(c.R, b), scale(c.G, b), scale(c.B, b));
+    }
+
+    _brightness = b;
+  }
+
+  uint8_t GetBrightness() const
+  {
+    return _brightness;
+  }
+};
+
+#endif
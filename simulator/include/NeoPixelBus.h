@@ -0,0 +1,87 @@
+// NeoPixelBus stand-in for the host simulator: colors and features
+#ifndef SIM_NEOPIXELBUS_H
+#define SIM_NEOPIXELBUS_H
+
+#include <Arduino.h>
+
+struct HslColor
+{
+  float H;
+  float S;
+  float L;
+
+  HslColor() {}
+  HslColor(float h, float s, float l) : H(h), S(s), L(l) {}
+};
+
+struct RgbColor
+{
+  uint8_t R;
+  uint8_t G;
+  uint8_t B;
+
+  RgbColor() : R(0), G(0), B(0) {}
+  RgbColor(uint8_t r, uint8_t g, uint8_t b) : R(r), G(g), B(b) {}
+  RgbColor(uint8_t v) : R(v), G(v), B(v) {}
+
+  // Same float conversion as the library
+  RgbColor(const HslColor &c)
+  {
+    float r, g, b;
+
+    if (c.S == 0.0f || c.L == 0.0f) {
+      r = g = b = c.L;
+    }
+    else {
+      float v2 = (c.L < 0.5f) ? c.L * (1.0f + c.S) : (c.L + c.S) - (c.L * c.S);
+      float v1 = 2.0f * c.L - v2;
+
+      r = calcColor(v1, v2, c.H + (1.0f / 3.0f));
+      g = calcColor(v1, v2, c.H);
+      b = calcColor(v1, v2, c.H - (1.0f / 3.0f));
+    }
+
+    R = (uint8_t)(r * 255.0f);
+    G = (uint8_t)(g * 255.0f);
+    B = (uint8_t)(b * 255.0f);
+  }
+
+  void Darken(uint8_t delta)
+  {
+    R = R > delta ? R - delta : 0;
+    G = G > delta ? G - delta : 0;
+    B = B > delta ? B - delta : 0;
+  }
+
+  void Lighten(uint8_t delta)
+  {
+    R = R < 255 - delta ? R + delta : 255;
+    G = G < 255 - delta ? G + delta : 255;
+    B = B < 255 - delta ? B + delta : 255;
+  }
+
+  uint8_t CalculateBrightness() const
+  {
+    return (uint8_t)(((uint16_t)R + (uint16_t)G + (uint16_t)B) / 3);
+  }
+
+  bool operator==(const RgbColor &o) const { return R == o.R && G == o.G && B == o.B; }
+  bool operator!=(const RgbColor &o) const { return !(*this == o); }
+
+private:
+  static float calcColor(float p, float q, float t)
+  {
+    if (t < 0.0f) t += 1.0f;
+    if (t > 1.0f) t -= 1.0f;
+
+    if (t < 1.0f / 6.0f) return p + (q - p) * 6.0f * t;
+    if (t < 0.5f) return q;
+    if (t < 2.0f / 3.0f) return p + ((q - p) * (2.0f / 3.0f - t) * 6.0f);
+    return p;
+  }
+};
+
+struct NeoGrbFeature {};
+struct NeoEsp8266AsyncUart1Ws2812Method {};
+
+#endif
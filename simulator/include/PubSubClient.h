@@ -0,0 +1,80 @@
+// PubSubClient stand-in for the host simulator: disconnected unless a host
+// tool sets simConnected, the last publication is kept
+#ifndef SIM_PUBSUBCLIENT_H
+#define SIM_PUBSUBCLIENT_H
+
+#include <ESP8266WiFi.h>
+
+#include <string>
+
+#define MQTT_CONNECTION_TIMEOUT     -4
+#define MQTT_CONNECTION_LOST        -3
+#define MQTT_CONNECT_FAILED         -2
+#define MQTT_DISCONNECTED           -1
+#define MQTT_CONNECTED               0
+#define MQTT_CONNECT_BAD_PROTOCOL    1
+#define MQTT_CONNECT_BAD_CLIENT_ID   2
+#define MQTT_CONNECT_UNAVAILABLE     3
+#define MQTT_CONNECT_BAD_CREDENTIALS 4
+#define MQTT_CONNECT_UNAUTHORIZED    5
+
+class PubSubClient
+{
+private:
+  unsigned int _expected;
+
+public:
+  bool simConnected;
+  std::string simTopic;     // last publication
+  std::string simPayload;
+  bool simRetained;
+  uint32_t simPublished;
+  bool simLengthError;      // a streamed publication did not match its announced length
+
+  PubSubClient(WiFiClient &) : _expected(0), simConnected(false), simRetained(false), simPublished(0), simLengthError(false) {}
+
+  PubSubClient &setServer(const char *, uint16_t) { return *this; }
+  bool connect(const char *) { return simConnected; }
+  bool connect(const char *, const char *, const char *) { return simConnected; }
+  void disconnect() { simConnected = false; }
+  bool connected() { return simConnected; }
+  int state() { return simConnected ? MQTT_CONNECTED : MQTT_DISCONNECTED; }
+  bool subscribe(const char *) { return simConnected; }
+
+  bool publish(const char *topic, const char *payload) { return publish(topic, payload, false); }
+
+  bool publish(const char *topic, const char *payload, bool retained)
+  {
+    if (!simConnected)
+      return false;
+    simTopic = topic;
+    simPayload = payload;
+    simRetained = retained;
+    simPublished++;
+    return true;
+  }
+
+  bool beginPublish(const char *topic, unsigned int length, bool retained)
+  {
+    if (!simConnected)
+      return false;
+    simTopic = topic;
+    simPayload.clear();
+    simRetained = retained;
+    _expected = length;
+    return true;
+  }
+
+  size_t write(uint8_t c) { simPayload += (char)c; return 1; }
+  size_t write(const uint8_t *buffer, size_t size) { simPayload.append((const char *)buffer, size); return size; }
+
+  int endPublish()
+  {
+    if (simPayload.size() != _expected)
+      simLengthError = true;
+    simPublished++;
+    return 1;
+  }
+};
+
+#endif
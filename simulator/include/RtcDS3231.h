@@ -0,0 +1,56 @@
+// RtcDS3231 stand-in for the host simulator: a running RTC
+// with a fixed temperature
+#ifndef SIM_RTCDS3231_H
+#define SIM_RTCDS3231_H
+
+#include <Arduino.h>
+
+#define countof(a) (sizeof(a) / sizeof(a[0]))
+
+// Seconds from 1970 to 2000
+#define SIM_RTC_EPOCH2000 946684800UL
+
+class RtcDateTime
+{
+private:
+  uint32_t _t; // seconds since 2000
+
+public:
+  RtcDateTime(uint32_t t = 0) : _t(t) {}
+  // Build time, the date is left out
+  RtcDateTime(const char *, const char *time) : _t(atoi(time) * 3600 + atoi(time + 3) * 60 + atoi(time + 6)) {}
+  void InitWithEpoch32Time(uint32_t t) { _t = t - SIM_RTC_EPOCH2000; }
+  uint32_t Epoch32Time() const { return _t + SIM_RTC_EPOCH2000; }
+  uint16_t Year() const { return 2000; }
+  uint8_t Month() const { return 1; }
+  uint8_t Day() const { return 1; }
+  uint8_t Hour() const { return (_t / 3600) % 24; }
+  uint8_t Minute() const { return (_t / 60) % 60; }
+  uint8_t Second() const { return _t % 60; }
+};
+
+class RtcTemperature
+{
+private:
+  float _c;
+
+public:
+  RtcTemperature(float c) : _c(c) {}
+  float AsFloatDegC() const { return _c; }
+};
+
+template <class T_WIRE_METHOD> class RtcDS3231
+{
+private:
+  RtcDateTime _dt;
+
+public:
+  RtcDS3231(T_WIRE_METHOD &) {}
+  void Begin() {}
+  bool GetIsRunning() { return true; }
+  RtcDateTime GetDateTime() { return _dt; }
+  void SetDateTime(const RtcDateTime &dt) { _dt = dt; }
+  RtcTemperature GetTemperature() { return RtcTemperature(21.5f); }
+};
+
+#endif
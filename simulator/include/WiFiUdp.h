@@ -0,0 +1,104 @@
+// WiFiUdp stand-in for the host simulator, on a non blocking host UDP socket
+#ifndef SIM_WIFIUDP_H
+#define SIM_WIFIUDP_H
+
+#include <Arduino.h>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+class WiFiUDP : public Stream
+{
+private:
+  int _fd;
+  struct sockaddr_in _to;
+  uint8_t _out[1024];
+  size_t _outSize;
+  uint8_t _in[1024];
+  int _inSize;
+  int _inRead;
+  struct sockaddr_in _from;
+
+public:
+  WiFiUDP() : _fd(-1), _outSize(0), _inSize(0), _inRead(0) {}
+  ~WiFiUDP() { stop(); }
+
+  uint8_t begin(uint16_t port)
+  {
+    struct sockaddr_in a;
+
+    stop();
+    _fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (_fd < 0)
+      return 0;
+
+    fcntl(_fd, F_SETFL, O_NONBLOCK);
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_port = htons(port);
+    if (bind(_fd, (struct sockaddr *)&a, sizeof(a)) < 0) {
+      stop();
+      return 0;
+    }
+    return 1;
+  }
+
+  void stop()
+  {
+    if (_fd >= 0)
+      close(_fd);
+    _fd = -1;
+  }
+
+  int beginPacket(IPAddress ip, uint16_t port)
+  {
+    uint32_t addr = ip;
+
+    memset(&_to, 0, sizeof(_to));
+    _to.sin_family = AF_INET;
+    _to.sin_port = htons(port);
+    _to.sin_addr.s_addr = addr;
+    _outSize = 0;
+    return 1;
+  }
+
+  size_t write(const uint8_t *p, size_t n)
+  {
+    if (_outSize + n > sizeof(_out))
+      n = sizeof(_out) - _outSize;
+    memcpy(_out + _outSize, p, n);
+    _outSize += n;
+    return n;
+  }
+
+  int endPacket()
+  {
+    return _fd >= 0 && sendto(_fd, _out, _outSize, 0, (struct sockaddr *)&_to, sizeof(_to)) == (ssize_t)_outSize;
+  }
+
+  int parsePacket()
+  {
+    socklen_t l = sizeof(_from);
+
+    _inRead = 0;
+    _inSize = _fd >= 0 ? recvfrom(_fd, _in, sizeof(_in), 0, (struct sockaddr *)&_from, &l) : -1;
+    if (_inSize < 0)
+      _inSize = 0;
+    return _inSize;
+  }
+
+  int read(uint8_t *p, size_t n)
+  {
+    int r = (int)n < _inSize - _inRead ? (int)n : _inSize - _inRead;
+    memcpy(p, _in + _inRead, r);
+    _inRead += r;
+    return r;
+  }
+
+  IPAddress remoteIP() { return IPAddress(_from.sin_addr.s_addr); }
+  uint16_t remotePort() { return ntohs(_from.sin_port); }
+};
+
+#endif
@@ -0,0 +1,152 @@
+// Wire stand-in for the host simulator: a simulated I2C bus with device models
+#ifndef SIM_WIRE_H
+#define SIM_WIRE_H
+
+#include <Arduino.h>
+
+#define SIM_WIRE_BUFFER 32
+
+// A device on the simulated bus
+class SimI2CDevice
+{
+public:
+  virtual ~SimI2CDevice() {}
+
+  // Bytes written by the master, false for a NACK
+  virtual bool receive(const uint8_t *data, int length) = 0;
+
+  // Bytes read by the master, the number sent
+  virtual int send(uint8_t *data, int length) = 0;
+};
+
+class TwoWire
+{
+private:
+  SimI2CDevice *_devices[128];
+  uint8_t _address;
+  uint8_t _buffer[SIM_WIRE_BUFFER];
+  int _length;
+  int _index;
+
+public:
+  uint32_t simTransactions;
+
+  TwoWire() : _address(0), _length(0), _index(0), simTransactions(0) { memset(_devices, 0, sizeof(_devices)); }
+
+  void begin(int, int) {}
+  void setClock(uint32_t) {}
+
+  // NULL removes the device, its transactions are then NACKed
+  void simAttach(uint8_t address, SimI2CDevice *device) { _devices[address & 0x7F] = device; }
+
+  void beginTransmission(uint8_t address)
+  {
+    _address = address & 0x7F;
+    _length = 0;
+  }
+
+  size_t write(uint8_t b)
+  {
+    if (_length >= SIM_WIRE_BUFFER)
+      return 0;
+    _buffer[_length++] = b;
+    return 1;
+  }
+
+  // 0 on success, 2 for a NACK on the address, 3 on the data
+  uint8_t endTransmission(bool = true)
+  {
+    simTransactions++;
+    if (!_devices[_address])
+      return 2;
+    return _devices[_address]->receive(_buffer, _length) ? 0 : 3;
+  }
+
+  uint8_t requestFrom(uint8_t address, uint8_t length)
+  {
+    simTransactions++;
+    _index = 0;
+    _length = 0;
+    SimI2CDevice *d = _devices[address & 0x7F];
+    if (d)
+      _length = d->send(_buffer, length < SIM_WIRE_BUFFER ? length : SIM_WIRE_BUFFER);
+    return _length;
+  }
+
+  int available() { return _length - _index; }
+  int read() { return _index < _length ? _buffer[_index++] : -1; }
+};
+
+extern TwoWire Wire;
+
+// DS3231 registers behind an auto incremented pointer
+class SimDS3231 : public SimI2CDevice
+{
+public:
+  uint8_t reg[0x13];
+  uint8_t pointer;
+
+  SimDS3231(float celsius = 21.5f) : pointer(0)
+  {
+    memset(reg, 0, sizeof(reg));
+    reg[0x0E] = 0x1C;
+    setTemperature(celsius);
+  }
+
+  // 0.25 degree resolution, two's complement
+  void setTemperature(float celsius)
+  {
+    int q = (int)(celsius * 4 + (celsius < 0 ? -0.5f : 0.5f));
+    reg[0x11] = (uint8_t)(q >> 2);
+    reg[0x12] = (uint8_t)((q & 3) << 6);
+  }
+
+  bool receive(const uint8_t *data, int length)
+  {
+    if (length < 1 || data[0] >= sizeof(reg))
+      return false;
+    pointer = data[0];
+    for (int i = 1; i < length; i++)
+      reg[pointer++ % sizeof(reg)] = data[i];
+    return true;
+  }
+
+  int send(uint8_t *data, int length)
+  {
+    for (int i = 0; i < length; i++)
+      data[i] = reg[pointer++ % sizeof(reg)];
+    return length;
+  }
+};
+
+// BH1750 : measures once a mode is set, powered down at start
+class SimBH1750 : public SimI2CDevice
+{
+public:
+  uint8_t mode;
+  float lux;
+
+  SimBH1750(float l = 100) : mode(0), lux(l) {}
+
+  bool receive(const uint8_t *data, int length)
+  {
+    if (length != 1)
+      return false;
+    mode = data[0];
+    return true;
+  }
+
+  int send(uint8_t *data, int length)
+  {
+    // Powered down : no data
+    if (mode < 0x10 || length < 2)
+      return 0;
+
+    uint16_t raw = (uint16_t)(lux * 1.2f + 0.5f);
+    data[0] = raw >> 8;
+    data[1] = raw & 0xFF;
+    return 2;
+  }
+};
+
+#endif
@@ -0,0 +1,80 @@
+// lwIP DNS stand-in for the host simulator: addresses are answered at once,
+// names are resolved by the host when simDnsHandle() is called, like the
+// asynchronous answers of lwIP
+#ifndef SIM_LWIP_DNS_H
+#define SIM_LWIP_DNS_H
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <netdb.h>
+#include <arpa/inet.h>
+
+typedef int8_t err_t;
+#define ERR_OK 0
+#define ERR_INPROGRESS -5
+#define ERR_ARG -16
+
+struct ip_addr_t
+{
+  uint32_t addr;
+};
+
+typedef void (*dns_found_callback)(const char *name, const ip_addr_t *ipaddr, void *arg);
+
+struct SimDnsQuery
+{
+  std::string name;
+  dns_found_callback found;
+  void *arg;
+};
+
+inline SimDnsQuery &simDnsQuery()
+{
+  static SimDnsQuery query;
+  return query;
+}
+
+inline err_t dns_gethostbyname(const char *hostname, ip_addr_t *addr, dns_found_callback found, void *arg)
+{
+  struct in_addr a;
+
+  if (!hostname || !*hostname)
+    return ERR_ARG;
+
+  if (inet_pton(AF_INET, hostname, &a) == 1) {
+    addr->addr = a.s_addr;
+    return ERR_OK;
+  }
+
+  simDnsQuery().name = hostname;
+  simDnsQuery().found = found;
+  simDnsQuery().arg = arg;
+  return ERR_INPROGRESS;
+}
+
+// Answer the pending query
+inline void simDnsHandle()
+{
+  SimDnsQuery q = simDnsQuery();
+  struct addrinfo hints, *res = NULL;
+
+  if (q.name.empty())
+    return;
+  simDnsQuery().name.clear();
+
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_DGRAM;
+
+  if (getaddrinfo(q.name.c_str(), NULL, &hints, &res) == 0 && res) {
+    ip_addr_t addr;
+    addr.addr = ((struct sockaddr_in *)res->ai_addr)->sin_addr.s_addr;
+    freeaddrinfo(res);
+    q.found(q.name.c_str(), &addr, q.arg);
+  }
+  else
+    q.found(q.name.c_str(), NULL, q.arg);
+}
+
+#endif
@@ -0,0 +1,159 @@
+// Host micro-benchmarks of StaticVector against the linked list it replaced
+//
+//   make bench
+
+#include <Arduino.h>
+#include "list.h"
+
+#include <chrono>
+
+uint64_t _simMicros = 0;
+uint32_t _simRandom = 1;
+
+// The former cl_Lst : one heap node by element, indexing walks the list
+template <class T> class LinkedList
+{
+private:
+  struct Node
+  {
+    Node *prev;
+    Node *next;
+    T data;
+  };
+
+  Node *_first;
+  Node *_last;
+  int _size;
+
+  Node *node(int index)
+  {
+    Node *n = _first;
+    for (int i = 0; i < index && i < _size; ++i)
+      if (n && n->next)
+        n = n->next;
+    return n;
+  }
+
+public:
+  LinkedList() : _first(NULL), _last(NULL), _size(0) {}
+  ~LinkedList() { clear(); }
+
+  int push_back(const T &val)
+  {
+    Node *n = new Node;
+    n->prev = _last;
+    n->next = NULL;
+    n->data = val;
+    if (_last) _last->next = n; else _first = n;
+    _last = n;
+    return _size++;
+  }
+
+  void remove(int index)
+  {
+    if (index < 0 || index >= _size) return;
+    Node *n = node(index);
+    if (n->next) n->next->prev = n->prev; else _last = n->prev;
+    if (n->prev) n->prev->next = n->next; else _first = n->next;
+    delete n;
+    --_size;
+  }
+
+  void clear()
+  {
+    while (_first) {
+      Node *n = _first;
+      _first = n->next;
+      delete n;
+    }
+    _last = NULL;
+    _size = 0;
+  }
+
+  T &operator[](int index) { return node(index)->data; }
+  int size() { return _size; }
+};
+
+struct BenchPixel
+{
+  int e;
+  int c;
+  int r;
+  uint32_t color;
+};
+
+static uint64_t hostNanos()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static volatile uint32_t _sink;
+
+// Index the last element of an 8 entries list, like _modeList[_modeIndex] each loop pass
+template <class L> static double benchIndex(L &l, int loops)
+{
+  for (int i = 0; i < 8; i++)
+    l.push_back(i);
+
+  uint64_t t = hostNanos();
+  uint32_t s = 0;
+  for (int i = 0; i < loops; i++)
+    s += l[7 - (i & 1)];
+  t = hostNanos() - t;
+
+  _sink = s;
+  return (double)t / loops;
+}
+
+// Fill a list with the 124 pixels, then pick and remove a random one until it is empty,
+// like the Blink animation
+template <class L> static double benchBlink(L &l, int loops, void (*removeAt)(L &, int))
+{
+  uint64_t t = hostNanos();
+  uint32_t s = 0;
+
+  for (int i = 0; i < loops; i++) {
+    for (int n = 0; n < 124; n++) {
+      BenchPixel p = { -1, n % 12, n / 12, (uint32_t)n };
+      l.push_back(p);
+    }
+
+    while (l.size()) {
+      int idx = random(l.size());
+      s += l[idx].color;
+      removeAt(l, idx);
+    }
+  }
+  t = hostNanos() - t;
+
+  _sink = s;
+  return (double)t / loops;
+}
+
+static void removeLinked(LinkedList<BenchPixel> &l, int i) { l.remove(i); }
+static void removeStatic(StaticVector<BenchPixel, 124> &l, int i) { l.swap_remove(i); }
+
+int main()
+{
+  const int indexLoops = 10000000;
+  const int blinkLoops = 20000;
+
+  LinkedList<int> li;
+  StaticVector<int, 8> vi;
+  double tli = benchIndex(li, indexLoops);
+  double tvi = benchIndex(vi, indexLoops);
+
+  randomSeed(1);
+  LinkedList<BenchPixel> lb;
+  double tlb = benchBlink(lb, blinkLoops, removeLinked);
+
+  randomSeed(1);
+  StaticVector<BenchPixel, 124> vb;
+  double tvb = benchBlink(vb, blinkLoops, removeStatic);
+
+  printf("%-34s %12s %12s %8s\n", "", "linked list", "StaticVector", "ratio");
+  printf("%-34s %9.2f ns %9.2f ns %7.1fx\n", "index 8 entries (by access)", tli, tvi, tli / tvi);
+  printf("%-34s %9.0f ns %9.0f ns %7.1fx\n", "fill + random remove 124 (by run)", tlb, tvb, tlb / tvb);
+
+  return 0;
+}
@@ -0,0 +1,305 @@
+// Host check of the NTP client and of the disciplined clock of NTP.h against
+// a local stand-in server on a loopback UDP port: offset and round trip, best
+// sample, lost and bogus replies, retries with backoff, the time spent in each
+// handle() call, slewing and the oscillator drift estimation
+//
+//   make check
+
+#define NTP_PORT 12323
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <ESP8266WebServer.h>
+#include <ESP8266HTTPUpdateServer.h>
+#include <WiFiUdp.h>
+#include <lwip/dns.h>
+#include <EEPROM.h>
+#include <DNSServer.h>
+#include <Wire.h>
+#include <RtcDS3231.h>
+#include <PubSubClient.h>
+
+#include "global.h"
+#include "list.h"
+#include "Perf.h"
+#include "RTC.h"
+#include "NTP.h"
+
+#include <chrono>
+#include <vector>
+#include <time.h>
+
+uint64_t _simMicros = 0;
+uint32_t _simRandom = 1;
+
+HardwareSerial Serial;
+EspClass ESP;
+ESP8266WiFiClass WiFi;
+EEPROMClass EEPROM;
+TwoWire Wire;
+
+static uint64_t hostNanos()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// CPU time of the thread, the host scheduler does not count
+static uint64_t cpuNanos()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+  return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+uint32_t EspClass::getCycleCount()
+{
+  return (uint32_t)(hostNanos() * 80 / 1000);
+}
+
+// NTP server answering after a delay, with a clock ahead of the local one
+class StandInServer
+{
+public:
+  enum Mode { Answer, Drop, Bogus };
+
+  Mode mode;
+  std::vector<int> delays;         // ms before each reply, cycled
+  std::vector<uint64_t> requests;  // millis64() of each request
+
+private:
+  struct Pending
+  {
+    uint64_t sendAt;
+    int64_t t2;
+    uint8_t packet[NTP_PACKET_SIZE];
+    struct sockaddr_in to;
+  };
+
+  int _fd;
+  int64_t _base;
+  int64_t _ppm;
+  uint64_t _ppmFrom;
+  std::vector<Pending> _pending;
+
+public:
+  StandInServer() : mode(Answer), _fd(-1), _base(0), _ppm(0), _ppmFrom(0) {}
+
+  // True time, the simulated oscillator is off by _ppm
+  int64_t now()
+  {
+    uint64_t m = millis64();
+    return _base + (int64_t)m + (int64_t)(m - _ppmFrom) * _ppm / 1000000;
+  }
+
+  void shift(int64_t ms) { _base += ms; }
+  void setDrift(int64_t ppm) { _base = now() - (int64_t)millis64(); _ppm = ppm; _ppmFrom = millis64(); }
+
+  bool begin()
+  {
+    struct sockaddr_in a;
+
+    _fd = socket(AF_INET, SOCK_DGRAM, 0);
+    fcntl(_fd, F_SETFL, O_NONBLOCK);
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_port = htons(NTP_PORT);
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return bind(_fd, (struct sockaddr *)&a, sizeof(a)) == 0;
+  }
+
+  void sync()
+  {
+    _base = _clock.nowMillis() - (int64_t)millis64();
+  }
+
+  // No request can be in flight while the client is idle
+  bool idle() { return _pending.empty() && _ntp.getState() == NTPClient::Idle; }
+
+  void handle()
+  {
+    Pending p;
+    socklen_t l = sizeof(p.to);
+
+    while (recvfrom(_fd, p.packet, NTP_PACKET_SIZE, 0, (struct sockaddr *)&p.to, &l) == NTP_PACKET_SIZE) {
+      int delay = delays.empty() ? 0 : delays[requests.size() % delays.size()];
+      requests.push_back(millis64());
+      if (mode == Drop)
+        continue;
+
+      // Half of the delay on the way in, half on the way out
+      p.sendAt = millis64() + delay;
+      p.t2 = now() + delay / 2;
+      memcpy(p.packet + 24, p.packet + 40, 8);
+      p.packet[0] = (0 << 6) | (4 << 3) | 4;   // LI, Version, Mode server
+      p.packet[1] = mode == Bogus ? 0 : 2;     // Stratum
+      if (mode == Bogus)
+        p.packet[24] ^= 0xFF;
+      _pending.push_back(p);
+    }
+
+    for (size_t i = 0; i < _pending.size(); i++) {
+      Pending &q = _pending[i];
+      if (millis64() < q.sendAt)
+        continue;
+      ntpWriteMillis(q.packet + 32, q.t2);
+      ntpWriteMillis(q.packet + 40, q.t2);
+      sendto(_fd, q.packet, NTP_PACKET_SIZE, 0, (struct sockaddr *)&q.to, sizeof(q.to));
+      _pending.erase(_pending.begin() + i--);
+    }
+  }
+};
+
+static StandInServer _standIn;
+static uint64_t _maxHandleNanos = 0;
+static int64_t _maxClockStep = 0;      // us, largest clock move between two loop passes
+static int64_t _maxRollover = 0;       // ms, largest error of the second changes
+static bool _backwards = false;
+
+// Simulated ms with the loop of the sketch
+static void run(uint32_t ms)
+{
+  for (uint32_t i = 0; i < ms; i++) {
+    int64_t c = _clock.nowMicros();
+    unsigned long second = _timestamp;
+
+    _simMicros += 1000;
+    simDnsHandle();
+    if (!_standIn.idle())
+      _standIn.handle();
+
+    // The idle passes only compare two times, the others are measured
+    if (_ntp.getState() == NTPClient::Idle)
+      handleNTPRequest();
+    else {
+      uint64_t t = cpuNanos();
+      handleNTPRequest();
+      t = cpuNanos() - t;
+      if (t > _maxHandleNanos)
+        _maxHandleNanos = t;
+    }
+
+    handleISRsecondTick();
+
+    int64_t step = _clock.nowMicros() - c;
+    _backwards |= step < 0;
+    if (step > _maxClockStep)
+      _maxClockStep = step;
+
+    if (second != _timestamp) {
+      int64_t e = _standIn.now() % 1000;
+      if (e > 500)
+        e -= 1000;
+      if (llabs(e) > _maxRollover)
+        _maxRollover = llabs(e);
+    }
+  }
+}
+
+static int fail(const char *what)
+{
+  fprintf(stderr, "NTP check failed : %s\n", what);
+  return 1;
+}
+
+int main()
+{
+  if (!_standIn.begin())
+    return fail("cannot bind the stand-in server");
+
+  WiFi.simStatus = WL_CONNECTED;
+  _config.Update_Time_Via_NTP_Every = 3600;
+  _clock.setTime(1500000000UL);
+  run(1000);
+  _standIn.sync();
+
+  // Two servers, the second answers faster and wins
+  _config.ntpServerName = "127.0.0.1 localhost";
+  _standIn.shift(5250);
+  _standIn.delays = { 40, 10 };
+  getNTPtime();
+  run(500);
+
+  const NTPSample &s = _ntp.getLastSample();
+  if (_standIn.requests.size() != 2 || !s.valid || s.server != "localhost")
+    return fail("best of two servers");
+  if (s.offset < 5248 || s.offset > 5252 || s.delay < 9 || s.delay > 11)
+    return fail("offset or delay");
+  if (llabs(_standIn.now() - _clock.nowMillis()) > 2)
+    return fail("clock not stepped");
+  printf("Offset %dms, delay %dms from %s\n", s.offset, s.delay, s.server.c_str());
+
+  // Unknown name, then a lost reply, then an answer
+  _standIn.shift(-2000);
+  _standIn.requests.clear();
+  _standIn.delays = { 5 };
+  _config.ntpServerName = "ntp.invalid,127.0.0.1";
+  getNTPtime();
+  run(100);
+  if (_ntp.getState() != NTPClient::Idle || llabs(_standIn.now() - _clock.nowMillis()) > 2)
+    return fail("skip an unknown server");
+
+  // Lost and bogus replies : the round is retried after 4s, 8s, 16s
+  _standIn.requests.clear();
+  _standIn.mode = StandInServer::Drop;
+  _config.ntpServerName = "127.0.0.1";
+  getNTPtime();
+  run(6000);
+  _standIn.mode = StandInServer::Bogus;
+  run(30000);
+  if (_standIn.requests.size() != 4)
+    return fail("retries");
+  for (int i = 1; i < 4; i++) {
+    uint64_t interval = _standIn.requests[i] - _standIn.requests[i - 1];
+    uint64_t expected = NTPTIMEOUT + (NTPRETRYMIN << (i - 1));
+    if (interval < expected - 2 || interval > expected + 2)
+      return fail("backoff");
+  }
+  printf("Retries after %llu, %llu and %llu ms\n",
+         (unsigned long long)(_standIn.requests[1] - _standIn.requests[0]),
+         (unsigned long long)(_standIn.requests[2] - _standIn.requests[1]),
+         (unsigned long long)(_standIn.requests[3] - _standIn.requests[2]));
+
+  // Answered again, then the next round after the update period
+  _standIn.mode = StandInServer::Answer;
+  run(40000);
+  if (_ntp.getRetryDelay() != NTPRETRYMIN || _standIn.requests.size() != 5)
+    return fail("recover");
+  run(3600 * 1000);
+  if (_standIn.requests.size() != 6)
+    return fail("update period");
+
+  printf("Longest handle() %.1f us of CPU\n", _maxHandleNanos / 1000.0);
+  if (_maxHandleNanos > 1000000)
+    return fail("handle() takes more than 1ms");
+
+  // Small offsets are slewed, not stepped
+  _standIn.shift(300);
+  _maxClockStep = 0;
+  _backwards = false;
+  run(3900 * 1000);
+  if (_maxClockStep > 1005 || _backwards || llabs(_standIn.now() - _clock.nowMillis()) > 2)
+    return fail("slew");
+  printf("Offset of 300ms slewed, largest clock step %lld us by ms\n", (long long)_maxClockStep);
+
+  // The oscillator runs 80 ppm slow : the drift is estimated from the hourly offsets
+  _standIn.setDrift(80);
+  run(4 * 3600 * 1000);
+  _maxRollover = 0;
+  run(3600 * 1000);
+  int32_t drift = _clock.getDrift();
+  if (drift < 78000 || drift > 82000 || _backwards)
+    return fail("drift");
+  if (_maxRollover > 3)
+    return fail("second changes");
+  printf("Drift %.1f ppm, last offset %d ms, seconds change within %lld ms\n", drift / 1000.0, _clock.getOffset(), (long long)_maxRollover);
+
+  // A time change of 3 hours is stepped and leaves the drift alone
+  _standIn.shift(3 * 3600 * 1000);
+  run(3 * 3600 * 1000);
+  if (llabs(_standIn.now() - _clock.nowMillis()) > 2 || llabs(_clock.getDrift() - drift) > 2000)
+    return fail("3 hours step");
+  printf("Offset of 3 hours stepped, drift %.1f ppm\n", _clock.getDrift() / 1000.0);
+
+  printf("NTP client checked\n");
+  return 0;
+}
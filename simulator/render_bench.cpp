@@ -0,0 +1,316 @@
+// Host micro-benchmarks of the rendering: cost by frame of the led strip
+// refresh on each led configuration, against the refresh it replaced, and
+// cost by composited frame of the layers and of the animations, cost of the
+// hue kernels against the float HslColor conversion
+//
+//   make bench
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <ESP8266WebServer.h>
+#include <ESP8266HTTPUpdateServer.h>
+#include <WiFiUdp.h>
+#include <lwip/dns.h>
+#include <EEPROM.h>
+#include <FS.h>
+#include <DNSServer.h>
+#include <NeoPixelBus.h>
+#include <NeoPixelBrightnessBus.h>
+#include <Wire.h>
+#include <RtcDS3231.h>
+#include <PubSubClient.h>
+
+#include "global.h"
+#include "mqtt_topics.h"
+#include "list.h"
+#include "Color.h"
+#include "Perf.h"
+#include "RTC.h"
+#include "NTP.h"
+#include "LightSensor.h"
+#include "Sensors.h"
+#include "LedStrip.h"
+
+#include <chrono>
+
+uint64_t _simMicros = 0;
+uint32_t _simRandom = 1;
+
+HardwareSerial Serial;
+EspClass ESP;
+ESP8266WiFiClass WiFi;
+EEPROMClass EEPROM;
+FSClass SPIFFS;
+const char *_simFsRoot = "data";
+TwoWire Wire;
+
+static uint64_t hostNanos()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t EspClass::getCycleCount()
+{
+  return (uint32_t)(hostNanos() * 80 / 1000);
+}
+
+static uint32_t _shows = 0;
+
+void simStripShow(const RgbColor *, uint16_t)
+{
+  _shows++;
+}
+
+// The former cl_Lst, indexing walks the list
+template <class T> class LinkedList
+{
+private:
+  struct Node
+  {
+    Node *next;
+    T data;
+  };
+
+  Node *_first;
+  int _size;
+
+public:
+  LinkedList() : _first(NULL), _size(0) {}
+
+  void push_back(const T &val)
+  {
+    Node **p = &_first;
+    while (*p)
+      p = &(*p)->next;
+    *p = new Node;
+    (*p)->next = NULL;
+    (*p)->data = val;
+    _size++;
+  }
+
+  T &operator[](int index)
+  {
+    Node *n = _first;
+    for (int i = 0; i < index && n->next; ++i)
+      n = n->next;
+    return n->data;
+  }
+};
+
+// The former refresh: all the leds are cleared and written again, with the
+// virtual calls of the led configuration for each pixel
+static void formerRefresh(MyNeoPixelBrightnessBus &strip, LinkedList<LedConfiguration *> &configs, int index, const PixelsArray &pa)
+{
+  strip.ClearTo(RgbColor(0, 0, 0));
+
+  for (int r = 0; r < NROW; r++) {
+    for (int c = 0; c < NCOL; c++) {
+      int n = PixelsArray::index(r, c);
+      const uint8_t *i = configs[index]->getLedsMatrixId(r, c);
+
+      if (!pa.isDisplayed(n)) continue;
+
+      for (int l = 0; l < configs[index]->ledsByPixelForMatrix(); l++)
+        strip.SetPixelColor(i[l], pa.color(n));
+    }
+  }
+
+  for (int e = 0; e < NEDGE; e++) {
+    int n = PixelsArray::edgeIndex(e);
+    const uint8_t *i = configs[index]->getLedsEdgeId(e);
+
+    if (!pa.isDisplayed(n)) continue;
+
+    for (int l = 0; l < configs[index]->ledsByPixelForEdges(); l++)
+      strip.SetPixelColor(i[l], pa.color(n));
+  }
+
+  strip.Show();
+}
+
+// Access to the frame pipeline and the refresh of the led strip
+class BenchStrip : public MyLedStripAnimator
+{
+public:
+  // Refresh of a new frame of the mode, in ns
+  uint64_t refreshFrame(const PixelsArray &frame)
+  {
+    _pixels.back() = frame;
+    _pixels.commit();
+
+    // The strip is done sending the previous frame
+    _simMicros += 20000;
+
+    uint64_t t = hostNanos();
+    refresh(&_pixels);
+    return hostNanos() - t;
+  }
+
+  // Blend of the enabled layers, all of them changed, in ns
+  uint64_t composeFrame()
+  {
+    for (int i = 0; i < NLAYERS; i++)
+      _compositor.layer(i).dirty = true;
+
+    uint64_t t = hostNanos();
+    _compositor.compose();
+    return hostNanos() - t;
+  }
+
+  // One loop pass of the mode and of the animation, in ns for the animation and the blend
+  uint64_t animatePass()
+  {
+    frameTick();
+    handleMode();
+
+    uint64_t t = hostNanos();
+    handleAnimation();
+    t = hostNanos() - t;
+
+    refresh(&_animatedPixels);
+    return t;
+  }
+
+  PixelsCompositor &compositor() { return _compositor; }
+};
+
+BenchStrip _bench;
+
+// A clock face: about 30 lit pixels, one word of 4 pixels changes between two frames
+static void clockFrame(PixelsArray &pa, int frame)
+{
+  pa.clear();
+  for (int n = 0; n < 30; n++)
+    pa.set(n * 3, RgbColor(255, 255, 255));
+  for (int n = 0; n < 4; n++)
+    pa.set(100 + (frame & 1) * 4 + n, RgbColor(255, 255, 255));
+}
+
+// Every pixel lit in a new color, like the rainbow
+static void fullFrame(PixelsArray &pa, int frame)
+{
+  for (int n = 0; n < NPIXELS; n++)
+    pa.set(n, hue8ToRgb(frame + n));
+}
+
+// Keeps the results of the kernels alive
+static volatile uint8_t _sink;
+
+int main()
+{
+  const int frames = 20000;
+  LedConfigurationList *pc = _bench.getLedConfigurationList();
+
+  LinkedList<LedConfiguration *> configs;
+  for (int i = 0; i < pc->size(); i++)
+    configs.push_back((*pc)[i]);
+
+  PixelsArray word[2];
+  clockFrame(word[0], 0);
+  clockFrame(word[1], 1);
+
+  printf("Refresh by frame (host ns) %21s  %21s %6s %9s\n", "one word changed", "all pixels changed", "leds", "wire");
+  printf("%-26s %10s %10s  %10s %10s\n", "", "former", "diff", "former", "diff");
+
+  for (int c = 0; c < pc->size(); c++) {
+    _config.ledConfig = c;
+    _bench.begin();
+    _bench.setOutputMode(OutputDirect);
+    _bench.setBrightness(255);
+
+    int leds = (*pc)[c]->ledsNumber();
+    MyNeoPixelBrightnessBus strip(leds, 0);
+
+    uint64_t t = hostNanos();
+    for (int f = 0; f < frames; f++)
+      formerRefresh(strip, configs, c, word[f & 1]);
+    double formerWord = (double)(hostNanos() - t) / frames;
+
+    uint64_t total = 0;
+    for (int f = 0; f < frames; f++)
+      total += _bench.refreshFrame(word[f & 1]);
+    double word1 = (double)total / frames;
+
+    PixelsArray full;
+    fullFrame(full, 0);
+    t = hostNanos();
+    for (int f = 0; f < frames; f++)
+      formerRefresh(strip, configs, c, full);
+    double formerFull = (double)(hostNanos() - t) / frames;
+
+    total = 0;
+    for (int f = 0; f < frames; f++) {
+      fullFrame(full, f);
+      total += _bench.refreshFrame(full);
+    }
+    double all = (double)total / frames;
+
+    printf("  %-24s %10.0f %10.0f  %10.0f %10.0f %6d %6d us\n", (*pc)[c]->getName(), formerWord, word1, formerFull, all, leds, leds * 30 + 50);
+  }
+
+  // Composition of a full background, the clock face and a full layer above it
+  _config.ledConfig = 0;
+  _bench.begin();
+  _clock.setTime(1500000000UL - (1500000000UL % 86400) + 10 * 3600 + 27 * 60);
+  handleISRsecondTick();
+  _bench.setMode(1);
+  _bench.setAnimation(0);
+  _bench.animatePass();
+
+  static const char *blends[] = { "replace", "add", "alpha", "multiply", "mask" };
+  printf("Composited frame, 3 layers (host ns)\n");
+  printf("  %-24s %10s\n", "top layer blend", "by frame");
+
+  for (int b = BlendReplace; b <= BlendMask; b++) {
+    PixelsArray full;
+    fullFrame(full, 0);
+    _bench.compositor().enableLayer(LayerBackground, BlendReplace).pixels = full;
+    _bench.compositor().enableLayer(LayerEffect, (LayerBlendMode)b, 128).pixels = full;
+
+    uint64_t total = 0;
+    for (int f = 0; f < frames; f++)
+      total += _bench.composeFrame();
+    printf("  %-24s %10.0f\n", blends[b], (double)total / frames);
+  }
+
+  // Animations over the clock face, 10 simulated seconds
+  LedStripAnimationList *pa = _bench.getAnimationsList();
+  printf("Animation, 10 s (host ns)  %10s %10s %10s\n", "by pass", "frames", "by frame");
+
+  for (int a = 0; a < pa->size(); a++) {
+    _bench.setAnimation(a);
+    uint32_t produced = _bench.getAnimationFramesStats().produced;
+
+    uint64_t total = 0;
+    for (int i = 0; i < 10000; i++) {
+      handleISRsecondTick();
+      total += _bench.animatePass();
+      _simMicros += 1000;
+    }
+
+    produced = _bench.getAnimationFramesStats().produced - produced;
+    printf("  %-24s %10.0f %10u %10.0f\n", (*pa)[a]->getName(), total / 10000.0, produced, (double)total / (produced ? produced : 1));
+  }
+
+  // Hue kernels, by color over the whole range
+  const int hues = 65536 * 16;
+  printf("Hue to RGB (host ns)         %10s\n", "by color");
+
+  uint64_t t = hostNanos();
+  for (int i = 0; i < hues; i++)
+    _sink = _sink + hue8ToRgb(i).G;
+  printf("  %-24s %10.2f\n", "hue8ToRgb", (double)(hostNanos() - t) / hues);
+
+  t = hostNanos();
+  for (int i = 0; i < hues; i++)
+    _sink = _sink + hue16ToRgb(i).G;
+  printf("  %-24s %10.2f\n", "hue16ToRgb", (double)(hostNanos() - t) / hues);
+
+  t = hostNanos();
+  for (int i = 0; i < hues; i++)
+    _sink = _sink + RgbColor(HslColor((i & 0xFFFF) / 65536.0f, 1.0f, 0.5f)).G;
+  printf("  %-24s %10.2f\n", "HslColor (float)", (double)(hostNanos() - t) / hues);
+  printf("  floats are converted in hardware on the host, in software on the ESP8266\n");
+
+  return 0;
+}
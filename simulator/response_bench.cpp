@@ -0,0 +1,244 @@
+// Host measure of the heap use of a values page: the former String
+// concatenations against the ResponseWriter, on the network settings page.
+// The body is measured apart from the headers, the writer must build it
+// without any allocation.
+//
+//   make bench
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <ESP8266WebServer.h>
+#include <ESP8266HTTPUpdateServer.h>
+#include <WiFiUdp.h>
+#include <lwip/dns.h>
+#include <EEPROM.h>
+#include <DNSServer.h>
+#include <Wire.h>
+#include <RtcDS3231.h>
+#include <PubSubClient.h>
+
+#include "global.h"
+#include "list.h"
+#include "Perf.h"
+#include "RTC.h"
+#include "NTP.h"
+#include "ResponseWriter.h"
+
+#include <chrono>
+#include <new>
+#include <stdlib.h>
+
+uint64_t _simMicros = 0;
+uint32_t _simRandom = 1;
+
+HardwareSerial Serial;
+EspClass ESP;
+ESP8266WiFiClass WiFi;
+EEPROMClass EEPROM;
+TwoWire Wire;
+
+uint32_t EspClass::getCycleCount()
+{
+  return 0;
+}
+
+// Heap accounting : every block carries its size
+static size_t _heapLive = 0;
+static size_t _heapPeak = 0;
+static uint32_t _heapAllocs = 0;
+
+void *operator new(size_t size)
+{
+  size_t *p = (size_t *)malloc(size + sizeof(size_t) * 2);
+  if (!p)
+    throw std::bad_alloc();
+  p[0] = size;
+  _heapLive += size;
+  _heapAllocs++;
+  if (_heapLive > _heapPeak) _heapPeak = _heapLive;
+  return p + 2;
+}
+
+void operator delete(void *ptr) noexcept
+{
+  if (!ptr)
+    return;
+  size_t *p = (size_t *)ptr - 2;
+  _heapLive -= p[0];
+  free(p);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+  operator delete(ptr);
+}
+
+// Heap use while the body is built, the headers and the server are left out
+static size_t _bodyPeak;
+static uint32_t _bodyAllocs;
+static size_t _bodyBase;
+static uint32_t _bodyAllocsBase;
+
+static void bodyBegin()
+{
+  _heapPeak = _bodyBase = _heapLive;
+  _bodyAllocsBase = _heapAllocs;
+}
+
+static void bodyEnd()
+{
+  _bodyPeak = _heapPeak - _bodyBase;
+  _bodyAllocs = _heapAllocs - _bodyAllocsBase;
+}
+
+static uint64_t hostNanos()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// The former page
+static void formerNetworkValues()
+{
+  bodyBegin();
+  String values ="";
+
+  values += "ssid|" + (String) _config.ssid + "|input\n";
+  values += "password|" +  (String) _config.password + "|input\n";
+  values += "ip_0|" +  (String) _config.IP[0] + "|input\n";
+  values += "ip_1|" +  (String) _config.IP[1] + "|input\n";
+  values += "ip_2|" +  (String) _config.IP[2] + "|input\n";
+  values += "ip_3|" +  (String) _config.IP[3] + "|input\n";
+  values += "nm_0|" +  (String) _config.Netmask[0] + "|input\n";
+  values += "nm_1|" +  (String) _config.Netmask[1] + "|input\n";
+  values += "nm_2|" +  (String) _config.Netmask[2] + "|input\n";
+  values += "nm_3|" +  (String) _config.Netmask[3] + "|input\n";
+  values += "gw_0|" +  (String) _config.Gateway[0] + "|input\n";
+  values += "gw_1|" +  (String) _config.Gateway[1] + "|input\n";
+  values += "gw_2|" +  (String) _config.Gateway[2] + "|input\n";
+  values += "gw_3|" +  (String) _config.Gateway[3] + "|input\n";
+  values += "dn_0|" + (String)_config.DNS[0] + "|input\n";
+  values += "dn_1|" + (String)_config.DNS[1] + "|input\n";
+  values += "dn_2|" + (String)_config.DNS[2] + "|input\n";
+  values += "dn_3|" + (String)_config.DNS[3] + "|input\n";
+  values += "dhcp|" +  (String) (_config.dhcp ? "checked" : "") + "|chk\n";
+  values += "devicename|" + (String)_config.DeviceName + "|input\n";
+  bodyEnd();
+
+  _server.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
+  _server.sendHeader("Pragma", "no-cache");
+  _server.sendHeader("Expires", "-1");
+
+  _server.send(200, "text/plain", values);
+}
+
+// Same as send_network_configuration_values_html()
+static void writerNetworkValues()
+{
+  ResponseWriter w(_server, true);
+
+  bodyBegin();
+  w.field("ssid", _config.ssid, "input");
+  w.field("password", _config.password, "input");
+  w.field("ip_0", _config.IP[0], "input");
+  w.field("ip_1", _config.IP[1], "input");
+  w.field("ip_2", _config.IP[2], "input");
+  w.field("ip_3", _config.IP[3], "input");
+  w.field("nm_0", _config.Netmask[0], "input");
+  w.field("nm_1", _config.Netmask[1], "input");
+  w.field("nm_2", _config.Netmask[2], "input");
+  w.field("nm_3", _config.Netmask[3], "input");
+  w.field("gw_0", _config.Gateway[0], "input");
+  w.field("gw_1", _config.Gateway[1], "input");
+  w.field("gw_2", _config.Gateway[2], "input");
+  w.field("gw_3", _config.Gateway[3], "input");
+  w.field("dn_0", _config.DNS[0], "input");
+  w.field("dn_1", _config.DNS[1], "input");
+  w.field("dn_2", _config.DNS[2], "input");
+  w.field("dn_3", _config.DNS[3], "input");
+  w.field("dhcp", _config.dhcp ? "checked" : "", "chk");
+  w.field("devicename", _config.DeviceName, "input");
+  w.end();
+  bodyEnd();
+}
+
+// Body without the chunk framing
+static std::string unchunk(const std::string &body)
+{
+  std::string s;
+  size_t i = 0;
+  while (i < body.size()) {
+    size_t e = body.find("\r\n", i);
+    size_t n = strtoul(body.substr(i, e - i).c_str(), NULL, 16);
+    s += body.substr(e + 2, n);
+    i = e + 2 + n + 2;
+  }
+  return s;
+}
+
+struct Measure
+{
+  size_t bodyPeak;
+  uint32_t bodyAllocs;
+  uint32_t allocs;
+  uint32_t writes;
+  double ns;
+  std::string body;
+};
+
+static Measure measure(void (*page)(), int loops)
+{
+  Measure m;
+
+  _server.simReset();
+  uint32_t allocs = _heapAllocs;
+  page();
+  m.bodyPeak = _bodyPeak;
+  m.bodyAllocs = _bodyAllocs;
+  m.allocs = _heapAllocs - allocs;
+  m.writes = _server.simWrites;
+  m.body = _server.simBody;
+
+  uint64_t t = hostNanos();
+  for (int i = 0; i < loops; i++) {
+    _server.simReset();
+    page();
+  }
+  m.ns = (double)(hostNanos() - t) / loops;
+
+  return m;
+}
+
+int main()
+{
+  _config.ssid = "MyHomeNetwork-5G";
+  _config.password = "correct horse battery staple";
+  _config.IP[0] = 192; _config.IP[1] = 168; _config.IP[2] = 1; _config.IP[3] = 100;
+  _config.Netmask[0] = 255; _config.Netmask[1] = 255; _config.Netmask[2] = 255; _config.Netmask[3] = 0;
+  _config.Gateway[0] = 192; _config.Gateway[1] = 168; _config.Gateway[2] = 1; _config.Gateway[3] = 1;
+  _config.DNS[0] = 192; _config.DNS[1] = 168; _config.DNS[2] = 1; _config.DNS[3] = 1;
+  _config.dhcp = true;
+  _config.DeviceName = "TexTime";
+
+  const int loops = 100000;
+  Measure former = measure(formerNetworkValues, loops);
+  Measure writer = measure(writerNetworkValues, loops);
+
+  if (unchunk(writer.body) != former.body) {
+    printf("The ResponseWriter page differs from the former one\n");
+    return 1;
+  }
+
+  if (writer.bodyAllocs) {
+    printf("The ResponseWriter allocated %u blocks while writing the body\n", writer.bodyAllocs);
+    return 1;
+  }
+
+  printf("/admin/networkfieldsvalues, %u bytes  %12s %14s\n", (unsigned)former.body.size(), "String", "ResponseWriter");
+  printf("%-36s %9u B %12u B\n", "peak heap building the body", (unsigned)former.bodyPeak, (unsigned)writer.bodyPeak);
+  printf("%-36s %11u %14u\n", "allocations building the body", former.bodyAllocs, writer.bodyAllocs);
+  printf("%-36s %11u %14u\n", "allocations with the headers", former.allocs, writer.allocs);
+  printf("%-36s %11u %14u\n", "writes to the client", former.writes, writer.writes);
+  printf("%-36s %8.0f ns %11.0f ns\n", "time", former.ns, writer.ns);
+
+  return 0;
+}
@@ -0,0 +1,181 @@
+// Host check of the cooperative scheduler of Scheduler.h on simulated time:
+// periods and returned delays, deadlines beyond the wheel, priorities, the
+// lateness of the led task behind slow housekeeping and after a long
+// blocking call, resync after a stall, wake() and the cost of an idle pass
+//
+//   make check
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <ESP8266WebServer.h>
+#include <ESP8266HTTPUpdateServer.h>
+#include <WiFiUdp.h>
+#include <lwip/dns.h>
+#include <EEPROM.h>
+#include <DNSServer.h>
+#include <Wire.h>
+#include <RtcDS3231.h>
+#include <PubSubClient.h>
+
+#include "global.h"
+#include "list.h"
+#include "Perf.h"
+#include "Scheduler.h"
+
+#include <chrono>
+#include <vector>
+
+uint64_t _simMicros = 0;
+uint32_t _simRandom = 1;
+
+HardwareSerial Serial;
+EspClass ESP;
+ESP8266WiFiClass WiFi;
+EEPROMClass EEPROM;
+TwoWire Wire;
+
+// Task run times come from the simulated time
+uint32_t EspClass::getCycleCount()
+{
+  return (uint32_t)(_simMicros * 80);
+}
+
+static uint64_t hostNanos()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int _failures = 0;
+
+static void expect(bool ok, const char *what)
+{
+  if (!ok) {
+    printf("FAILED: %s\n", what);
+    _failures++;
+  }
+}
+
+// Start times (us) of each task
+static std::vector<uint64_t> _ledRuns, _webRuns, _slowRuns, _delayRuns, _hourRuns, _wakeRuns;
+static std::vector<char> _order;
+
+static uint32_t taskLed() { _ledRuns.push_back(_simMicros); _order.push_back('L'); _simMicros += 50; return 0; }
+static uint32_t taskWeb() { _webRuns.push_back(_simMicros); _order.push_back('W'); _simMicros += 200; return 0; }
+static uint32_t taskSlow() { _slowRuns.push_back(_simMicros); _order.push_back('S'); _simMicros += 3000; return 0; }
+static uint32_t taskDelay() { _delayRuns.push_back(_simMicros); return 250; }
+static uint32_t taskHour() { _hourRuns.push_back(_simMicros); return 0; }
+static uint32_t taskWake() { _wakeRuns.push_back(_simMicros); return 0; }
+
+Task _taskLed("led", taskLed, 1, 0);
+Task _taskWeb("web", taskWeb, 5, 3);
+Task _taskSlow("slow", taskSlow, 10, 4);
+Task _taskDelay("delay", taskDelay, 1, 5);
+Task _taskHour("hour", taskHour, 1000, 5);
+Task _taskWake("wake", taskWake, 60000, 6);
+
+// Run the loop for a while, 20us by idle pass
+static void runFor(uint64_t us)
+{
+  uint64_t end = _simMicros + us;
+
+  while (_simMicros < end) {
+    uint64_t t = _simMicros;
+    _scheduler.run();
+    if (_simMicros == t)
+      _simMicros += 20;
+  }
+}
+
+static uint64_t maxGap(const std::vector<uint64_t> &runs, size_t from)
+{
+  uint64_t m = 0;
+  for (size_t i = from + 1; i < runs.size(); i++)
+    if (runs[i] - runs[i - 1] > m)
+      m = runs[i] - runs[i - 1];
+  return m;
+}
+
+int main()
+{
+  _simMicros = 5000000;
+
+  _scheduler.add(&_taskLed);
+  _scheduler.add(&_taskWeb);
+  _scheduler.add(&_taskSlow);
+  _scheduler.add(&_taskDelay);
+  _scheduler.add(&_taskHour, 500);
+  _scheduler.add(&_taskWake);
+
+  runFor(10000000);
+
+  // Periods and delays over 10 s
+  expect(_webRuns.size() >= 1990 && _webRuns.size() <= 2001, "web task every 5 ms");
+  expect(_slowRuns.size() >= 995 && _slowRuns.size() <= 1001, "slow task every 10 ms");
+  expect(_delayRuns.size() >= 38 && _delayRuns.size() <= 41, "task every 250 ms after its run");
+  expect(_hourRuns.size() == 10, "1 s period, beyond the wheel");
+  for (size_t i = 0; i < _hourRuns.size(); i++)
+    expect(_hourRuns[i] >= 5500000 + i * 1000000 && _hourRuns[i] < 5500000 + i * 1000000 + 4000, "1 s period on its grid");
+  expect(_wakeRuns.size() == 1, "60 s period runs once at start");
+
+  // The led task goes first, and after a slow task before the other ready ones
+  expect(_order[0] == 'L', "led task first at start");
+  bool preempted = true;
+  for (size_t i = 0; i + 1 < _order.size(); i++)
+    if (_order[i] == 'S' && _order[i + 1] != 'L')
+      preempted = false;
+  expect(preempted, "led task runs right after the slow task");
+
+  // Behind a 3 ms task at most: the led task never waits for the whole housekeeping
+  uint64_t ledGap = maxGap(_ledRuns, 0);
+  expect(ledGap <= 3000 + 50 + 1000, "led gap bounded by the longest task");
+
+  uint32_t lateCount, lateMax;
+  {
+    String s = _taskLed.getLateStats().summary();
+    sscanf(s.c_str(), "%u %*u %*u %u", &lateCount, &lateMax);
+  }
+  expect(lateMax <= 3000 + 1000, "led lateness bounded by the longest task");
+
+  // A stall of 35 ms: the 10 ms task runs once, then on its grid again
+  size_t slow = _slowRuns.size();
+  _simMicros += 35000;
+  runFor(30000);
+  expect(_slowRuns.size() - slow <= 4, "late periodic task skips the missed runs");
+
+  // wake() brings the 60 s task to the next pass
+  _scheduler.wake(&_taskWake);
+  runFor(2000);
+  expect(_wakeRuns.size() == 2, "wake() runs the task");
+  runFor(100000);
+  expect(_wakeRuns.size() == 2, "woken task back to its period");
+
+  // A blocking call of 60 s: the lateness is counted in us, without wrapping
+  _taskLed.getLateStats().reset();
+  _simMicros += 60000000;
+  runFor(2000);
+  uint32_t stallMax;
+  {
+    String s = _taskLed.getLateStats().summary();
+    sscanf(s.c_str(), "%*u %*u %*u %u", &stallMax);
+  }
+  expect(stallMax >= 60000000 && stallMax <= 60000000 + 2000, "lateness of a 60 s stall");
+
+  // Idle pass cost on the host
+  _scheduler.reset();
+  _simMicros = (_simMicros / 1000 + 1) * 1000;
+  runFor(100);
+  const int passes = 1000000;
+  uint64_t t = hostNanos();
+  for (int i = 0; i < passes; i++)
+    _scheduler.run();
+  t = hostNanos() - t;
+
+  printf("Led task %u runs, late %u us at most, largest gap %u us\n", lateCount, lateMax, (unsigned)ledGap);
+  printf("Idle pass %.1f ns on the host\n", (double)t / passes);
+
+  if (_failures)
+    return 1;
+
+  printf("Scheduler checked\n");
+  return 0;
+}
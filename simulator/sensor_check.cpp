@@ -0,0 +1,216 @@
+// Host check of the I2C sensor hub of Sensors.h on a simulated bus: decoding
+// of the DS3231 temperature and of the BH1750 light level, sampling periods,
+// one transfer by call, reads not disturbed by the RTC moving the register
+// pointer between two calls, stale values and recovery after bus errors, then
+// the light level filters and the brightness curve
+//
+//   make check
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <ESP8266WebServer.h>
+#include <ESP8266HTTPUpdateServer.h>
+#include <WiFiUdp.h>
+#include <lwip/dns.h>
+#include <EEPROM.h>
+#include <DNSServer.h>
+#include <Wire.h>
+#include <RtcDS3231.h>
+#include <PubSubClient.h>
+
+#include "global.h"
+#include "list.h"
+#include "LightSensor.h"
+#include "Sensors.h"
+
+#include <math.h>
+
+uint64_t _simMicros = 0;
+uint32_t _simRandom = 1;
+
+HardwareSerial Serial;
+EspClass ESP;
+ESP8266WiFiClass WiFi;
+EEPROMClass EEPROM;
+TwoWire Wire;
+
+uint32_t EspClass::getCycleCount()
+{
+  return (uint32_t)(_simMicros * 80);
+}
+
+static int _failures = 0;
+
+static void expect(bool ok, const char *what)
+{
+  if (!ok) {
+    printf("FAILED: %s\n", what);
+    _failures++;
+  }
+}
+
+SimDS3231 _simDS3231;
+SimBH1750 _simBH1750;
+
+static uint32_t _temperatureSamples = 0;
+static uint32_t _lightSamples = 0;
+
+// Call the hub like the scheduler does, check one transfer at most by call:
+// a write, a read, or a register read with its pointer write
+static bool _oneByCall = true;
+
+// Moves the DS3231 register pointer between two calls, like the RTC reads
+static bool _rtcAccess = false;
+
+static void runFor(uint64_t ms)
+{
+  uint64_t end = millis64() + ms;
+
+  while (millis64() < end) {
+    uint32_t t = Wire.simTransactions;
+    uint32_t next = _sensors.handle();
+    if (Wire.simTransactions - t > 2)
+      _oneByCall = false;
+
+    if (_rtcAccess) {
+      Wire.beginTransmission(DS3231ADDRESS);
+      Wire.write(0);
+      Wire.endTransmission();
+      Wire.requestFrom(DS3231ADDRESS, 7);
+    }
+
+    _simMicros += (uint64_t)(next ? next : 1) * 1000;
+  }
+}
+
+int main()
+{
+  _simMicros = 1000000;
+
+  Wire.simAttach(DS3231ADDRESS, &_simDS3231);
+  Wire.simAttach(BH1750ADDRESS, &_simBH1750);
+  _sensors.add(&_sensorTemperature);
+  _sensors.add(&_sensorLight);
+  _sensors.onSample([](I2CSensor *sensor) {
+    if (sensor == &_sensorTemperature)
+      _temperatureSamples++;
+    else
+      _lightSamples++;
+  });
+
+  expect(!_sensorTemperature.getValue().isValid() && !_sensorLight.getValue().isValid(), "no value before the first sample");
+
+  // First samples, then the periods over 60 s
+  _simDS3231.setTemperature(23.75f);
+  _simBH1750.lux = 250;
+  runFor(300);
+  expect(_sensorTemperature.getValue().isValid() && _sensorTemperature.getValue().value == 23.75f, "DS3231 temperature");
+  expect(_sensorLight.getValue().isValid() && fabs(_sensorLight.getValue().value - 250) < 1, "BH1750 light level");
+  expect(_sensorTemperature.isRunning(), "DS3231 oscillator running");
+
+  uint32_t transactions = Wire.simTransactions;
+  _temperatureSamples = _lightSamples = 0;
+  runFor(60000);
+  expect(_temperatureSamples == 6, "temperature every 10 s");
+  expect(_lightSamples >= 59 && _lightSamples <= 61, "light every second");
+  expect(Wire.simTransactions - transactions <= 2 * 6 + 61, "two transactions by temperature, one by light level");
+  expect(_oneByCall, "one transfer at most by call");
+
+  // Below zero, quarter of degrees
+  _simDS3231.setTemperature(-5.25f);
+  runFor(10000);
+  expect(_sensorTemperature.getValue().value == -5.25f, "negative temperature");
+
+  // The RTC reads the time between two calls
+  _rtcAccess = true;
+  _simDS3231.setTemperature(31.5f);
+  runFor(30000);
+  expect(_sensorTemperature.getValue().value == 31.5f && _sensorTemperature.isRunning(), "temperature with the RTC on the bus");
+  _rtcAccess = false;
+
+  // Stopped oscillator : the temperature is kept, then stale
+  _simDS3231.reg[0x0E] |= DS3231EOSC;
+  runFor(10000);
+  expect(!_sensorTemperature.isRunning(), "DS3231 oscillator stopped");
+  runFor(30000);
+  expect(!_sensorTemperature.getValue().isValid(), "temperature stale without samples");
+  _simDS3231.reg[0x0E] &= ~DS3231EOSC;
+  runFor(10000);
+  expect(_sensorTemperature.getValue().isValid(), "temperature back");
+
+  // Light sensor unplugged then powered down : errors, stale, configured again
+  uint32_t errors = _sensorLight.getErrors();
+  Wire.simAttach(BH1750ADDRESS, NULL);
+  runFor(5000);
+  expect(_sensorLight.getErrors() > errors, "bus errors counted");
+  expect(!_sensorLight.getValue().isValid(), "light stale without samples");
+  _simBH1750.mode = 0;
+  _simBH1750.lux = 40;
+  Wire.simAttach(BH1750ADDRESS, &_simBH1750);
+  runFor(2500);
+  expect(_simBH1750.mode == BH1750CONTINUOUSHIGHRES, "BH1750 configured again");
+  expect(_sensorLight.getValue().isValid() && fabs(_sensorLight.getValue().value - 40) < 1, "light back");
+
+  // Reading the cache does not touch the bus
+  transactions = Wire.simTransactions;
+  for (int i = 0; i < 1000; i++)
+    (void)(_sensorTemperature.getValue().value + _sensorLight.getValue().value);
+  expect(Wire.simTransactions == transactions, "cached values");
+
+  // Running average over the samples received so far
+  updateAvgLux(100);
+  expect(getAvgLux() == 100 && getFilteredLux() == 100, "filters start from the first sample");
+  updateAvgLux(200);
+  expect(getAvgLux() == 150, "average of the first samples");
+  for (int i = 0; i < ALS_AVG_SIZE; i++)
+    updateAvgLux(300);
+  expect(getAvgLux() == 300, "average of the last samples");
+
+  // A single spike does not move the filtered level, a step does
+  updateAvgLux(5000);
+  updateAvgLux(300);
+  expect(getFilteredLux() == 300, "spike rejected");
+  for (int i = 0; i < 30; i++)
+    updateAvgLux(50);
+  expect(getFilteredLux() == 50, "step followed");
+
+  // The curve against the square root, within a step and its hysteresis
+  // around the light level
+  BrightnessCurve curve;
+  int worst = 0;
+  for (int luxMax = 10; luxMax <= 2550; luxMax += 170)
+    for (int s = 1; s <= 255; s += 37) {
+      curve.build(luxMax, s);
+      float step = (float)luxMax / LUXCURVESTEPS;
+      for (int l = 0; l <= luxMax + 10; l++) {
+        float lo = l - step * 1.25f, hi = l + step * 1.25f;
+        lo = lo < 0 ? 0 : (lo > luxMax ? luxMax : lo);
+        hi = hi > luxMax ? luxMax : hi;
+        float refLo = s + (255 - s) * sqrtf(lo / luxMax);
+        float refHi = s + (255 - s) * sqrtf(hi / luxMax);
+        float b = curve.lookup(l);
+        int d = b < refLo ? (int)(refLo - b + 0.5f) : (b > refHi ? (int)(b - refHi + 0.5f) : 0);
+        if (d > worst) worst = d;
+      }
+    }
+  expect(worst <= 1, "curve along the square root");
+
+  curve.build(400, 30);
+  expect(curve.lookup(0) == 30 && curve.lookup(400) == 255 && curve.lookup(1000) == 255, "curve ends");
+
+  // Noise around a step boundary does not flicker
+  int changes = 0;
+  int last = curve.lookup(201);
+  for (int i = 0; i < 1000; i++) {
+    int b = curve.lookup(201 + (i % 3) - 1);
+    if (b != last) changes++;
+    last = b;
+  }
+  expect(changes == 0, "no flicker from sensor noise");
+
+  if (_failures)
+    return 1;
+
+  printf("Sensors checked, %u bus errors recovered, curve within %d of the square root\n", _sensorLight.getErrors() + _sensorTemperature.getErrors(), worst);
+  return 0;
+}
@@ -0,0 +1,241 @@
+// Host check of the led strip output: a brightness ramp down and back up
+// leaves the leds of a static frame as they were, on every led configuration
+// and output mode. The strip stand-in loses precision on SetBrightness() like
+// the library does. The time mode redraws only the cells changed between two
+// slots, and the minimum brightness follows the day and the night.
+//
+//   make check
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <ESP8266WebServer.h>
+#include <ESP8266HTTPUpdateServer.h>
+#include <WiFiUdp.h>
+#include <lwip/dns.h>
+#include <EEPROM.h>
+#include <FS.h>
+#include <DNSServer.h>
+#include <NeoPixelBus.h>
+#include <NeoPixelBrightnessBus.h>
+#include <Wire.h>
+#include <RtcDS3231.h>
+#include <PubSubClient.h>
+
+#include "global.h"
+#include "mqtt_topics.h"
+#include "list.h"
+#include "Color.h"
+#include "Perf.h"
+#include "RTC.h"
+#include "NTP.h"
+#include "LightSensor.h"
+#include "Sensors.h"
+#include "LedStrip.h"
+
+uint64_t _simMicros = 0;
+uint32_t _simRandom = 1;
+
+HardwareSerial Serial;
+EspClass ESP;
+ESP8266WiFiClass WiFi;
+EEPROMClass EEPROM;
+FSClass SPIFFS;
+const char *_simFsRoot = "data";
+TwoWire Wire;
+
+uint32_t EspClass::getCycleCount()
+{
+  return (uint32_t)(_simMicros * 80);
+}
+
+static int _failures = 0;
+
+static void expect(bool ok, const char *what, int a, int b)
+{
+  if (!ok) {
+    printf("FAILED: %s, %d %d\n", what, a, b);
+    _failures++;
+  }
+}
+
+// Last leds sent on the wire
+static RgbColor _leds[NLEDSMAX];
+static uint16_t _ledsCount = 0;
+static uint32_t _shows = 0;
+
+void simStripShow(const RgbColor *leds, uint16_t count)
+{
+  _shows++;
+  _ledsCount = count;
+  for (uint16_t i = 0; i < count && i < NLEDSMAX; i++)
+    _leds[i] = leds[i];
+}
+
+static void runFor(uint32_t ms)
+{
+  for (uint32_t i = 0; i < ms; i++) {
+    handleISRsecondTick();
+    QTLed.handle();
+    _simMicros += 1000;
+  }
+}
+
+static uint8_t brightest()
+{
+  uint8_t m = 0;
+  for (uint16_t i = 0; i < _ledsCount; i++) {
+    if (_leds[i].R > m) m = _leds[i].R;
+    if (_leds[i].G > m) m = _leds[i].G;
+    if (_leds[i].B > m) m = _leds[i].B;
+  }
+  return m;
+}
+
+// Access to the minimum of the automatic brightness
+class CheckStrip : public MyLedStripAnimator
+{
+public:
+  using MyLedStrip::minimumBrightness;
+};
+
+// Night minimum from 22h to 9h, day minimum from 10h to 21h, a ramp between
+static void checkMinimumBrightness()
+{
+  static CheckStrip strip;
+  static const int hours[][3] = { { 23, 0, 5 }, { 3, 30, 5 }, { 8, 59, 5 }, { 12, 0, 30 }, { 20, 59, 30 }, { 9, 0, 5 }, { 21, 59, 5 } };
+
+  _config.brightnessAutoMinDay = 30;
+  _config.brightnessAutoMinNight = 5;
+
+  for (unsigned int i = 0; i < sizeof(hours) / sizeof(hours[0]); i++) {
+    _dateTime.hour = hours[i][0];
+    _dateTime.minute = hours[i][1];
+    expect(strip.minimumBrightness() == hours[i][2], "minimum brightness of the hour", hours[i][0], hours[i][1]);
+  }
+
+  _dateTime.hour = 21;
+  _dateTime.minute = 30;
+  int m = strip.minimumBrightness();
+  expect(m > 5 && m < 30, "minimum brightness ramp", 21, 30);
+}
+
+// Cells changed between two slots, against the masks of both slots, and the
+// time mode drawing only those cells, from every slot to the next one
+static int checkMaskChange()
+{
+  TextTime &t = _textTimeLayouts.current();
+  PixelsPipeline pipeline;
+  LedStripModeTime mode(&pipeline);
+  int changed = 0;
+
+  mode.setColorRandom(ColorRandomLetter);
+
+  for (int s = 0; s < 24 * 12; s++) {
+    int h1 = s / 12, m1 = s % 12 * 5;
+    int h2 = (s + 1) % (24 * 12) / 12, m2 = (s + 1) % 12 * 5;
+    uint32_t a[NPIXELSMASK], b[NPIXELSMASK], c[NPIXELSMASK];
+
+    t.getMaskFromTime(h1, m1, a);
+    t.getMaskFromTime(h2, m2, b);
+    bool ok = t.getMaskChange(h1, m1, h2, m2, c);
+    for (int i = 0; ok && i < NPIXELSMASK; i++)
+      ok = c[i] == (a[i] ^ b[i]);
+    expect(ok, "mask change is the XOR of the masks", h1, m1);
+
+    // Same slot, nothing changes
+    ok = t.getMaskChange(h1, m1, h1, m1 + 4, c);
+    for (int i = 0; ok && i < NPIXELSMASK; i++)
+      ok = c[i] == 0;
+    expect(ok, "no mask change in a slot", h1, m1);
+
+    mode.begin();
+    _dateTime.hour = h1;
+    _dateTime.minute = m1;
+    mode.handle();
+    PixelsArray before = pipeline.back();
+    _dateTime.hour = h2;
+    _dateTime.minute = m2;
+    mode.handle();
+    const PixelsArray &after = pipeline.back();
+
+    t.getMaskChange(h1, m1, h2, m2, c);
+    for (int n = 0; n < NROW * NCOL; n++) {
+      bool on = b[n >> 5] & (1UL << (n & 31));
+      bool change = c[n >> 5] & (1UL << (n & 31));
+      expect(after.isDisplayed(n) == on, "time mode shows the cells of the slot", h2, m2);
+      if (on && !change)
+        expect(after.color(n) == before.color(n), "letters kept through the slot change", h2, m2);
+      changed += change;
+    }
+  }
+
+  return changed;
+}
+
+int main()
+{
+  _config.timeZone = 0;
+  _config.isDayLightSaving = false;
+  _config.tz = "";
+
+  // Same minute all along
+  _clock.setTime(1500000000UL - (1500000000UL % 86400) + 10 * 3600 + 27 * 60);
+  applyTimeZone();
+  handleISRsecondTick();
+
+  uint32_t ramps = 0;
+
+  for (int config = 0; config < 3; config++) {
+    for (int output = OutputDirect; output <= OutputGamma; output++) {
+      _config.ledConfig = config;
+      QTLed.begin();
+      QTLed.setOutputMode(output);
+      QTLed.setAutomaticBrightness(false);
+      QTLed.setBrightness(255);
+      QTLed.setColor(0xC8, 0x64, 0x1E);
+      QTLed.setMode(1);
+      QTLed.setAnimation(0);
+      runFor(1000);
+
+      RgbColor reference[NLEDSMAX];
+      uint16_t count = _ledsCount;
+      for (uint16_t i = 0; i < count; i++)
+        reference[i] = _leds[i];
+      expect(brightest() > 100, "frame shown", config, output);
+
+      uint32_t shows = _shows;
+      QTLed.setBrightness(10);
+      runFor(2000);
+      expect(brightest() <= 11, "dimmed", config, output);
+      QTLed.setBrightness(255);
+      runFor(2000);
+      ramps += _shows - shows;
+
+      bool same = _ledsCount == count;
+      for (uint16_t i = 0; same && i < count; i++)
+        same = _leds[i] == reference[i];
+      expect(same, "leds back to their colors after the ramp", config, output);
+    }
+  }
+
+  // A still frame with its dithering error carried is redrawn at DITHERFPS at most
+  _config.ledConfig = 0;
+  QTLed.begin();
+  QTLed.setOutputMode(OutputGammaDither);
+  QTLed.setBrightness(20);
+  QTLed.setColor(0xC8, 0x64, 0x1E);
+  runFor(2000);
+  uint32_t shows = _shows;
+  runFor(1000);
+  shows = _shows - shows;
+  expect(shows > 0 && shows <= DITHERFPS + 1, "dithering redraws capped", shows, DITHERFPS);
+
+  int changed = checkMaskChange();
+  checkMinimumBrightness();
+
+  if (_failures)
+    return 1;
+
+  printf("Strip checked, %u frames shown by the brightness ramps, %u dithered frames in 1 s, %d cells changed over the day\n", ramps, shows, changed);
+  return 0;
+}
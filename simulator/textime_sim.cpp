@@ -0,0 +1,404 @@
+// TexTime host simulator
+//
+// Runs the led strip modes and animations against a virtual strip with a
+// simulated clock, renders the frames to PPM files or to an ANSI terminal
+// preview and reports the frame rate and the CPU time of the rendering.
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <ESP8266WebServer.h>
+#include <ESP8266HTTPUpdateServer.h>
+#include <WiFiUdp.h>
+#include <lwip/dns.h>
+#include <EEPROM.h>
+#include <FS.h>
+#include <DNSServer.h>
+#include <NeoPixelBus.h>
+#include <NeoPixelBrightnessBus.h>
+#include <Wire.h>
+#include <RtcDS3231.h>
+#include <PubSubClient.h>
+
+#include "global.h"
+#include "mqtt_topics.h"
+#include "list.h"
+#include "Color.h"
+#include "Perf.h"
+#include "RTC.h"
+#include "NTP.h"
+#include "LightSensor.h"
+#include "Sensors.h"
+#include "LedStrip.h"
+
+#include <chrono>
+#include <unistd.h>
+
+uint64_t _simMicros = 0;
+uint32_t _simRandom = 1;
+
+HardwareSerial Serial;
+EspClass ESP;
+ESP8266WiFiClass WiFi;
+EEPROMClass EEPROM;
+FSClass SPIFFS;
+const char *_simFsRoot = "data";
+TwoWire Wire;
+
+// I2C sensors on the simulated bus
+SimDS3231 _simDS3231(21.5f);
+SimBH1750 _simBH1750(100);
+
+static uint64_t hostNanos()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t EspClass::getCycleCount()
+{
+  return (uint32_t)(hostNanos() * 80 / 1000);
+}
+
+struct SimOptions
+{
+  int mode;
+  int animation;
+  int config;
+  int outputMode;
+  int transition;
+  int brightness;
+  uint32_t color;
+  int hour;
+  int minute;
+  int second;
+  double duration;      // simulated seconds
+  uint32_t loopPeriod;  // simulated us between two loop passes
+  uint32_t seed;
+  const char *text;     // spelled over the mode
+  const char *tz;       // POSIX time zone, the start time is then UTC
+  int layout;
+  const char *ppmPrefix;
+  int ppmEvery;
+  int scale;
+  bool ansi;
+  bool realTime;
+};
+
+static SimOptions _options = { 1, 0, 0, 0, 0, 255, 0xFFFFFF, 10, 27, 0, 5.0, 1000, 1, NULL, NULL, 0, NULL, 1, 16, false, false };
+
+static uint32_t _shows = 0;
+
+// Color of the first led of each matrix cell and edge
+static void stripToGrid(const RgbColor *leds, uint16_t count, RgbColor grid[NROW][NCOL], RgbColor edges[NEDGE])
+{
+  LedConfiguration *pConfig = (*QTLed.getLedConfigurationList())[QTLed.getLedConfigurationIndex()];
+
+  for (int r = 0; r < NROW; r++)
+    for (int c = 0; c < NCOL; c++) {
+      uint8_t l = pConfig->getLedsMatrixId(r, c)[0];
+      grid[r][c] = l < count ? leds[l] : RgbColor(0, 0, 0);
+    }
+
+  for (int e = 0; e < NEDGE; e++) {
+    uint8_t l = pConfig->getLedsEdgeId(e)[0];
+    edges[e] = l < count ? leds[l] : RgbColor(0, 0, 0);
+  }
+}
+
+// Matrix surrounded by a border of one cell, edges are drawn as dots in its corners
+static void writePPM(const char *path, RgbColor grid[NROW][NCOL], RgbColor edges[NEDGE])
+{
+  int s = _options.scale;
+  int w = (NCOL + 2) * s;
+  int h = (NROW + 2) * s;
+
+  FILE *f = fopen(path, "wb");
+  if (!f) {
+    fprintf(stderr, "Unable to write %s\n", path);
+    exit(1);
+  }
+
+  fprintf(f, "P6\n%d %d\n255\n", w, h);
+
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      int r = y / s - 1;
+      int c = x / s - 1;
+      int dx = x % s;
+      int dy = y % s;
+      bool inside = dx > 0 && dy > 0 && dx < s - 1 && dy < s - 1;
+      RgbColor p(0, 0, 0);
+
+      if (r >= 0 && r < NROW && c >= 0 && c < NCOL) {
+        if (inside) p = grid[r][c];
+      }
+      else {
+        int e = -1;
+        if (r < 0 && c < 0) e = 0;
+        if (r < 0 && c >= NCOL) e = 1;
+        if (r >= NROW && c >= NCOL) e = 2;
+        if (r >= NROW && c < 0) e = 3;
+
+        int d = s / 4;
+        if (e >= 0 && dx >= s / 2 - d && dx <= s / 2 + d && dy >= s / 2 - d && dy <= s / 2 + d)
+          p = edges[e];
+      }
+
+      fputc(p.R, f);
+      fputc(p.G, f);
+      fputc(p.B, f);
+    }
+  }
+
+  fclose(f);
+}
+
+static void printAnsiCell(const RgbColor &c)
+{
+  if (c.R || c.G || c.B)
+    printf("\x1b[38;2;%d;%d;%dm\u2588\u2588", c.R, c.G, c.B);
+  else
+    printf("\x1b[38;2;40;40;40m\u00b7\u00b7");
+}
+
+static void printAnsi(RgbColor grid[NROW][NCOL], RgbColor edges[NEDGE])
+{
+  // Redraw in place
+  if (_shows > 1)
+    printf("\x1b[%dA", NROW + 3);
+
+  printf("%02d:%02d:%02d  frame %u\x1b[K\n", _dateTime.hour, _dateTime.minute, _dateTime.second, _shows);
+
+  printAnsiCell(edges[0]);
+  printf("%*s", NCOL * 2, "");
+  printAnsiCell(edges[1]);
+  printf("\x1b[0m\n");
+
+  for (int r = 0; r < NROW; r++) {
+    printf("  ");
+    for (int c = 0; c < NCOL; c++)
+      printAnsiCell(grid[r][c]);
+    printf("\x1b[0m\n");
+  }
+
+  printAnsiCell(edges[3]);
+  printf("%*s", NCOL * 2, "");
+  printAnsiCell(edges[2]);
+  printf("\x1b[0m\n");
+  fflush(stdout);
+}
+
+void simStripShow(const RgbColor *leds, uint16_t count)
+{
+  _shows++;
+
+  if (!_options.ppmPrefix && !_options.ansi)
+    return;
+
+  RgbColor grid[NROW][NCOL];
+  RgbColor edges[NEDGE];
+  stripToGrid(leds, count, grid, edges);
+
+  if (_options.ppmPrefix && (_shows - 1) % _options.ppmEvery == 0) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s%06u.ppm", _options.ppmPrefix, _shows);
+    writePPM(path, grid, edges);
+  }
+
+  if (_options.ansi)
+    printAnsi(grid, edges);
+}
+
+static void printList(const char *title, const std::string *names, int n)
+{
+  printf("%s:\n", title);
+  for (int i = 0; i < n; i++)
+    printf("  %d: %s\n", i, names[i].c_str());
+}
+
+static void listAll()
+{
+  std::string names[32];
+
+  LedStripModeList *pm = QTLed.getModesList();
+  for (int i = 0; i < pm->size(); i++) names[i] = (*pm)[i]->getName();
+  printList("Modes", names, pm->size());
+
+  LedStripAnimationList *pa = QTLed.getAnimationsList();
+  for (int i = 0; i < pa->size(); i++) names[i] = (*pa)[i]->getName();
+  printList("Animations", names, pa->size());
+
+  LedConfigurationList *pc = QTLed.getLedConfigurationList();
+  for (int i = 0; i < pc->size(); i++) names[i] = (*pc)[i]->getName();
+  printList("Led configurations", names, pc->size());
+
+  for (int i = 0; i < NLEDOUTPUTMODES; i++) names[i] = getLedOutputName(i);
+  printList("Output modes", names, NLEDOUTPUTMODES);
+
+  for (int i = 0; i < NTRANSITIONS; i++) names[i] = getTransitionName(i);
+  printList("Transitions", names, NTRANSITIONS);
+
+  _textTimeLayouts.begin();
+  for (int i = 0; i < _textTimeLayouts.size(); i++) names[i] = _textTimeLayouts.getName(i).c_str();
+  printList("Layouts", names, _textTimeLayouts.size());
+}
+
+static void usage(const char *name)
+{
+  printf("Usage: %s [options]\n"
+         "  -m MODE        mode index (default 1)\n"
+         "  -a ANIMATION   animation index (default 0)\n"
+         "  -c CONFIG      led configuration index (default 0)\n"
+         "  -t HH:MM[:SS]  start time (default 10:27)\n"
+         "  -d SECONDS     simulated duration (default 5)\n"
+         "  -p US          simulated loop period in us (default 1000)\n"
+         "  -s SEED        random seed (default 1)\n"
+         "  -k RRGGBB      color (default FFFFFF)\n"
+         "  -b BRIGHTNESS  brightness (default 255)\n"
+         "  -g OUTPUT      output mode index (default 0)\n"
+         "  -T TRANSITION  transition index (default 0)\n"
+         "  -S TEXT        spell a text on the grid\n"
+         "  -z TZ          POSIX time zone rules, the start time is then UTC\n"
+         "  -L LAYOUT      word layout index, 0 is the built-in one\n"
+         "  -F DIR         host directory used as SPIFFS (default data)\n"
+         "  -o PREFIX      write each shown frame to PREFIX<frame>.ppm\n"
+         "  -e N           only write one frame out of N\n"
+         "  -x SCALE       ppm pixels by cell (default 16)\n"
+         "  -A             ANSI terminal preview\n"
+         "  -r             run the preview in real time\n"
+         "  -l             list modes, animations, led configurations, outputs, transitions and layouts\n",
+         name);
+}
+
+int main(int argc, char **argv)
+{
+  int opt;
+  bool list = false;
+
+  while ((opt = getopt(argc, argv, "m:a:c:t:d:p:s:k:b:g:T:S:z:L:F:o:e:x:Arlh")) != -1) {
+    switch (opt) {
+    case 'm': _options.mode = atoi(optarg); break;
+    case 'a': _options.animation = atoi(optarg); break;
+    case 'c': _options.config = atoi(optarg); break;
+    case 't': sscanf(optarg, "%d:%d:%d", &_options.hour, &_options.minute, &_options.second); break;
+    case 'd': _options.duration = atof(optarg); break;
+    case 'p': _options.loopPeriod = atoi(optarg); break;
+    case 's': _options.seed = strtoul(optarg, NULL, 0); break;
+    case 'k': _options.color = strtoul(optarg, NULL, 16); break;
+    case 'b': _options.brightness = atoi(optarg); break;
+    case 'g': _options.outputMode = atoi(optarg); break;
+    case 'T': _options.transition = atoi(optarg); break;
+    case 'S': _options.text = optarg; break;
+    case 'z': _options.tz = optarg; break;
+    case 'L': _options.layout = atoi(optarg); break;
+    case 'F': _simFsRoot = optarg; break;
+    case 'o': _options.ppmPrefix = optarg; break;
+    case 'e': _options.ppmEvery = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
+    case 'x': _options.scale = atoi(optarg) > 2 ? atoi(optarg) : 3; break;
+    case 'A': _options.ansi = true; break;
+    case 'r': _options.realTime = true; break;
+    case 'l': list = true; break;
+    default: usage(argv[0]); return opt == 'h' ? 0 : 1;
+    }
+  }
+
+  if (list) {
+    listAll();
+    return 0;
+  }
+
+  randomSeed(_options.seed);
+
+  // Local time, without time zone
+  _config.ledConfig = _options.config;
+  _config.timeZone = 0;
+  _config.isDayLightSaving = false;
+  _config.tz = _options.tz ? _options.tz : "";
+  _config.brightnessAutoMinDay = 30;
+  _config.brightnessAutoMinNight = 0;
+  _config.luxSensitivity = 40;
+  Wire.simAttach(DS3231ADDRESS, &_simDS3231);
+  Wire.simAttach(BH1750ADDRESS, &_simBH1750);
+  _sensors.add(&_sensorTemperature);
+  _sensors.add(&_sensorLight);
+  _sensors.onSample([](I2CSensor *sensor) {
+    if (sensor == &_sensorLight)
+      updateAvgLux(sensor->getValue().value);
+  });
+
+  _clock.setTime(1500000000UL - (1500000000UL % 86400) + _options.hour * 3600 + _options.minute * 60 + _options.second);
+  applyTimeZone();
+  handleISRsecondTick();
+
+  QTLed.begin();
+  QTLed.setOutputMode(_options.outputMode);
+  QTLed.setTransition(_options.transition);
+  QTLed.setAutomaticBrightness(false);
+  QTLed.setBrightness(_options.brightness);
+  QTLed.setColor((_options.color >> 16) & 0xFF, (_options.color >> 8) & 0xFF, _options.color & 0xFF);
+
+  if (!QTLed.setMode(_options.mode) || !QTLed.setAnimation(_options.animation)) {
+    fprintf(stderr, "Invalid mode or animation, use -l to list them\n");
+    return 1;
+  }
+
+  _textTimeLayouts.begin();
+  if (!QTLed.setLayout(_options.layout)) {
+    fprintf(stderr, "Invalid layout, use -l to list them\n");
+    return 1;
+  }
+
+  if (_options.text)
+    QTLed.spellText(_options.text);
+
+  uint64_t end = _simMicros + (uint64_t)(_options.duration * 1000000.0);
+  uint32_t loops = 0;
+  uint64_t cpuTotal = 0;
+  uint64_t cpuMax = 0;
+  uint32_t shows = _shows;
+
+  perfReset();
+
+  while (_simMicros < end) {
+    handleISRsecondTick();
+    _sensors.handle();
+
+    uint64_t t = hostNanos();
+    QTLed.handle();
+    t = hostNanos() - t;
+
+    cpuTotal += t;
+    if (t > cpuMax) cpuMax = t;
+    loops++;
+
+    _simMicros += _options.loopPeriod;
+
+    if (_options.realTime)
+      usleep(_options.loopPeriod);
+  }
+
+  shows = _shows - shows;
+
+  LedStripModeList *pm = QTLed.getModesList();
+  LedStripAnimationList *pa = QTLed.getAnimationsList();
+  LedConfigurationList *pc = QTLed.getLedConfigurationList();
+
+  printf("Mode: %s, animation: %s, led configuration: %s\n",
+         (*pm)[QTLed.getModeIndex()]->getName(),
+         (*pa)[QTLed.getAnimationIndex()]->getName(),
+         (*pc)[QTLed.getLedConfigurationIndex()]->getName());
+  printf("Simulated: %.3f s, %u loop passes, %u frames shown, %.1f fps\n",
+         _options.duration, loops, shows, shows / _options.duration);
+  printf("Host CPU by loop pass: mean %.2f us, max %.2f us; by shown frame: %.2f us\n",
+         cpuTotal / 1000.0 / (loops ? loops : 1), cpuMax / 1000.0, cpuTotal / 1000.0 / (shows ? shows : 1));
+
+  const PixelsPipelineStats &ms = QTLed.getModeFramesStats();
+  const PixelsPipelineStats &as = QTLed.getAnimationFramesStats();
+  printf("Mode frames: produced %u, consumed %u, dropped %u, coalesced %u\n", ms.produced, ms.consumed, ms.dropped, ms.coalesced);
+  printf("Animation frames: produced %u, consumed %u, dropped %u, coalesced %u\n", as.produced, as.consumed, as.dropped, as.coalesced);
+
+  printf("Stages (count min mean max in host us):\n");
+  for (unsigned int i = 0; i < NPERFSTAGES; i++)
+    printf("  %-10s %s\n", _perfStages[i]->getName(), _perfStages[i]->summary().c_str());
+
+  return 0;
+}
@@ -0,0 +1,218 @@
+// Host check of the web pages and of the MQTT publications: every values
+// page is served by its handler to the stand-in server, the settings are
+// applied from the General page and MQTT, and the timings are streamed to
+// the stand-in client in one message of the announced length.
+//
+//   make check
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <ESP8266WebServer.h>
+#include <ESP8266HTTPUpdateServer.h>
+#include <WiFiUdp.h>
+#include <lwip/dns.h>
+#include <EEPROM.h>
+#include <FS.h>
+#include <DNSServer.h>
+#include <NeoPixelBus.h>
+#include <NeoPixelBrightnessBus.h>
+#include <Wire.h>
+#include <RtcDS3231.h>
+#include <PubSubClient.h>
+
+#include "global.h"
+#include "mqtt_topics.h"
+#include "list.h"
+#include "Color.h"
+#include "Perf.h"
+#include "Scheduler.h"
+#include "RTC.h"
+#include "NTP.h"
+#include "LightSensor.h"
+#include "Sensors.h"
+#include "LedStrip.h"
+#include "mqtt.h"
+#include "ResponseWriter.h"
+
+#include "Page_ico.h"
+#include "Page_index.h"
+#include "Page_ntp.h"
+#include "Page_information.h"
+#include "Page_general.h"
+#include "Page_network.h"
+#include "Page_mqtt.h"
+#include "Page_script.js.h"
+#include "Page_style.css.h"
+
+#include <algorithm>
+
+uint64_t _simMicros = 0;
+uint32_t _simRandom = 1;
+
+HardwareSerial Serial;
+EspClass ESP;
+ESP8266WiFiClass WiFi;
+EEPROMClass EEPROM;
+FSClass SPIFFS;
+const char *_simFsRoot = "data";
+TwoWire Wire;
+
+uint32_t EspClass::getCycleCount()
+{
+  return (uint32_t)(_simMicros * 80);
+}
+
+void simStripShow(const RgbColor *, uint16_t)
+{
+}
+
+static int _failures = 0;
+
+static void expect(bool ok, const char *what, const char *page)
+{
+  if (!ok) {
+    printf("FAILED: %s, %s\n", what, page);
+    _failures++;
+  }
+}
+
+// Body without the chunk framing, empty if the framing is broken
+static std::string unchunk(const std::string &body)
+{
+  std::string s;
+  size_t i = 0;
+  while (i < body.size()) {
+    size_t e = body.find("\r\n", i);
+    if (e == std::string::npos)
+      return "";
+    size_t n = strtoul(body.substr(i, e - i).c_str(), NULL, 16);
+    if (n == 0)
+      return e + 4 == body.size() ? s : "";
+    s += body.substr(e + 2, n);
+    i = e + 2 + n + 2;
+  }
+  return "";
+}
+
+// Serves a values page, returns its lines
+static std::vector<std::string> serve(void (*page)(), const char *path, bool fields)
+{
+  std::vector<std::string> lines;
+
+  _server.simReset();
+  _server.simArgs.clear();
+  page();
+
+  std::string body = unchunk(_server.simBody);
+  expect(body.size() > 0, "chunked body", path);
+
+  size_t i = 0;
+  while (i < body.size()) {
+    size_t e = body.find('\n', i);
+    if (e == std::string::npos) e = body.size();
+    std::string l = body.substr(i, e - i);
+    lines.push_back(l);
+    i = e + 1;
+
+    // "id|value|type", or "id|value" for the timings
+    size_t bars = std::count(l.begin(), l.end(), '|');
+    expect(l.find('|') > 0 && (fields ? bars == 2 : bars >= 1), l.c_str(), path);
+  }
+
+  return lines;
+}
+
+// Line of a field
+static std::string field(const std::vector<std::string> &lines, const char *id)
+{
+  std::string prefix = std::string(id) + "|";
+  for (size_t i = 0; i < lines.size(); i++)
+    if (!lines[i].compare(0, prefix.size(), prefix))
+      return lines[i];
+  return "";
+}
+
+static uint32_t taskNothing()
+{
+  return 0;
+}
+
+// As in the sketch, mqtt.h wakes its publisher
+Task _taskLed("led", taskNothing, 1, 0);
+Task _taskMqttPublish("mqttpublish", mqttPollingPublisher, 1000, 5);
+
+int main()
+{
+  _config.ledConfig = 0;
+  _textTimeLayouts.begin();
+  QTLed.begin();
+  _scheduler.add(&_taskLed);
+  _scheduler.add(&_taskMqttPublish);
+  for (int i = 0; i < 100; i++) {
+    _scheduler.run();
+    _simMicros += 1000;
+  }
+
+  static const struct
+  {
+    const char *path;
+    void (*page)();
+    bool fields;
+  } pages[] = {
+    { "/admin/networkfieldsvalues", send_network_configuration_values_html, true },
+    { "/admin/networkconnectionvalues", send_network_connection_values_html, true },
+    { "/admin/mqttfieldsvalues", send_mqtt_configuration_values_html, true },
+    { "/admin/mqttconnectionvalues", send_mqtt_connection_values_html, true },
+    { "/admin/infovalues", send_information_configuration_values_html, true },
+    { "/admin/ntpfieldsvalues", send_ntp_configuration_values_html, true },
+    { "/admin/generalfieldsvalues", send_general_configuration_values_html, true },
+    { "/admin/generalmodesvalues", send_general_modes_values_html, true },
+    { "/admin/generalanimationsvalues", send_general_animations_values_html, true },
+    { "/admin/generalledconfigvalues", send_general_ledconfig_values_html, true },
+    { "/admin/generallayoutvalues", send_general_layout_values_html, true },
+    { "/admin/generaloutputvalues", send_general_output_values_html, true },
+    { "/admin/generaltransitionvalues", send_general_transition_values_html, true },
+    { "/admin/perf", send_perf_values_html, false },
+  };
+
+  unsigned int lines = 0;
+  for (unsigned int i = 0; i < sizeof(pages) / sizeof(pages[0]); i++)
+    lines += serve(pages[i].page, pages[i].path, pages[i].fields).size();
+
+  // The lists come from the firmware
+  expect(serve(send_general_output_values_html, "/admin/generaloutputvalues", true).size() == NLEDOUTPUTMODES, "output modes", "/admin/generaloutputvalues");
+  expect(serve(send_general_transition_values_html, "/admin/generaltransitionvalues", true).size() == NTRANSITIONS, "transitions", "/admin/generaltransitionvalues");
+  std::vector<std::string> perf = serve(send_perf_values_html, "/admin/perf", false);
+  expect(field(perf, "task led").size() && field(perf, "task mqttpublish/late").size(), "task timings", "/admin/perf");
+
+  // Settings saved from the General page, then reported
+  _server.simReset();
+  _server.simArgs.clear();
+  _server.simArgs.push_back(std::make_pair(String("transition"), String("3")));
+  _server.simArgs.push_back(std::make_pair(String("ledoutput"), String("1")));
+  _server.simArgs.push_back(std::make_pair(String("layout"), String("0")));
+  send_general_html();
+  expect(QTLed.getTransition() == 3 && QTLed.getOutputMode() == 1, "settings applied", "/general.html");
+  std::vector<std::string> general = serve(send_general_configuration_values_html, "/admin/generalfieldsvalues", true);
+  expect(field(general, "transition") == "transition|3|input" && field(general, "ledoutput") == "ledoutput|1|input", "settings reported", "/admin/generalfieldsvalues");
+
+  // The timings in one message, not retained, as long as announced
+  _mqtt.simConnected = true;
+  mqttPublishPerf();
+  unsigned int n = std::count(_mqtt.simPayload.begin(), _mqtt.simPayload.end(), '\n');
+  expect(_mqtt.simTopic == mqttTopicPubPerf.topic().c_str() && !_mqtt.simRetained && !_mqtt.simLengthError, "timings published", "tele/perf");
+  expect(n == NPERFSTAGES + 2 * _scheduler.getTasks().size(), "one line by stage and task", "tele/perf");
+
+  // Led output over MQTT, and its state
+  String topic = mqttTopicSubLedOutput.topic();
+  mqttCallback((char *)topic.c_str(), (byte *)"2", 1);
+  expect(QTLed.getOutputMode() == 2, "output set", "cmnd/led/output");
+  mqttCallback((char *)topic.c_str(), (byte *)"", 0);
+  expect(_mqtt.simTopic == mqttTopicPubLedOutput.topic().c_str() && _mqtt.simPayload == "2", "output reported", "stat/led/output");
+
+  if (_failures)
+    return 1;
+
+  printf("Web pages checked, %u lines from %u values pages, %u timing lines published\n", lines, (unsigned)(sizeof(pages) / sizeof(pages[0])), n);
+  return 0;
+}
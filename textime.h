@@ -1,750 +1,670 @@
-#define TEXTIMEMAXBLOBSIZE 24
+#define TEXTIMEMAXBLOBS 4
 
-struct TextTimePixel
+// Horizontal run of letters on the grid
+struct TextTimeWord
 {
   uint8_t row;
   uint8_t col;
+  uint8_t length;
 };
 
+// Consecutive words of a phrase in a word table
+struct TextTimeSpan
+{
+  uint8_t first;
+  uint8_t number;
+};
+
+// Phrase to display, words are read from flash
 struct TextTimeBlob
 {
+  const TextTimeWord *words;
   uint8_t number;
-  TextTimePixel pixels[TEXTIMEMAXBLOBSIZE];
+
+  TextTimeWord word(int i) const
+  {
+    TextTimeWord w;
+    memcpy_P(&w, words + i, sizeof(w));
+    return w;
+  }
 };
 
 struct TextTimeBlobs
 {
   uint8_t number;
-  TextTimeBlob *blobs[TEXTIMEMAXBLOBSIZE];
+  TextTimeBlob blobs[TEXTIMEMAXBLOBS];
 };
 
-class TextTime
+// Layout checks, evaluated by the compiler
+constexpr bool textTimeWordsValid(const TextTimeWord *w, int n)
+{
+  return n == 0 || (w->length > 0 && w->row < NROW && w->col + w->length <= NCOL && textTimeWordsValid(w + 1, n - 1));
+}
+
+constexpr bool textTimeSpansValid(const TextTimeSpan *s, int n, int nwords, int minwords)
+{
+  return n == 0 || (s->number >= minwords && s->first + s->number <= nwords && textTimeSpansValid(s + 1, n - 1, nwords, minwords));
+}
+
+#define TEXTTIMECOUNT(a) ((int)(sizeof(a) / sizeof(a[0])))
+
+// Swiss German layout
+constexpr TextTimeWord _textTimeCHWords[] PROGMEM = {
+  { 0, 0, 2 },  //  0 ES
+  { 0, 3, 4 },  //  1 ISCH
+  // hours
+  { 9, 0, 6 },  //  2 ZWÖUFI
+  { 4, 0, 3 },  //  3 EIS
+  { 4, 4, 4 },  //  4 ZWÖI
+  { 4, 9, 3 },  //  5 DRÜ
+  { 5, 0, 5 },  //  6 VIERI
+  { 5, 6, 4 },  //  7 FÜFI
+  { 6, 0, 6 },  //  8 SÄCHSI
+  { 6, 7, 5 },  //  9 SIBNI
+  { 7, 0, 5 },  // 10 ACHTI
+  { 7, 6, 4 },  // 11 NÜNI
+  { 8, 0, 5 },  // 12 ZÄHNI
+  { 8, 6, 4 },  // 13 ÖUFI
+  // minutes
+  { 0, 9, 3 },  // 14 FÜF
+  { 3, 0, 2 },  // 15 AB
+  { 1, 9, 3 },  // 16 ZÄÄ
+  { 3, 0, 2 },  // 17 AB
+  { 1, 0, 6 },  // 18 VIERTU
+  { 3, 0, 2 },  // 19 AB
+  { 2, 0, 6 },  // 20 ZWÄNZG
+  { 3, 0, 2 },  // 21 AB
+  { 0, 9, 3 },  // 22 FÜF
+  { 2, 9, 3 },  // 23 VOR
+  { 3, 3, 5 },  // 24 HALBI
+  { 0, 9, 3 },  // 25 FÜF
+  { 2, 6, 2 },  // 26 AB
+  { 3, 3, 5 },  // 27 HALBI
+  { 2, 0, 6 },  // 28 ZWÄNZG
+  { 2, 9, 3 },  // 29 VOR
+  { 1, 0, 6 },  // 30 VIERTU
+  { 2, 9, 3 },  // 31 VOR
+  { 1, 9, 3 },  // 32 ZÄÄ
+  { 2, 9, 3 },  // 33 VOR
+  { 0, 9, 3 },  // 34 FÜF
+  { 2, 9, 3 },  // 35 VOR
+};
+
+constexpr TextTimeSpan _textTimeCHIt PROGMEM = { 0, 1 };
+constexpr TextTimeSpan _textTimeCHIs PROGMEM = { 1, 1 };
+
+// Midnight and noon share ZWÖUFI
+constexpr TextTimeSpan _textTimeCHHours[12] PROGMEM = {
+  { 2, 1 }, { 3, 1 }, { 4, 1 }, { 5, 1 }, { 6, 1 }, { 7, 1 },
+  { 8, 1 }, { 9, 1 }, { 10, 1 }, { 11, 1 }, { 12, 1 }, { 13, 1 }
+};
+
+constexpr TextTimeSpan _textTimeCHMinutes[12] PROGMEM = {
+  { 0, 0 },   // between [0:4]
+  { 14, 2 },  // between [5:9]
+  { 16, 2 },  // between [10:14]
+  { 18, 2 },  // between [15:19]
+  { 20, 2 },  // between [20:24]
+  { 22, 3 },  // between [25:29]
+  { 24, 1 },  // between [30:34]
+  { 25, 3 },  // between [35:39]
+  { 28, 2 },  // between [40:44]
+  { 30, 2 },  // between [45:49]
+  { 32, 2 },  // between [50:54]
+  { 34, 2 },  // between [55:59]
+};
+
+static_assert(textTimeWordsValid(_textTimeCHWords, TEXTTIMECOUNT(_textTimeCHWords)), "TextTimeCH: word outside of the grid");
+static_assert(textTimeSpansValid(&_textTimeCHIt, 1, TEXTTIMECOUNT(_textTimeCHWords), 1), "TextTimeCH: bad 'it' span");
+static_assert(textTimeSpansValid(&_textTimeCHIs, 1, TEXTTIMECOUNT(_textTimeCHWords), 1), "TextTimeCH: bad 'is' span");
+static_assert(textTimeSpansValid(_textTimeCHHours, TEXTTIMECOUNT(_textTimeCHHours), TEXTTIMECOUNT(_textTimeCHWords), 1), "TextTimeCH: bad hour span");
+static_assert(textTimeSpansValid(_textTimeCHMinutes, TEXTTIMECOUNT(_textTimeCHMinutes), TEXTTIMECOUNT(_textTimeCHWords), 0), "TextTimeCH: bad minute span");
+
+// Cell masks, same bit layout as PixelsArray::mask()
+#define TEXTTIMESLOTS 12
+
+// Mask of the n lowest bits of a word
+constexpr uint32_t textTimeLowBits(int n)
+{
+  return n <= 0 ? 0 : n >= 32 ? 0xFFFFFFFF : (1UL << n) - 1;
+}
+
+// Bits of the cells [first:first+length[ in the mask word starting at cell base
+constexpr uint32_t textTimeRunBits(int first, int length, int base)
 {
-protected:
-  TextTimeBlob _it;
-  TextTimeBlob _is;
-  TextTimeBlob _hours[13];
-  TextTimeBlob _hour1;
-  TextTimeBlob _hour2;
-  TextTimeBlob _minutes[13];
+  return textTimeLowBits(first + length - base) & ~textTimeLowBits(first - base);
+}
 
+constexpr uint32_t textTimeWordsBits(const TextTimeWord *w, int n, int base)
+{
+  return n == 0 ? 0 : textTimeRunBits(w->row * NCOL + w->col, w->length, base) | textTimeWordsBits(w + 1, n - 1, base);
+}
+
+constexpr uint32_t textTimeCHSpanBits(const TextTimeSpan &s, int base)
+{
+  return textTimeWordsBits(_textTimeCHWords + s.first, s.number, base);
+}
+
+// Mask word i of the slot (hour word h, minute phrase m)
+constexpr uint32_t textTimeCHMaskWord(int h, int m, int i)
+{
+  return textTimeCHSpanBits(_textTimeCHIt, i * 32) | textTimeCHSpanBits(_textTimeCHIs, i * 32)
+    | textTimeCHSpanBits(_textTimeCHHours[h], i * 32) | textTimeCHSpanBits(_textTimeCHMinutes[m], i * 32);
+}
+
+static_assert(NPIXELSMASK == 4, "TextTimeCH: mask table expects 4 words");
+
+#define TEXTTIMECHSLOT(h, m) { textTimeCHMaskWord(h, m, 0), textTimeCHMaskWord(h, m, 1), textTimeCHMaskWord(h, m, 2), textTimeCHMaskWord(h, m, 3) }
+#define TEXTTIMECHHOUR(h) { \
+  TEXTTIMECHSLOT(h, 0), TEXTTIMECHSLOT(h, 1), TEXTTIMECHSLOT(h, 2), TEXTTIMECHSLOT(h, 3), \
+  TEXTTIMECHSLOT(h, 4), TEXTTIMECHSLOT(h, 5), TEXTTIMECHSLOT(h, 6), TEXTTIMECHSLOT(h, 7), \
+  TEXTTIMECHSLOT(h, 8), TEXTTIMECHSLOT(h, 9), TEXTTIMECHSLOT(h, 10), TEXTTIMECHSLOT(h, 11) }
+
+// Cells lit for each (hour word, minute phrase), built by the compiler
+constexpr uint32_t _textTimeCHMasks[12][TEXTTIMESLOTS][NPIXELSMASK] PROGMEM = {
+  TEXTTIMECHHOUR(0), TEXTTIMECHHOUR(1), TEXTTIMECHHOUR(2), TEXTTIMECHHOUR(3),
+  TEXTTIMECHHOUR(4), TEXTTIMECHHOUR(5), TEXTTIMECHHOUR(6), TEXTTIMECHHOUR(7),
+  TEXTTIMECHHOUR(8), TEXTTIMECHHOUR(9), TEXTTIMECHHOUR(10), TEXTTIMECHHOUR(11)
+};
+
+// ES ISCH FÜF VOR HALBI ÖUFI
+static_assert(_textTimeCHMasks[11][5][0] == ((0x3UL << 0) | (0xFUL << 3) | (0x7UL << 9)), "TextTimeCH: bad mask");
+static_assert(_textTimeCHMasks[11][5][1] == ((0x7UL << 1) | (0x1FUL << 7)), "TextTimeCH: bad mask");
+static_assert(_textTimeCHMasks[11][5][3] == (0xFUL << 6), "TextTimeCH: bad mask");
+
+// Letters of the grid, umlauts folded to their base letter, '.' for the cells between words
+constexpr char _textTimeCHGrid[] PROGMEM =
+  "ES.ISCH..FUF"
+  "VIERTU...ZAA"
+  "ZWANZGAB.VOR"
+  "AB.HALBI...."
+  "EIS.ZWOI.DRU"
+  "VIERI.FUFI.."
+  "SACHSI.SIBNI"
+  "ACHTI.NUNI.."
+  "ZAHNI.OUFI.."
+  "ZWOUFI......";
+
+static_assert(sizeof(_textTimeCHGrid) == NROW * NCOL + 1, "TextTimeCH: grid size");
+
+constexpr bool textTimeGridRunValid(const char *g, int first, int length)
+{
+  return length == 0 || (g[first] != '.' && textTimeGridRunValid(g, first + 1, length - 1));
+}
+
+constexpr bool textTimeGridWordsValid(const char *g, const TextTimeWord *w, int n)
+{
+  return n == 0 || (textTimeGridRunValid(g, w->row * NCOL + w->col, w->length) && textTimeGridWordsValid(g, w + 1, n - 1));
+}
+
+static_assert(textTimeGridWordsValid(_textTimeCHGrid, _textTimeCHWords, TEXTTIMECOUNT(_textTimeCHWords)), "TextTimeCH: word on an empty cell of the grid");
+
+// Bits of the cells holding the letter c in the mask word starting at cell base
+constexpr uint32_t textTimeGridBits(const char *g, char c, int base, int n)
+{
+  return (n == 32 || base + n >= NROW * NCOL) ? 0
+    : ((g[base + n] == c) ? (1UL << n) : 0) | textTimeGridBits(g, c, base, n + 1);
+}
+
+#define TEXTTIMECHLETTER(c) { textTimeGridBits(_textTimeCHGrid, c, 0, 0), textTimeGridBits(_textTimeCHGrid, c, 32, 0), \
+  textTimeGridBits(_textTimeCHGrid, c, 64, 0), textTimeGridBits(_textTimeCHGrid, c, 96, 0) }
+
+// Cells of each letter from A to Z, built by the compiler
+constexpr uint32_t _textTimeCHLetters[26][NPIXELSMASK] PROGMEM = {
+  TEXTTIMECHLETTER('A'), TEXTTIMECHLETTER('B'), TEXTTIMECHLETTER('C'), TEXTTIMECHLETTER('D'),
+  TEXTTIMECHLETTER('E'), TEXTTIMECHLETTER('F'), TEXTTIMECHLETTER('G'), TEXTTIMECHLETTER('H'),
+  TEXTTIMECHLETTER('I'), TEXTTIMECHLETTER('J'), TEXTTIMECHLETTER('K'), TEXTTIMECHLETTER('L'),
+  TEXTTIMECHLETTER('M'), TEXTTIMECHLETTER('N'), TEXTTIMECHLETTER('O'), TEXTTIMECHLETTER('P'),
+  TEXTTIMECHLETTER('Q'), TEXTTIMECHLETTER('R'), TEXTTIMECHLETTER('S'), TEXTTIMECHLETTER('T'),
+  TEXTTIMECHLETTER('U'), TEXTTIMECHLETTER('V'), TEXTTIMECHLETTER('W'), TEXTTIMECHLETTER('X'),
+  TEXTTIMECHLETTER('Y'), TEXTTIMECHLETTER('Z')
+};
+
+// E: ES, VIERTU, EIS, VIERI
+static_assert(_textTimeCHLetters['E' - 'A'][0] == ((1UL << 0) | (1UL << 14)), "TextTimeCH: bad letter index");
+static_assert(_textTimeCHLetters['E' - 'A'][1] == ((1UL << (48 - 32)) | (1UL << (62 - 32))), "TextTimeCH: bad letter index");
+static_assert(_textTimeCHLetters['E' - 'A'][2] == 0 && _textTimeCHLetters['E' - 'A'][3] == 0, "TextTimeCH: bad letter index");
+
+class TextTime
+{
 public:
   virtual TextTimeBlobs getBlobsFromTime(int hour, int minute) = 0;
-  virtual cl_Lst<TextTimePixel> getPixelsFromLetter(char c) = 0;
+  // Cells of the time, false if the time is invalid
+  virtual bool getMaskFromTime(int hour, int minute, uint32_t *mask) = 0;
+  // First cell after the cell from holding the letter c (A to Z), -1 if none
+  virtual int getNextLetterCell(char c, int from) = 0;
+  virtual String getName() = 0;
+
+  // Cells switched on or off between two times
+  bool getMaskChange(int hour1, int minute1, int hour2, int minute2, uint32_t *mask)
+  {
+    uint32_t m2[NPIXELSMASK];
+
+    if (!getMaskFromTime(hour1, minute1, mask)) return false;
+    if (!getMaskFromTime(hour2, minute2, m2)) return false;
+
+    for (int i = 0; i < NPIXELSMASK; i++)
+      mask[i] ^= m2[i];
+    return true;
+  }
 };
 
 class TextTimeCH: public TextTime
 {
+private:
+  static TextTimeBlob blob(const TextTimeSpan *pSpan)
+  {
+    TextTimeSpan s;
+    memcpy_P(&s, pSpan, sizeof(s));
+
+    TextTimeBlob b;
+    b.words = _textTimeCHWords + s.first;
+    b.number = s.number;
+    return b;
+  }
 
 public:
 
-  TextTimeCH()
+  // Displayed hour word and minute phrase of a time
+  static bool getSlot(int hour, int minute, int &h, int &m)
   {
-    _it.number = 2;
-    _it.pixels[0].row = 0; _it.pixels[0].col = 0; // E
-    _it.pixels[1].row = 0; _it.pixels[1].col = 1; // S
-
-    _is.number = 4;
-    _is.pixels[0].row = 0; _is.pixels[0].col = 3; // I
-    _is.pixels[1].row = 0; _is.pixels[1].col = 4; // S
-    _is.pixels[2].row = 0; _is.pixels[2].col = 5; // C
-    _is.pixels[3].row = 0; _is.pixels[3].col = 6; // H
- 
-    _hours[0].number = 6;
-    _hours[0].pixels[0].row = 10; _hours[0].pixels[0].col = 0;  // Z
-    _hours[0].pixels[1].row = 10; _hours[0].pixels[1].col = 1;  // W
-    _hours[0].pixels[2].row = 10; _hours[0].pixels[2].col = 2;  // Ö
-    _hours[0].pixels[3].row = 10; _hours[0].pixels[3].col = 3;  // U
-    _hours[0].pixels[4].row = 10; _hours[0].pixels[4].col = 4;  // F
-    _hours[0].pixels[5].row = 10; _hours[0].pixels[5].col = 5;  // I
-
-    _hours[1].number = 3;
-    _hours[1].pixels[0].row = 4; _hours[1].pixels[0].col = 0;  // E
-    _hours[1].pixels[1].row = 4; _hours[1].pixels[1].col = 1;  // I
-    _hours[1].pixels[2].row = 4; _hours[1].pixels[2].col = 2;  // S
-
-    _hours[2].number = 4;
-    _hours[2].pixels[0].row = 4; _hours[2].pixels[0].col = 4;  // Z
-    _hours[2].pixels[1].row = 4; _hours[2].pixels[1].col = 5;  // W
-    _hours[2].pixels[2].row = 4; _hours[2].pixels[2].col = 6;  // Ö
-    _hours[2].pixels[3].row = 4; _hours[2].pixels[3].col = 7;  // I
-
-    _hours[3].number = 3;
-    _hours[3].pixels[0].row = 4; _hours[3].pixels[0].col = 9;   // D
-    _hours[3].pixels[1].row = 4; _hours[3].pixels[1].col = 10;  // R
-    _hours[3].pixels[2].row = 4; _hours[3].pixels[2].col = 11;  // Ü
-    
-    _hours[4].number = 5;
-    _hours[4].pixels[0].row = 5; _hours[4].pixels[0].col = 0;  // V
-    _hours[4].pixels[1].row = 5; _hours[4].pixels[1].col = 1;  // I
-    _hours[4].pixels[2].row = 5; _hours[4].pixels[2].col = 2;  // E
-    _hours[4].pixels[3].row = 5; _hours[4].pixels[3].col = 3;  // R
-    _hours[4].pixels[4].row = 5; _hours[4].pixels[4].col = 4;  // I
-
-    _hours[5].number = 4;
-    _hours[5].pixels[0].row = 5; _hours[5].pixels[0].col = 6;  // F
-    _hours[5].pixels[1].row = 5; _hours[5].pixels[1].col = 7;  // Ü
-    _hours[5].pixels[2].row = 5; _hours[5].pixels[2].col = 8;  // F
-    _hours[5].pixels[3].row = 5; _hours[5].pixels[3].col = 9;  // I
-
-    _hours[6].number = 6;
-    _hours[6].pixels[0].row = 6; _hours[6].pixels[0].col = 0;  // S
-    _hours[6].pixels[1].row = 6; _hours[6].pixels[1].col = 1;  // Ä
-    _hours[6].pixels[2].row = 6; _hours[6].pixels[2].col = 2;  // C
-    _hours[6].pixels[3].row = 6; _hours[6].pixels[3].col = 3;  // H
-    _hours[6].pixels[4].row = 6; _hours[6].pixels[4].col = 4;  // S
-    _hours[6].pixels[5].row = 6; _hours[6].pixels[5].col = 5;  // I
-
-
-    _hours[7].number = 5;
-    _hours[7].pixels[0].row = 6; _hours[7].pixels[0].col = 7;  // S
-    _hours[7].pixels[1].row = 6; _hours[7].pixels[1].col = 8;  // I
-    _hours[7].pixels[2].row = 6; _hours[7].pixels[2].col = 9;  // B
-    _hours[7].pixels[3].row = 6; _hours[7].pixels[3].col = 10; // N
-    _hours[7].pixels[4].row = 6; _hours[7].pixels[4].col = 11; // I
-
-    _hours[8].number = 5;
-    _hours[8].pixels[0].row = 7; _hours[8].pixels[0].col = 0;  // A
-    _hours[8].pixels[1].row = 7; _hours[8].pixels[1].col = 1;  // C
-    _hours[8].pixels[2].row = 7; _hours[8].pixels[2].col = 2;  // H
-    _hours[8].pixels[3].row = 7; _hours[8].pixels[3].col = 3;  // T
-    _hours[8].pixels[4].row = 7; _hours[8].pixels[4].col = 4;  // I
-
-    _hours[9].number = 4;
-    _hours[9].pixels[0].row = 7; _hours[9].pixels[0].col = 6;  // N
-    _hours[9].pixels[1].row = 7; _hours[9].pixels[1].col = 7;  // Ü
-    _hours[9].pixels[2].row = 7; _hours[9].pixels[2].col = 8;  // N
-    _hours[9].pixels[3].row = 7; _hours[9].pixels[3].col = 9;  // I
-
-    _hours[10].number = 5;
-    _hours[10].pixels[0].row = 8; _hours[10].pixels[0].col = 0;  // Z
-    _hours[10].pixels[1].row = 8; _hours[10].pixels[1].col = 1;  // Ä
-    _hours[10].pixels[2].row = 8; _hours[10].pixels[2].col = 2;  // H
-    _hours[10].pixels[3].row = 8; _hours[10].pixels[3].col = 3;  // N
-    _hours[10].pixels[4].row = 8; _hours[10].pixels[4].col = 4;  // I
-    
-
-    _hours[11].number = 4;
-    _hours[11].pixels[0].row = 8; _hours[11].pixels[0].col = 6;  // Ö
-    _hours[11].pixels[1].row = 8; _hours[11].pixels[1].col = 7;  // U
-    _hours[11].pixels[2].row = 8; _hours[11].pixels[2].col = 8;  // F
-    _hours[11].pixels[3].row = 8; _hours[11].pixels[3].col = 9;  // I
-
-    _hours[12].number = 6;
-    _hours[12].pixels[0].row = 9; _hours[12].pixels[0].col = 0;  // Z
-    _hours[12].pixels[1].row = 9; _hours[12].pixels[1].col = 1;  // W
-    _hours[12].pixels[2].row = 9; _hours[12].pixels[2].col = 2;  // Ö
-    _hours[12].pixels[3].row = 9; _hours[12].pixels[3].col = 3;  // U
-    _hours[12].pixels[4].row = 9; _hours[12].pixels[4].col = 4;  // F
-    _hours[12].pixels[5].row = 9; _hours[12].pixels[5].col = 5;  // I
-
-    _hour1.number = 5;
-    _hour1.pixels[0].row = 5; _hour1.pixels[0].col = 5;  // H
-    _hour1.pixels[1].row = 5; _hour1.pixels[1].col = 6;  // E
-    _hour1.pixels[2].row = 5; _hour1.pixels[2].col = 7;  // U
-    _hour1.pixels[3].row = 5; _hour1.pixels[3].col = 8;  // R
-    _hour1.pixels[4].row = 5; _hour1.pixels[4].col = 9;  // E
- 
-    _hour2.number = 6;
-    _hour2.pixels[0].row = 5; _hour2.pixels[0].col = 5;  // H
-    _hour2.pixels[1].row = 5; _hour2.pixels[1].col = 6;  // E
-    _hour2.pixels[2].row = 5; _hour2.pixels[2].col = 7;  // U
-    _hour2.pixels[3].row = 5; _hour2.pixels[3].col = 8;  // R
-    _hour2.pixels[4].row = 5; _hour2.pixels[4].col = 9;  // E
-    _hour2.pixels[5].row = 5; _hour2.pixels[5].col = 10; // S
-
-    _minutes[0].number = 0; // between [0:4]
-
-    _minutes[1].number = 5; // between [5:9]
-    _minutes[1].pixels[0].row = 0; _minutes[1].pixels[0].col = 9;  // F
-    _minutes[1].pixels[1].row = 0; _minutes[1].pixels[1].col = 10; // Ü
-    _minutes[1].pixels[2].row = 0; _minutes[1].pixels[2].col = 11; // F
-    _minutes[1].pixels[3].row = 3; _minutes[1].pixels[3].col = 0;  // A
-    _minutes[1].pixels[4].row = 3; _minutes[1].pixels[4].col = 1;  // B
-
-    _minutes[2].number = 5; // between [10:14]
-    _minutes[2].pixels[0].row = 1; _minutes[2].pixels[0].col = 9;  // Z
-    _minutes[2].pixels[1].row = 1; _minutes[2].pixels[1].col = 10; // Ä
-    _minutes[2].pixels[2].row = 1; _minutes[2].pixels[2].col = 11; // Ä
-    _minutes[2].pixels[3].row = 3; _minutes[2].pixels[3].col = 0;  // A
-    _minutes[2].pixels[4].row = 3; _minutes[2].pixels[4].col = 1;  // B
-
-    _minutes[3].number = 8; // between [15:19]
-    _minutes[3].pixels[0].row = 1; _minutes[3].pixels[0].col = 0;  // V
-    _minutes[3].pixels[1].row = 1; _minutes[3].pixels[1].col = 1;  // I
-    _minutes[3].pixels[2].row = 1; _minutes[3].pixels[2].col = 2;  // E
-    _minutes[3].pixels[3].row = 1; _minutes[3].pixels[3].col = 3;  // R
-    _minutes[3].pixels[4].row = 1; _minutes[3].pixels[4].col = 4;  // T
-    _minutes[3].pixels[5].row = 1; _minutes[3].pixels[5].col = 5;  // U
-    _minutes[3].pixels[6].row = 3; _minutes[3].pixels[6].col = 0;  // A
-    _minutes[3].pixels[7].row = 3; _minutes[3].pixels[7].col = 1;  // B
-
-    _minutes[4].number = 8; // between [20:24]
-    _minutes[4].pixels[0].row = 2; _minutes[4].pixels[0].col = 0;  // Z
-    _minutes[4].pixels[1].row = 2; _minutes[4].pixels[1].col = 1;  // W
-    _minutes[4].pixels[2].row = 2; _minutes[4].pixels[2].col = 2;  // Ä
-    _minutes[4].pixels[3].row = 2; _minutes[4].pixels[3].col = 3;  // N
-    _minutes[4].pixels[4].row = 2; _minutes[4].pixels[4].col = 4;  // Z
-    _minutes[4].pixels[5].row = 2; _minutes[4].pixels[5].col = 5;  // G
-    _minutes[4].pixels[6].row = 3; _minutes[4].pixels[6].col = 0;  // A
-    _minutes[4].pixels[7].row = 3; _minutes[4].pixels[7].col = 1;  // B
-
-    _minutes[5].number = 11;// between [25:29]
-    _minutes[5].pixels[0].row = 0; _minutes[5].pixels[0].col = 9;  // F
-    _minutes[5].pixels[1].row = 0; _minutes[5].pixels[1].col = 10; // Ü
-    _minutes[5].pixels[2].row = 0; _minutes[5].pixels[2].col = 11; // F
-    _minutes[5].pixels[3].row = 2; _minutes[5].pixels[3].col = 9;  // V
-    _minutes[5].pixels[4].row = 2; _minutes[5].pixels[4].col = 10; // O
-    _minutes[5].pixels[5].row = 2; _minutes[5].pixels[5].col = 11; // R
-    _minutes[5].pixels[6].row = 3; _minutes[5].pixels[6].col = 3;  // H
-    _minutes[5].pixels[7].row = 3; _minutes[5].pixels[7].col = 4;  // A
-    _minutes[5].pixels[8].row = 3; _minutes[5].pixels[8].col = 5;  // U
-    _minutes[5].pixels[9].row = 3; _minutes[5].pixels[9].col = 6;  // B
-    _minutes[5].pixels[10].row = 3; _minutes[5].pixels[10].col = 7;// I
-
-    _minutes[6].number = 5; // between [30:34]
-    _minutes[6].pixels[0].row = 3; _minutes[6].pixels[0].col = 3;  // H
-    _minutes[6].pixels[1].row = 3; _minutes[6].pixels[1].col = 4;  // A
-    _minutes[6].pixels[2].row = 3; _minutes[6].pixels[2].col = 5;  // U
-    _minutes[6].pixels[3].row = 3; _minutes[6].pixels[3].col = 6;  // B
-    _minutes[6].pixels[4].row = 3; _minutes[6].pixels[4].col = 7;  // I
-    
-    _minutes[7].number = 10; // between [35:39]
-    _minutes[7].pixels[0].row = 0; _minutes[7].pixels[0].col = 9;  // F
-    _minutes[7].pixels[1].row = 0; _minutes[7].pixels[1].col = 10; // Ü
-    _minutes[7].pixels[2].row = 0; _minutes[7].pixels[2].col = 11; // F
-    _minutes[7].pixels[3].row = 2; _minutes[7].pixels[3].col = 6;  // A
-    _minutes[7].pixels[4].row = 2; _minutes[7].pixels[4].col = 7;  // B
-    _minutes[7].pixels[5].row = 3; _minutes[7].pixels[5].col = 3;  // H
-    _minutes[7].pixels[6].row = 3; _minutes[7].pixels[6].col = 4;  // A
-    _minutes[7].pixels[7].row = 3; _minutes[7].pixels[7].col = 5;  // U
-    _minutes[7].pixels[8].row = 3; _minutes[7].pixels[8].col = 6;  // B
-    _minutes[7].pixels[9].row = 3; _minutes[7].pixels[9].col = 7;  // I
-
-    _minutes[8].number = 9; // between [40:44]
-    _minutes[8].pixels[0].row = 2; _minutes[8].pixels[0].col = 0;  // Z
-    _minutes[8].pixels[1].row = 2; _minutes[8].pixels[1].col = 1;  // W
-    _minutes[8].pixels[2].row = 2; _minutes[8].pixels[2].col = 2;  // Ä
-    _minutes[8].pixels[3].row = 2; _minutes[8].pixels[3].col = 3;  // N
-    _minutes[8].pixels[4].row = 2; _minutes[8].pixels[4].col = 4;  // Z
-    _minutes[8].pixels[5].row = 2; _minutes[8].pixels[5].col = 5;  // G
-    _minutes[8].pixels[6].row = 2; _minutes[8].pixels[6].col = 9;  // V
-    _minutes[8].pixels[7].row = 2; _minutes[8].pixels[7].col = 10; // O
-    _minutes[8].pixels[8].row = 2; _minutes[8].pixels[8].col = 11; // R
-
-    _minutes[9].number = 9; // between [45:49]
-    _minutes[9].pixels[0].row = 1; _minutes[9].pixels[0].col = 0;  // V
-    _minutes[9].pixels[1].row = 1; _minutes[9].pixels[1].col = 1;  // I
-    _minutes[9].pixels[2].row = 1; _minutes[9].pixels[2].col = 2;  // E
-    _minutes[9].pixels[3].row = 1; _minutes[9].pixels[3].col = 3;  // R
-    _minutes[9].pixels[4].row = 1; _minutes[9].pixels[4].col = 4;  // T
-    _minutes[9].pixels[5].row = 1; _minutes[9].pixels[5].col = 5;  // U
-    _minutes[9].pixels[6].row = 2; _minutes[9].pixels[6].col = 9;  // V
-    _minutes[9].pixels[7].row = 2; _minutes[9].pixels[7].col = 10; // O
-    _minutes[9].pixels[8].row = 2; _minutes[9].pixels[8].col = 11; // R
-
-    _minutes[10].number = 6; // between [50:54]
-    _minutes[10].pixels[0].row = 1; _minutes[10].pixels[0].col = 9;  // Z
-    _minutes[10].pixels[1].row = 1; _minutes[10].pixels[1].col = 10; // Ä
-    _minutes[10].pixels[2].row = 1; _minutes[10].pixels[2].col = 11; // Ä
-    _minutes[10].pixels[3].row = 2; _minutes[10].pixels[3].col = 9;  // V
-    _minutes[10].pixels[4].row = 2; _minutes[10].pixels[4].col = 10; // O
-    _minutes[10].pixels[5].row = 2; _minutes[10].pixels[5].col = 11; // R
-
-    _minutes[11].number = 6; // between [55:59]
-    _minutes[11].pixels[0].row = 0; _minutes[11].pixels[0].col = 9;  // F
-    _minutes[11].pixels[1].row = 0; _minutes[11].pixels[1].col = 10; // ü
-    _minutes[11].pixels[2].row = 0; _minutes[11].pixels[2].col = 11; // F
-    _minutes[11].pixels[3].row = 2; _minutes[11].pixels[3].col = 9;  // V
-    _minutes[11].pixels[4].row = 2; _minutes[11].pixels[4].col = 10; // O
-    _minutes[11].pixels[5].row = 2; _minutes[11].pixels[5].col = 11; // R
-
-    _minutes[12].number = 6; // between [30:34] (special for midday and midnight)
-    _minutes[12].pixels[0].row = 9; _minutes[12].pixels[0].col = 0;  // Z
-    _minutes[12].pixels[1].row = 9; _minutes[12].pixels[1].col = 1;  // W
-    _minutes[12].pixels[2].row = 9; _minutes[12].pixels[2].col = 3;  // Ö
-    _minutes[12].pixels[3].row = 9; _minutes[12].pixels[3].col = 4;  // U
-    _minutes[12].pixels[4].row = 9; _minutes[12].pixels[4].col = 5;  // F
-    _minutes[12].pixels[5].row = 9; _minutes[12].pixels[5].col = 6;  // I
-  }
+    if (hour < 0 || hour > 23) return false;
+    if (minute < 0 || minute > 59) return false;
 
-  /*TextTimeFr()
-  {
-    _it.number = 2;
-    _it.pixels[0].row = 0; _it.pixels[0].col = 0; // I
-    _it.pixels[1].row = 0; _it.pixels[1].col = 1; // L
-
-    _is.number = 3;
-    _is.pixels[0].row = 0; _is.pixels[0].col = 3; // E
-    _is.pixels[1].row = 0; _is.pixels[1].col = 4; // S
-    _is.pixels[2].row = 0; _is.pixels[2].col = 5; // T
-
-    _hours[0].number = 6;
-    _hours[0].pixels[0].row = 4; _hours[0].pixels[0].col = 5;  // M
-    _hours[0].pixels[1].row = 4; _hours[0].pixels[1].col = 6;  // I
-    _hours[0].pixels[2].row = 4; _hours[0].pixels[2].col = 7;  // N
-    _hours[0].pixels[3].row = 4; _hours[0].pixels[3].col = 8;  // U
-    _hours[0].pixels[4].row = 4; _hours[0].pixels[4].col = 9;  // I
-    _hours[0].pixels[5].row = 4; _hours[0].pixels[5].col = 10; // T
-
-    _hours[1].number = 3;
-    _hours[1].pixels[0].row = 2; _hours[1].pixels[0].col = 4;  // U
-    _hours[1].pixels[1].row = 2; _hours[1].pixels[1].col = 5;  // N
-    _hours[1].pixels[2].row = 2; _hours[1].pixels[2].col = 6;  // E
-
-    _hours[2].number = 4;
-    _hours[2].pixels[0].row = 0; _hours[2].pixels[0].col = 7;  // D
-    _hours[2].pixels[1].row = 0; _hours[2].pixels[1].col = 8;  // E
-    _hours[2].pixels[2].row = 0; _hours[2].pixels[2].col = 9;  // U
-    _hours[2].pixels[3].row = 0; _hours[2].pixels[3].col = 10; // X
-
-    _hours[3].number = 5;
-    _hours[3].pixels[0].row = 1; _hours[3].pixels[0].col = 6;  // T
-    _hours[3].pixels[1].row = 1; _hours[3].pixels[1].col = 7;  // R
-    _hours[3].pixels[2].row = 1; _hours[3].pixels[2].col = 8;  // O
-    _hours[3].pixels[3].row = 1; _hours[3].pixels[3].col = 9;  // I
-    _hours[3].pixels[4].row = 1; _hours[3].pixels[4].col = 10; // S
-
-    _hours[4].number = 6;
-    _hours[4].pixels[0].row = 1; _hours[4].pixels[0].col = 0;  // Q
-    _hours[4].pixels[1].row = 1; _hours[4].pixels[1].col = 1;  // U
-    _hours[4].pixels[2].row = 1; _hours[4].pixels[2].col = 2;  // A
-    _hours[4].pixels[3].row = 1; _hours[4].pixels[3].col = 3;  // T
-    _hours[4].pixels[4].row = 1; _hours[4].pixels[4].col = 4;  // R
-    _hours[4].pixels[5].row = 1; _hours[4].pixels[5].col = 5;  // E
-
-    _hours[5].number = 4;
-    _hours[5].pixels[0].row = 3; _hours[5].pixels[0].col = 7;  // C
-    _hours[5].pixels[1].row = 3; _hours[5].pixels[1].col = 8;  // I
-    _hours[5].pixels[2].row = 3; _hours[5].pixels[2].col = 9;  // N
-    _hours[5].pixels[3].row = 3; _hours[5].pixels[3].col = 10; // Q
-
-    _hours[6].number = 3;
-    _hours[6].pixels[0].row = 3; _hours[6].pixels[0].col = 4;  // S
-    _hours[6].pixels[1].row = 3; _hours[6].pixels[1].col = 5;  // I
-    _hours[6].pixels[2].row = 3; _hours[6].pixels[2].col = 6;  // X
-
-    _hours[7].number = 4;
-    _hours[7].pixels[0].row = 2; _hours[7].pixels[0].col = 7;  // S
-    _hours[7].pixels[1].row = 2; _hours[7].pixels[1].col = 8;  // E
-    _hours[7].pixels[2].row = 2; _hours[7].pixels[2].col = 9;  // P
-    _hours[7].pixels[3].row = 2; _hours[7].pixels[3].col = 10; // T
-
-    _hours[8].number = 4;
-    _hours[8].pixels[0].row = 3; _hours[8].pixels[0].col = 0;  // H
-    _hours[8].pixels[1].row = 3; _hours[8].pixels[1].col = 1;  // U
-    _hours[8].pixels[2].row = 3; _hours[8].pixels[2].col = 2;  // I
-    _hours[8].pixels[3].row = 3; _hours[8].pixels[3].col = 3;  // T
-
-    _hours[9].number = 4;
-    _hours[9].pixels[0].row = 2; _hours[9].pixels[0].col = 0;  // N
-    _hours[9].pixels[1].row = 2; _hours[9].pixels[1].col = 1;  // E
-    _hours[9].pixels[2].row = 2; _hours[9].pixels[2].col = 2;  // U
-    _hours[9].pixels[3].row = 2; _hours[9].pixels[3].col = 3;  // F
-
-    _hours[10].number = 3;
-    _hours[10].pixels[0].row = 4; _hours[10].pixels[0].col = 2;  // D
-    _hours[10].pixels[1].row = 4; _hours[10].pixels[1].col = 3;  // I
-    _hours[10].pixels[2].row = 4; _hours[10].pixels[2].col = 4;  // X
-
-    _hours[11].number = 4;
-    _hours[11].pixels[0].row = 5; _hours[11].pixels[0].col = 0;  // O
-    _hours[11].pixels[1].row = 5; _hours[11].pixels[1].col = 1;  // N
-    _hours[11].pixels[2].row = 5; _hours[11].pixels[2].col = 2;  // Z
-    _hours[11].pixels[3].row = 5; _hours[11].pixels[3].col = 3;  // E
-
-    _hours[12].number = 4;
-    _hours[12].pixels[0].row = 4; _hours[12].pixels[0].col = 0;  // M
-    _hours[12].pixels[1].row = 4; _hours[12].pixels[1].col = 1;  // I
-    _hours[12].pixels[2].row = 4; _hours[12].pixels[2].col = 2;  // D
-    _hours[12].pixels[3].row = 4; _hours[12].pixels[3].col = 3;  // I
-
-    _hour1.number = 5;
-    _hour1.pixels[0].row = 5; _hour1.pixels[0].col = 5;  // H
-    _hour1.pixels[1].row = 5; _hour1.pixels[1].col = 6;  // E
-    _hour1.pixels[2].row = 5; _hour1.pixels[2].col = 7;  // U
-    _hour1.pixels[3].row = 5; _hour1.pixels[3].col = 8;  // R
-    _hour1.pixels[4].row = 5; _hour1.pixels[4].col = 9;  // E
- 
-    _hour2.number = 6;
-    _hour2.pixels[0].row = 5; _hour2.pixels[0].col = 5;  // H
-    _hour2.pixels[1].row = 5; _hour2.pixels[1].col = 6;  // E
-    _hour2.pixels[2].row = 5; _hour2.pixels[2].col = 7;  // U
-    _hour2.pixels[3].row = 5; _hour2.pixels[3].col = 8;  // R
-    _hour2.pixels[4].row = 5; _hour2.pixels[4].col = 9;  // E
-    _hour2.pixels[5].row = 5; _hour2.pixels[5].col = 10; // S
-
-    _minutes[0].number = 0; // between [0:4]
-
-    _minutes[1].number = 4; // between [5:9]
-    _minutes[1].pixels[0].row = 8; _minutes[1].pixels[0].col = 6;  // C
-    _minutes[1].pixels[1].row = 8; _minutes[1].pixels[1].col = 7;  // I
-    _minutes[1].pixels[2].row = 8; _minutes[1].pixels[2].col = 8;  // N
-    _minutes[1].pixels[3].row = 8; _minutes[1].pixels[3].col = 9;  // Q
-
-    _minutes[2].number = 3; // between [10:14]
-    _minutes[2].pixels[0].row = 6; _minutes[2].pixels[0].col = 8;  // D
-    _minutes[2].pixels[1].row = 6; _minutes[2].pixels[1].col = 9;  // I
-    _minutes[2].pixels[2].row = 6; _minutes[2].pixels[2].col = 10; // X
-
-    _minutes[3].number = 7; // between [15:19]
-    _minutes[3].pixels[0].row = 7; _minutes[3].pixels[0].col = 0;  // E
-    _minutes[3].pixels[1].row = 7; _minutes[3].pixels[1].col = 1;  // T
-    _minutes[3].pixels[2].row = 7; _minutes[3].pixels[2].col = 3;  // Q
-    _minutes[3].pixels[3].row = 7; _minutes[3].pixels[3].col = 4;  // U
-    _minutes[3].pixels[4].row = 7; _minutes[3].pixels[4].col = 5;  // A
-    _minutes[3].pixels[5].row = 7; _minutes[3].pixels[5].col = 6;  // R
-    _minutes[3].pixels[6].row = 7; _minutes[3].pixels[6].col = 7;  // T
-
-    _minutes[4].number = 5; // between [20:24]
-    _minutes[4].pixels[0].row = 8; _minutes[4].pixels[0].col = 0;  // V
-    _minutes[4].pixels[1].row = 8; _minutes[4].pixels[1].col = 1;  // I
-    _minutes[4].pixels[2].row = 8; _minutes[4].pixels[2].col = 2;  // N
-    _minutes[4].pixels[3].row = 8; _minutes[4].pixels[3].col = 3;  // G
-    _minutes[4].pixels[4].row = 8; _minutes[4].pixels[4].col = 4;  // T
-
-    _minutes[5].number = 10;// between [25:29]
-    _minutes[5].pixels[0].row = 8; _minutes[5].pixels[0].col = 0;  // V
-    _minutes[5].pixels[1].row = 8; _minutes[5].pixels[1].col = 1;  // I
-    _minutes[5].pixels[2].row = 8; _minutes[5].pixels[2].col = 2;  // N
-    _minutes[5].pixels[3].row = 8; _minutes[5].pixels[3].col = 3;  // G
-    _minutes[5].pixels[4].row = 8; _minutes[5].pixels[4].col = 4;  // T
-    _minutes[5].pixels[5].row = 8; _minutes[5].pixels[5].col = 5;  // -
-    _minutes[5].pixels[6].row = 8; _minutes[5].pixels[6].col = 6;  // C
-    _minutes[5].pixels[7].row = 8; _minutes[5].pixels[7].col = 7;  // I
-    _minutes[5].pixels[8].row = 8; _minutes[5].pixels[8].col = 8;  // N
-    _minutes[5].pixels[9].row = 8; _minutes[5].pixels[9].col = 9;  // Q
-
-    _minutes[6].number = 7; // between [30:34]
-    _minutes[6].pixels[0].row = 9; _minutes[6].pixels[0].col = 0;  // E
-    _minutes[6].pixels[1].row = 9; _minutes[6].pixels[1].col = 1;  // T
-    _minutes[6].pixels[2].row = 9; _minutes[6].pixels[2].col = 3;  // D
-    _minutes[6].pixels[3].row = 9; _minutes[6].pixels[3].col = 4;  // E
-    _minutes[6].pixels[4].row = 9; _minutes[6].pixels[4].col = 5;  // M
-    _minutes[6].pixels[5].row = 9; _minutes[6].pixels[5].col = 6;  // I
-    _minutes[6].pixels[6].row = 9; _minutes[6].pixels[6].col = 7;  // E
-
-    _minutes[7].number = 15; // between [35:39]
-    _minutes[7].pixels[0].row = 6; _minutes[7].pixels[0].col = 0;  // M
-    _minutes[7].pixels[1].row = 6; _minutes[7].pixels[1].col = 1;  // O
-    _minutes[7].pixels[2].row = 6; _minutes[7].pixels[2].col = 2;  // I
-    _minutes[7].pixels[3].row = 6; _minutes[7].pixels[3].col = 3;  // N
-    _minutes[7].pixels[4].row = 6; _minutes[7].pixels[4].col = 4;  // S
-    _minutes[7].pixels[5].row = 8; _minutes[7].pixels[5].col = 0;  // V
-    _minutes[7].pixels[6].row = 8; _minutes[7].pixels[6].col = 1;  // I
-    _minutes[7].pixels[7].row = 8; _minutes[7].pixels[7].col = 2;  // N
-    _minutes[7].pixels[8].row = 8; _minutes[7].pixels[8].col = 3;  // G
-    _minutes[7].pixels[9].row = 8; _minutes[7].pixels[9].col = 4;  // T
-    _minutes[7].pixels[10].row = 8; _minutes[7].pixels[10].col = 5;// -
-    _minutes[7].pixels[11].row = 8; _minutes[7].pixels[11].col = 6;// C
-    _minutes[7].pixels[12].row = 8; _minutes[7].pixels[12].col = 7;// I
-    _minutes[7].pixels[13].row = 8; _minutes[7].pixels[13].col = 8;// N
-    _minutes[7].pixels[14].row = 8; _minutes[7].pixels[14].col = 9;// Q
-
-    _minutes[8].number = 10; // between [40:44]
-    _minutes[8].pixels[0].row = 6; _minutes[8].pixels[0].col = 0;  // M
-    _minutes[8].pixels[1].row = 6; _minutes[8].pixels[1].col = 1;  // O
-    _minutes[8].pixels[2].row = 6; _minutes[8].pixels[2].col = 2;  // I
-    _minutes[8].pixels[3].row = 6; _minutes[8].pixels[3].col = 3;  // N
-    _minutes[8].pixels[4].row = 6; _minutes[8].pixels[4].col = 4;  // S
-    _minutes[8].pixels[5].row = 8; _minutes[8].pixels[5].col = 0;  // V
-    _minutes[8].pixels[6].row = 8; _minutes[8].pixels[6].col = 1;  // I
-    _minutes[8].pixels[7].row = 8; _minutes[8].pixels[7].col = 2;  // N
-    _minutes[8].pixels[8].row = 8; _minutes[8].pixels[8].col = 3;  // G
-    _minutes[8].pixels[9].row = 8; _minutes[8].pixels[9].col = 4;  // T
-
-    _minutes[9].number = 12; // between [45:49]
-    _minutes[9].pixels[0].row = 6; _minutes[9].pixels[0].col = 0;  // M
-    _minutes[9].pixels[1].row = 6; _minutes[9].pixels[1].col = 1;  // O
-    _minutes[9].pixels[2].row = 6; _minutes[9].pixels[2].col = 2;  // I
-    _minutes[9].pixels[3].row = 6; _minutes[9].pixels[3].col = 3;  // N
-    _minutes[9].pixels[4].row = 6; _minutes[9].pixels[4].col = 4;  // S
-    _minutes[9].pixels[5].row = 6; _minutes[9].pixels[5].col = 6;  // L
-    _minutes[9].pixels[6].row = 6; _minutes[9].pixels[6].col = 7;  // E
-    _minutes[9].pixels[7].row = 7; _minutes[9].pixels[7].col = 3;  // Q
-    _minutes[9].pixels[8].row = 7; _minutes[9].pixels[8].col = 4;  // U
-    _minutes[9].pixels[9].row = 7; _minutes[9].pixels[9].col = 5;  // A
-    _minutes[9].pixels[10].row = 7; _minutes[9].pixels[10].col = 6;// R
-    _minutes[9].pixels[11].row = 7; _minutes[9].pixels[11].col = 7;// T
-
-    _minutes[10].number = 8; // between [50:54]
-    _minutes[10].pixels[0].row = 6; _minutes[10].pixels[0].col = 0;  // M
-    _minutes[10].pixels[1].row = 6; _minutes[10].pixels[1].col = 1;  // O
-    _minutes[10].pixels[2].row = 6; _minutes[10].pixels[2].col = 2;  // I
-    _minutes[10].pixels[3].row = 6; _minutes[10].pixels[3].col = 3;  // N
-    _minutes[10].pixels[4].row = 6; _minutes[10].pixels[4].col = 4;  // S
-    _minutes[10].pixels[5].row = 6; _minutes[10].pixels[5].col = 8;  // D
-    _minutes[10].pixels[6].row = 6; _minutes[10].pixels[6].col = 9;  // I
-    _minutes[10].pixels[7].row = 6; _minutes[10].pixels[7].col = 10; // X
-
-    _minutes[11].number = 9; // between [55:59]
-    _minutes[11].pixels[0].row = 6; _minutes[11].pixels[0].col = 0;  // M
-    _minutes[11].pixels[1].row = 6; _minutes[11].pixels[1].col = 1;  // O
-    _minutes[11].pixels[2].row = 6; _minutes[11].pixels[2].col = 2;  // I
-    _minutes[11].pixels[3].row = 6; _minutes[11].pixels[3].col = 3;  // N
-    _minutes[11].pixels[4].row = 6; _minutes[11].pixels[4].col = 4;  // S
-    _minutes[11].pixels[5].row = 8; _minutes[11].pixels[5].col = 6;  // C
-    _minutes[11].pixels[6].row = 8; _minutes[11].pixels[6].col = 7;  // I
-    _minutes[11].pixels[7].row = 8; _minutes[11].pixels[7].col = 8;  // N
-    _minutes[11].pixels[8].row = 8; _minutes[11].pixels[8].col = 9;  // Q
-
-    _minutes[12].number = 6; // between [30:34] (special for midday and midnight)
-    _minutes[12].pixels[0].row = 9; _minutes[12].pixels[0].col = 0;  // E
-    _minutes[12].pixels[1].row = 9; _minutes[12].pixels[1].col = 1;  // T
-    _minutes[12].pixels[2].row = 9; _minutes[12].pixels[2].col = 3;  // D
-    _minutes[12].pixels[3].row = 9; _minutes[12].pixels[3].col = 4;  // E
-    _minutes[12].pixels[4].row = 9; _minutes[12].pixels[4].col = 5;  // M
-    _minutes[12].pixels[5].row = 9; _minutes[12].pixels[5].col = 6;  // I
-  }*/
+    if (minute >= 25)
+      hour = hour + 1;
 
+    h = hour % 12;
+    m = minute / 5;
+    return true;
+  }
 
   virtual TextTimeBlobs getBlobsFromTime(int hour, int minute)
   {
     TextTimeBlobs b;
+    int h, m;
 
     b.number = 0;
 
-    if (hour > 23) return b;
-    if (minute > 59) return b;
+    if (!getSlot(hour, minute, h, m)) return b;
 
-    b.blobs[b.number++] = &_it;
-    b.blobs[b.number++] = &_is;
+    b.blobs[b.number++] = blob(&_textTimeCHIt);
+    b.blobs[b.number++] = blob(&_textTimeCHIs);
+    b.blobs[b.number++] = blob(&_textTimeCHHours[h]);
+    b.blobs[b.number++] = blob(&_textTimeCHMinutes[m]);
 
-    if (minute >= 25)
-      hour = hour + 1;
-    if (hour > 23) hour = 0;
-    
-    b.blobs[b.number++] = (hour == 12) ? &(_hours[12]) : &(_hours[hour % 12]);
+    return b;
+  }
 
-    b.blobs[b.number++] = &(_minutes[minute / 5]);
-    
-    //if (hour != 0 && hour != 12)
-      //b.blobs[b.number++] = (hour == 1 || hour == 13) ? &_hour1 : &_hour2;
+  virtual bool getMaskFromTime(int hour, int minute, uint32_t *mask)
+  {
+    int h, m;
 
-      //b.blobs[b.number++] = ((hour == 0 || hour == 12) && (minute / 5 == 6)) ? &(_minutes[12]) : &(_minutes[minute / 5]);
-    
+    if (!getSlot(hour, minute, h, m)) return false;
 
-    return b;
+    memcpy_P(mask, _textTimeCHMasks[h][m], sizeof(_textTimeCHMasks[h][m]));
+    return true;
   }
 
-  virtual cl_Lst<TextTimePixel> getPixelsFromLetter(char c)
+  virtual String getName()
   {
-    cl_Lst<TextTimePixel> l;
-    TextTimePixel p;
-
-    if (c == 'a')
-    {
-      p.row = 1; p.col = 2; l.push_back(p);
-      p.row = 7; p.col = 5; l.push_back(p);
-      p.row = 9; p.col = 9; l.push_back(p);
-    }
+    return "Schwiizerdütsch";
+  }
 
-    if (c == 'b')
-    {
-      p.row = 0; p.col = 2; l.push_back(p);
-    }
+  virtual int getNextLetterCell(char c, int from)
+  {
+    if (c < 'A' || c > 'Z') return -1;
 
-    if (c == 'c')
-    {
-      p.row = 3; p.col = 7; l.push_back(p);
-      p.row = 8; p.col = 6; l.push_back(p);
-    }
+    uint32_t mask[NPIXELSMASK];
+    memcpy_P(mask, _textTimeCHLetters[c - 'A'], sizeof(mask));
 
-    if (c == 'd')
-    {
-      p.row = 0; p.col = 7; l.push_back(p);
-      p.row = 4; p.col = 2; l.push_back(p);
-      p.row = 6; p.col = 8; l.push_back(p);
-      p.row = 9; p.col = 3; l.push_back(p);
-    }
+    int n = from + 1;
+    if (n < 0) n = 0;
 
-    if (c == 'e')
-    {
-      p.row = 0; p.col = 3; l.push_back(p);
-      p.row = 0; p.col = 8; l.push_back(p);
-      p.row = 1; p.col = 5; l.push_back(p);
-      p.row = 2; p.col = 1; l.push_back(p);
-      p.row = 2; p.col = 6; l.push_back(p);
-      p.row = 2; p.col = 8; l.push_back(p);
-      p.row = 5; p.col = 3; l.push_back(p);
-      p.row = 5; p.col = 6; l.push_back(p);
-      p.row = 5; p.col = 9; l.push_back(p);
-      p.row = 6; p.col = 7; l.push_back(p);
-      p.row = 7; p.col = 0; l.push_back(p);
-      p.row = 9; p.col = 0; l.push_back(p);
-      p.row = 9; p.col = 4; l.push_back(p);
-      p.row = 9; p.col = 7; l.push_back(p);
+    for (int i = n >> 5; i < NPIXELSMASK; i++) {
+      uint32_t m = mask[i];
+      if (i == (n >> 5))
+        m &= ~textTimeLowBits(n & 31);
+      if (m)
+        return (i << 5) + __builtin_ctz(m);
     }
 
-    if (c == 'f')
-    {
-      p.row = 2; p.col = 3; l.push_back(p);
-    }
+    return -1;
+  }
+};
 
-    if (c == 'g')
-    {
-      p.row = 8; p.col = 3; l.push_back(p);
-    }
 
-    if (c == 'h')
-    {
-      p.row = 3; p.col = 0; l.push_back(p);
-      p.row = 5; p.col = 5; l.push_back(p);
-    }
+// Binary layout file, version 1, all fields are bytes:
+//   header
+//   grid      rows * cols letters, A to Z or '.' between words
+//   words     TextTimeWord[header.words]
+//   spans     TextTimeSpan[header.spans], phrases of consecutive words
+//   hours     span index for each hour of the day [0:23]
+//   minutes   TextTimeMinuteRule for each 5 minutes slot [0:11]
+// Files are made from a text description by tools/textime_layout.py
+#define TEXTTIMELAYOUTVERSION 1
+#define TEXTTIMELAYOUTMAX 1024
+#define TEXTTIMELAYOUTDIR "/layouts"
+#define TEXTTIMELAYOUTNOSPAN 0xFF
+#define TEXTTIMELAYOUTSMAX 8     // layout files listed
+
+struct TextTimeLayoutHeader
+{
+  char magic[4];        // "TXTL"
+  uint8_t version;
+  uint8_t rows;
+  uint8_t cols;
+  uint8_t words;
+  uint8_t spans;
+  uint8_t prefix;       // span displayed at any time ("ES ISCH"), TEXTTIMELAYOUTNOSPAN if none
+  uint8_t reserved[2];
+  char name[20];        // zero padded
+};
 
-    if (c == 'i')
-    {
-      p.row = 0; p.col = 0; l.push_back(p);
-      p.row = 1; p.col = 9; l.push_back(p);
-      p.row = 3; p.col = 2; l.push_back(p);
-      p.row = 3; p.col = 5; l.push_back(p);
-      p.row = 3; p.col = 8; l.push_back(p);
-      p.row = 4; p.col = 1; l.push_back(p);
-      p.row = 4; p.col = 3; l.push_back(p);
-      p.row = 4; p.col = 6; l.push_back(p);
-      p.row = 4; p.col = 9; l.push_back(p);
-      p.row = 6; p.col = 2; l.push_back(p);
-      p.row = 6; p.col = 9; l.push_back(p);
-      p.row = 8; p.col = 1; l.push_back(p);
-      p.row = 8; p.col = 7; l.push_back(p);
-      p.row = 9; p.col = 6; l.push_back(p);
-    }
+static_assert(sizeof(TextTimeLayoutHeader) == 32, "TextTimeLayout: header size");
 
-    if (c == 'j')
-    {
-      p.row = 0; p.col = 6; l.push_back(p);
-    }
+struct TextTimeMinuteRule
+{
+  uint8_t span;         // minute phrase, TEXTTIMELAYOUTNOSPAN if none
+  uint8_t hourOffset;   // added to the hour ("FÜF VOR HALBI EIS" at 00:25)
+};
 
-    if (c == 'k')
-    {
-      p.row = 5; p.col = 4; l.push_back(p);
-    }
+// Layout read from the file system, into a buffer allocated only while a file
+// is in use.
+// The tables are used in place, no allocation is made when loading.
+class TextTimeLayout : public TextTime
+{
+private:
+  uint8_t *_data;
+  const TextTimeLayoutHeader *_pHeader;
+  const char *_grid;
+  const TextTimeWord *_words;
+  const TextTimeSpan *_spans;
+  const uint8_t *_hours;
+  const TextTimeMinuteRule *_minutes;
+  bool _loaded;
+
+  bool validSpan(uint8_t span, bool allowNone)
+  {
+    if (span == TEXTTIMELAYOUTNOSPAN) return allowNone;
+    return span < _pHeader->spans;
+  }
 
-    if (c == 'l')
-    {
-      p.row = 0; p.col = 1; l.push_back(p);
-      p.row = 6; p.col = 6; l.push_back(p);
+  // Check the tables of the file just read
+  bool validate(size_t size)
+  {
+    _pHeader = (const TextTimeLayoutHeader *)_data;
+
+    if (size < sizeof(TextTimeLayoutHeader)) return false;
+    if (memcmp(_pHeader->magic, "TXTL", 4)) return false;
+    if (_pHeader->version != TEXTTIMELAYOUTVERSION) return false;
+    if (_pHeader->rows != NROW || _pHeader->cols != NCOL) return false;
+
+    size_t offset = sizeof(TextTimeLayoutHeader);
+    _grid = (const char *)(_data + offset);
+    offset += NROW * NCOL;
+    _words = (const TextTimeWord *)(_data + offset);
+    offset += _pHeader->words * sizeof(TextTimeWord);
+    _spans = (const TextTimeSpan *)(_data + offset);
+    offset += _pHeader->spans * sizeof(TextTimeSpan);
+    _hours = _data + offset;
+    offset += 24;
+    _minutes = (const TextTimeMinuteRule *)(_data + offset);
+    offset += TEXTTIMESLOTS * sizeof(TextTimeMinuteRule);
+
+    if (offset != size) return false;
+
+    for (int i = 0; i < _pHeader->words; i++) {
+      const TextTimeWord &w = _words[i];
+      if (!w.length || w.row >= NROW || w.col + w.length > NCOL) return false;
     }
 
-    if (c == 'm')
-    {
-      p.row = 4; p.col = 0; l.push_back(p);
-      p.row = 4; p.col = 5; l.push_back(p);
-      p.row = 6; p.col = 0; l.push_back(p);
-      p.row = 7; p.col = 9; l.push_back(p);
-      p.row = 9; p.col = 5; l.push_back(p);
-      p.row = 9; p.col = 10; l.push_back(p);
-    }
+    for (int i = 0; i < _pHeader->spans; i++)
+      if (_spans[i].first + _spans[i].number > _pHeader->words) return false;
 
-    if (c == 'n')
-    {
-      p.row = 2; p.col = 0; l.push_back(p);
-      p.row = 2; p.col = 5; l.push_back(p);
-      p.row = 3; p.col = 9; l.push_back(p);
-      p.row = 4; p.col = 7; l.push_back(p);
-      p.row = 5; p.col = 1; l.push_back(p);
-      p.row = 6; p.col = 3; l.push_back(p);
-      p.row = 8; p.col = 2; l.push_back(p);
-      p.row = 8; p.col = 8; l.push_back(p);
-    }
+    if (!validSpan(_pHeader->prefix, true)) return false;
 
-    if (c == 'o')
-    {
-      p.row = 1; p.col = 8; l.push_back(p);
-      p.row = 5; p.col = 0; l.push_back(p);
-      p.row = 6; p.col = 1; l.push_back(p);
-    }
+    for (int h = 0; h < 24; h++)
+      if (!validSpan(_hours[h], false)) return false;
 
-    if (c == 'p')
-    {
-      p.row = 2; p.col = 9; l.push_back(p);
-      p.row = 7; p.col = 8; l.push_back(p);
-      p.row = 9; p.col = 8; l.push_back(p);
-    }
+    for (int m = 0; m < TEXTTIMESLOTS; m++)
+      if (!validSpan(_minutes[m].span, true) || _minutes[m].hourOffset > 23) return false;
 
-    if (c == 'q')
-    {
-      p.row = 1; p.col = 0; l.push_back(p);
-      p.row = 3; p.col = 10; l.push_back(p);
-      p.row = 7; p.col = 3; l.push_back(p);
-      p.row = 8; p.col = 9; l.push_back(p);
-    }
+    return true;
+  }
 
-    if (c == 'r')
-    {
-      p.row = 1; p.col = 4; l.push_back(p);
-      p.row = 1; p.col = 7; l.push_back(p);
-      p.row = 5; p.col = 8; l.push_back(p);
-      p.row = 7; p.col = 2; l.push_back(p);
-      p.row = 7; p.col = 6; l.push_back(p);
-    }
+  TextTimeBlob blob(uint8_t span)
+  {
+    TextTimeBlob b;
+    b.words = _words + _spans[span].first;
+    b.number = _spans[span].number;
+    return b;
+  }
 
-    if (c == 's')
-    {
-      p.row = 0; p.col = 4; l.push_back(p);
-      p.row = 1; p.col = 10; l.push_back(p);
-      p.row = 2; p.col = 7; l.push_back(p);
-      p.row = 3; p.col = 4; l.push_back(p);
-      p.row = 5; p.col = 10; l.push_back(p);
-      p.row = 6; p.col = 4; l.push_back(p);
-      p.row = 9; p.col = 2; l.push_back(p);
+  void addSpanMask(uint8_t span, uint32_t *mask)
+  {
+    if (span == TEXTTIMELAYOUTNOSPAN) return;
+
+    for (int i = 0; i < _spans[span].number; i++) {
+      const TextTimeWord &w = _words[_spans[span].first + i];
+      for (int k = 0; k < w.length; k++) {
+        int n = w.row * NCOL + w.col + k;
+        mask[n >> 5] |= 1UL << (n & 31);
+      }
     }
+  }
 
-    if (c == 't')
-    {
-      p.row = 0; p.col = 5; l.push_back(p);
-      p.row = 1; p.col = 3; l.push_back(p);
-      p.row = 1; p.col = 6; l.push_back(p);
-      p.row = 2; p.col = 10; l.push_back(p);
-      p.row = 3; p.col = 3; l.push_back(p);
-      p.row = 4; p.col = 10; l.push_back(p);
-      p.row = 7; p.col = 1; l.push_back(p);
-      p.row = 7; p.col = 7; l.push_back(p);
-      p.row = 8; p.col = 4; l.push_back(p);
-      p.row = 9; p.col = 1; l.push_back(p);
-    }
+  // Hour and minute spans of a time
+  bool getSlot(int hour, int minute, uint8_t &h, uint8_t &m)
+  {
+    if (!_loaded) return false;
+    if (hour < 0 || hour > 23) return false;
+    if (minute < 0 || minute > 59) return false;
+
+    const TextTimeMinuteRule &r = _minutes[minute / 5];
+    h = _hours[(hour + r.hourOffset) % 24];
+    m = r.span;
+    return true;
+  }
 
-    if (c == 'u')
-    {
-      p.row = 0; p.col = 9; l.push_back(p);
-      p.row = 1; p.col = 1; l.push_back(p);
-      p.row = 2; p.col = 2; l.push_back(p);
-      p.row = 2; p.col = 4; l.push_back(p);
-      p.row = 3; p.col = 1; l.push_back(p);
-      p.row = 4; p.col = 8; l.push_back(p);
-      p.row = 5; p.col = 7; l.push_back(p);
-      p.row = 7; p.col = 4; l.push_back(p);
-      p.row = 8; p.col = 10; l.push_back(p);
-    }
+public:
+  TextTimeLayout()
+    : _data(NULL)
+    , _pHeader(NULL)
+    , _loaded(false)
+  {
+  }
 
-    if (c == 'v')
-    {
-      p.row = 8; p.col = 0; l.push_back(p);
-    }
+  ~TextTimeLayout()
+  {
+    unload();
+  }
 
-    if (c == 'w')
-    {
-      p.row = 6; p.col = 5; l.push_back(p);
-    }
+  bool load(const String &path)
+  {
+    unload();
+
+    File f = SPIFFS.open(path, "r");
+    if (!f)
+      return false;
+
+    // A file too large or a heap too fragmented falls back to the built-in layout
+    size_t size = f.size();
+    if (size <= TEXTTIMELAYOUTMAX)
+      _data = new (std::nothrow) uint8_t[size];
+    if (_data)
+      _loaded = f.read(_data, size) == size && validate(size);
+    f.close();
+
+    if (!_loaded)
+      unload();
+    return _loaded;
+  }
 
-    if (c == 'x')
-    {
-      p.row = 0; p.col = 10; l.push_back(p);
-      p.row = 3; p.col = 6; l.push_back(p);
-      p.row = 4; p.col = 4; l.push_back(p);
-      p.row = 6; p.col = 10; l.push_back(p);
+  // Gives the RAM of the file back
+  void unload()
+  {
+    delete[] _data;
+    _data = NULL;
+    _pHeader = NULL;
+    _loaded = false;
+  }
+
+  // Name stored in the header of a layout file
+  static String readName(const String &path)
+  {
+    TextTimeLayoutHeader h;
+    String name;
+
+    File f = SPIFFS.open(path, "r");
+    if (!f)
+      return name;
+
+    if (f.read((uint8_t *)&h, sizeof(h)) == sizeof(h) && !memcmp(h.magic, "TXTL", 4)) {
+      h.name[sizeof(h.name) - 1] = 0;
+      name = h.name;
     }
+    f.close();
+
+    return name;
+  }
+
+  virtual String getName()
+  {
+    if (!_loaded) return "";
+
+    char name[sizeof(_pHeader->name) + 1];
+    memcpy(name, _pHeader->name, sizeof(_pHeader->name));
+    name[sizeof(_pHeader->name)] = 0;
+    return name;
+  }
+
+  virtual TextTimeBlobs getBlobsFromTime(int hour, int minute)
+  {
+    TextTimeBlobs b;
+    uint8_t h, m;
+
+    b.number = 0;
+
+    if (!getSlot(hour, minute, h, m)) return b;
+
+    if (_pHeader->prefix != TEXTTIMELAYOUTNOSPAN)
+      b.blobs[b.number++] = blob(_pHeader->prefix);
+    b.blobs[b.number++] = blob(h);
+    if (m != TEXTTIMELAYOUTNOSPAN)
+      b.blobs[b.number++] = blob(m);
+
+    return b;
+  }
+
+  virtual bool getMaskFromTime(int hour, int minute, uint32_t *mask)
+  {
+    uint8_t h, m;
+
+    if (!getSlot(hour, minute, h, m)) return false;
+
+    memset(mask, 0, NPIXELSMASK * sizeof(uint32_t));
+    addSpanMask(_pHeader->prefix, mask);
+    addSpanMask(h, mask);
+    addSpanMask(m, mask);
+    return true;
+  }
+
+  virtual int getNextLetterCell(char c, int from)
+  {
+    if (!_loaded) return -1;
+    if (c < 'A' || c > 'Z') return -1;
+
+    for (int n = from + 1 < 0 ? 0 : from + 1; n < NROW * NCOL; n++)
+      if (_grid[n] == c)
+        return n;
+
+    return -1;
+  }
+};
+
+// The built-in layout, then the layout files found in TEXTTIMELAYOUTDIR.
+// Only the selected file is loaded.
+class TextTimeLayouts
+{
+private:
+  TextTimeCH _builtin;
+  TextTimeLayout _file;
+  StaticVector<String, TEXTTIMELAYOUTSMAX> _paths;
+  StaticVector<String, TEXTTIMELAYOUTSMAX> _names;
+  TextTime *_pCurrent;
+  int _index;
+
+public:
+  TextTimeLayouts()
+    : _pCurrent(&_builtin)
+    , _index(0)
+  {
+  }
+
+  void begin()
+  {
+    _paths.clear();
+    _names.clear();
 
-    if (c == 'y')
-    {
-      p.row = 7; p.col = 10; l.push_back(p);
+    Dir dir = SPIFFS.openDir(TEXTTIMELAYOUTDIR);
+    while (dir.next()) {
+      String path = dir.fileName();
+      if (!path.endsWith(".ttl"))
+        continue;
+
+      String name = TextTimeLayout::readName(path);
+      if (!name.length() || _paths.full())
+        continue;
+
+      _paths.push_back(path);
+      _names.push_back(name);
     }
+  }
+
+  int size()
+  {
+    return _paths.size() + 1;
+  }
+
+  String getName(int index)
+  {
+    if (index == 0) return _builtin.getName();
+    return _names[index - 1];
+  }
+
+  // Falls back to the built-in layout when the file can not be used
+  bool select(int index)
+  {
+    if (index < 0 || index > size() - 1)
+      return false;
 
-    if (c == 'z')
-    {
-      p.row = 5; p.col = 2; l.push_back(p);
+    _index = 0;
+    _pCurrent = &_builtin;
+    _file.unload();
+
+    if (index == 0)
+      return true;
+
+    if (!_file.load(_paths[index - 1])) {
+      Serial.println("Invalid layout " + _paths[index - 1]);
+      return false;
     }
 
-    return l;
+    _index = index;
+    _pCurrent = &_file;
+    return true;
+  }
+
+  int getIndex()
+  {
+    return _index;
+  }
+
+  TextTime &current()
+  {
+    return *_pCurrent;
   }
-};
\ No newline at end of file
+};
+
+TextTimeLayouts _textTimeLayouts;
@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+#
+# Compile a word layout description into the binary layout format read by
+# TextTimeLayout (textime.h), and check that every minute of the day renders.
+#
+#   textime_layout.py layouts/ch.txt -o ch.ttl
+#   textime_layout.py layouts/ch.txt --show 10:27
+#
+# Copy the .ttl files to /layouts on the SPIFFS of the clock.
+
+import argparse
+import struct
+import sys
+
+VERSION = 1
+ROWS = 10
+COLS = 12
+NAMESIZE = 20
+NOSPAN = 0xFF
+SLOTS = 12
+MAXSIZE = 1024
+
+FOLD = {'Ä': 'A', 'Ö': 'O', 'Ü': 'U'}
+
+
+class LayoutError(Exception):
+    pass
+
+
+def fold(text):
+    return ''.join(FOLD.get(c, c) for c in text.upper())
+
+
+class Layout:
+    def __init__(self):
+        self.name = None
+        self.grid = []
+        self.prefix = []
+        self.hours = [None] * 24
+        self.minutes = [None] * SLOTS
+
+    def word(self, token, line):
+        # TEXT@row,col
+        try:
+            text, pos = token.split('@')
+            row, col = (int(v) for v in pos.split(','))
+        except ValueError:
+            raise LayoutError('line %d: bad word "%s", expected TEXT@row,col' % (line, token))
+
+        text = fold(text)
+        if not text or row < 0 or row >= ROWS or col < 0 or col + len(text) > COLS:
+            raise LayoutError('line %d: word "%s" outside of the grid' % (line, token))
+
+        if self.grid[row][col:col + len(text)] != text:
+            raise LayoutError('line %d: word "%s" does not match the grid "%s"'
+                              % (line, token, self.grid[row][col:col + len(text)]))
+
+        return (row, col, len(text))
+
+
+def parse(path):
+    layout = Layout()
+    lines = open(path, encoding='utf-8').read().splitlines()
+    inGrid = False
+
+    for n, raw in enumerate(lines, 1):
+        text = raw.split('#')[0].strip()
+        if not text:
+            continue
+
+        if inGrid:
+            if text == 'end':
+                inGrid = False
+                continue
+            row = fold(text)
+            if len(row) != COLS or any(not ('A' <= c <= 'Z' or c == '.') for c in row):
+                raise LayoutError('line %d: grid rows are %d letters A to Z or "."' % (n, COLS))
+            layout.grid.append(row)
+            continue
+
+        tokens = text.split()
+        key, args = tokens[0], tokens[1:]
+
+        if key == 'name':
+            layout.name = ' '.join(args)
+        elif key == 'grid':
+            inGrid = True
+        elif key == 'prefix':
+            layout.prefix = [layout.word(t, n) for t in args]
+        elif key == 'hour':
+            hours = [int(t) for t in args if '@' not in t]
+            words = [layout.word(t, n) for t in args if '@' in t]
+            if not words:
+                raise LayoutError('line %d: hour without words' % n)
+            for h in hours:
+                if h < 0 or h > 23:
+                    raise LayoutError('line %d: hour %d out of [0:23]' % (n, h))
+                layout.hours[h] = words
+        elif key == 'minute':
+            if len(args) < 2 or not args[1].startswith('+'):
+                raise LayoutError('line %d: expected "minute M +OFFSET WORDS"' % n)
+            m, offset = int(args[0]), int(args[1][1:])
+            if m < 0 or m > 55 or m % 5 or offset < 0 or offset > 23:
+                raise LayoutError('line %d: bad minute slot %d or hour offset %d' % (n, m, offset))
+            layout.minutes[m // 5] = (offset, [layout.word(t, n) for t in args[2:]])
+        else:
+            raise LayoutError('line %d: unknown keyword "%s"' % (n, key))
+
+    if inGrid:
+        raise LayoutError('grid without end')
+    if len(layout.grid) != ROWS:
+        raise LayoutError('the grid has %d rows instead of %d' % (len(layout.grid), ROWS))
+    if not layout.name:
+        raise LayoutError('missing name')
+    for h in range(24):
+        if layout.hours[h] is None:
+            raise LayoutError('no words for hour %d' % h)
+    for m in range(SLOTS):
+        if layout.minutes[m] is None:
+            raise LayoutError('no rule for minute %d' % (m * 5))
+
+    return layout
+
+
+def render(layout, hour, minute):
+    offset, words = layout.minutes[minute // 5]
+    return layout.prefix + layout.hours[(hour + offset) % 24] + words
+
+
+# Every minute must light an hour and must not light a cell twice
+def check(layout):
+    for hour in range(24):
+        for minute in range(60):
+            cells = set()
+            for row, col, length in render(layout, hour, minute):
+                for c in range(col, col + length):
+                    if (row, c) in cells:
+                        raise LayoutError('%02d:%02d: cell %d,%d is used by two words' % (hour, minute, row, c))
+                    cells.add((row, c))
+
+
+def compile(layout):
+    spans = []
+    words = []
+
+    # Same phrases share their span
+    def span(phrase):
+        if not phrase:
+            return NOSPAN
+        key = tuple(phrase)
+        for i, (first, number) in enumerate(spans):
+            if tuple(words[first:first + number]) == key:
+                return i
+        spans.append((len(words), len(phrase)))
+        words.extend(phrase)
+        return len(spans) - 1
+
+    prefix = span(layout.prefix)
+    hours = [span(layout.hours[h]) for h in range(24)]
+    minutes = [(span(words_), offset) for offset, words_ in layout.minutes]
+
+    if len(words) > 255 or len(spans) > 254:
+        raise LayoutError('too many words or phrases')
+
+    name = layout.name.encode('utf-8')[:NAMESIZE - 1]
+    data = b'TXTL' + struct.pack('<7B', VERSION, ROWS, COLS, len(words), len(spans), prefix, 0) + b'\0'
+    data += name + b'\0' * (NAMESIZE - len(name))
+    data += ''.join(layout.grid).encode('ascii')
+    data += b''.join(struct.pack('<3B', *w) for w in words)
+    data += b''.join(struct.pack('<2B', *s) for s in spans)
+    data += bytes(hours)
+    data += b''.join(struct.pack('<2B', *m) for m in minutes)
+
+    if len(data) > MAXSIZE:
+        raise LayoutError('layout is %d bytes, more than %d' % (len(data), MAXSIZE))
+
+    return data
+
+
+def show(layout, hour, minute):
+    lit = set()
+    for row, col, length in render(layout, hour, minute):
+        lit.update((row, c) for c in range(col, col + length))
+
+    for r in range(ROWS):
+        print(''.join(layout.grid[r][c] if (r, c) in lit else '.' for c in range(COLS)))
+    print('*' * (minute % 5))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compile a TexTime word layout')
+    parser.add_argument('layout', help='layout description')
+    parser.add_argument('-o', '--output', help='binary layout to write')
+    parser.add_argument('--show', metavar='HH:MM', help='print the cells lit at a time')
+    args = parser.parse_args()
+
+    try:
+        layout = parse(args.layout)
+        check(layout)
+        data = compile(layout)
+    except LayoutError as e:
+        sys.exit('%s: %s' % (args.layout, e))
+
+    if args.output:
+        with open(args.output, 'wb') as f:
+            f.write(data)
+
+    if args.show:
+        hour, minute = (int(v) for v in args.show.split(':'))
+        show(layout, hour, minute)
+
+    print('%s: %s, %d bytes, 1440 minutes checked' % (args.layout, layout.name, len(data)), file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()